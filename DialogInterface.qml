@@ -25,6 +25,7 @@ import QtQuick.Controls 2.12
 import QtQuick.Layouts 1.12
 import QtQuick.Window 2.12
 import QtQuick.Controls.Material 2.12
+import QtQuick.Dialogs 1.3
 import ru.webstella.weprex 1.0
 
 Dialog {
@@ -54,6 +55,16 @@ Dialog {
 		tcpPort.value = settings.tcp.port
 		maxTimeout.value = settings.timeout
 		pollingPause.value = settings.pollingPause
+		blockRead.checked = (settings.blockRead === true)
+		blockGap.value = (typeof settings.blockGap === "number") ? settings.blockGap : 0
+		pipelineWindow.value = (typeof settings.pipelineWindow === "number") ? settings.pipelineWindow : 1
+		connections.value = (typeof settings.connections === "number") ? settings.connections : 1
+		replayFile.text = (typeof settings.replayFile === "string") ? settings.replayFile : ""
+		replaySpeed.value = (typeof settings.replaySpeed === "number") ? settings.replaySpeed : 100
+		listenOnly.checked = (settings.listenOnly === true)
+		adaptiveTimeout.checked = (settings.adaptiveTimeout === true)
+		adaptiveTimeoutMin.value = (typeof settings.adaptiveTimeoutMin === "number") ? settings.adaptiveTimeoutMin : 20
+		adaptiveTimeoutMax.value = (typeof settings.adaptiveTimeoutMax === "number") ? settings.adaptiveTimeoutMax : 5000
 	}
 
 	contentItem:
@@ -92,7 +103,8 @@ Dialog {
 			LabelDialog {
 				id: labelTransport
 				title: qsTr("Media/Transport layer")
-				baseTooltipText: qsTr("Media/Transport layers are presented in the drop-down list.")
+				baseTooltipText: qsTr("Media/Transport layers are presented in the drop-down list.<br/>Modbus RTU over TCP sends raw RTU frames to serial gateways (tunnel mode).")
+				errorTooltipText: qsTr("UDP transport carries Modbus TCP protocol only.")
 			}
 			ComboBox {
 				id: transport
@@ -100,6 +112,8 @@ Dialog {
 				model: ListModel {
 					ListElement {text: qsTr("Serial"); type: "serial"}
 					ListElement {text: qsTr("TCP"); type: "tcp"}
+					ListElement {text: qsTr("UDP"); type: "udp"}
+					ListElement {text: qsTr("Replay"); type: "replay"}
 				}
 				Layout.fillWidth: true
 
@@ -112,10 +126,11 @@ Dialog {
 				}
 
 				function showSettings() {
+					replaySettings.visible = (transportType === "replay")
 					if (transportType === "serial") {
 						tcpSettings.visible = false
 						serialSettings.visible = true
-					} else if (transportType === "tcp") {
+					} else if (transportType === "tcp" || transportType === "udp") {
 						serialSettings.visible = false
 						tcpSettings.visible = true
 					} else {
@@ -276,6 +291,16 @@ Dialog {
 							}
 						}
 					}
+
+					LabelDialog {
+						id: labelListenOnly
+						title: qsTr("Listen only")
+						baseTooltipText: qsTr("Bus monitor: nothing is transmitted, responses to requests of another master update the parameters.<br/>Modbus RTU only.")
+					}
+					CheckBox {
+						id: listenOnly
+						checked: false
+					}
 				}
 			}
 
@@ -324,6 +349,106 @@ Dialog {
 							top: tcpPort.to
 						}
 					}
+
+					LabelDialog {
+						id: labelPipelineWindow
+						title: qsTr("Pipeline")
+						baseTooltipText: qsTr("Maximum number of requests sent without waiting for responses.<br/>1 - wait for response to each request.")
+						errorTooltipText: qsTr("Pipeline window is not set.")
+					}
+					SpinBox {
+						id: pipelineWindow
+						wheelEnabled: true
+						from: 1
+						to: 16
+						value: 1
+						editable: true
+						Layout.fillWidth: true
+						validator: IntValidator {
+							bottom: pipelineWindow.from
+							top: pipelineWindow.to
+						}
+					}
+
+					LabelDialog {
+						id: labelConnections
+						visible: transportType === "tcp"
+						title: qsTr("Connections")
+						baseTooltipText: qsTr("Parallel connections to the server (gateway), devices are spread over them by unit id.<br/>Use for gateways with several buses answering one request per connection.")
+						errorTooltipText: qsTr("Number of connections is not set.")
+					}
+					SpinBox {
+						id: connections
+						visible: transportType === "tcp"
+						wheelEnabled: true
+						from: 1
+						to: 16
+						value: 1
+						editable: true
+						Layout.fillWidth: true
+						validator: IntValidator {
+							bottom: connections.from
+							top: connections.to
+						}
+					}
+				}
+			}
+
+			Frame {
+				id: replaySettings
+				visible: false
+				Layout.columnSpan: 2
+				Layout.fillWidth: true
+				height: contentHeight
+				RowLayout {
+					anchors.fill: parent
+					spacing: 10
+					LabelDialog {
+						id: labelReplayFile
+						title: qsTr("Capture")
+						baseTooltipText: qsTr("Traffic capture file, requests are answered by the captured responses.")
+						errorTooltipText: qsTr("Capture file is not set.")
+					}
+					TextField {
+						id: replayFile
+						selectByMouse: true
+						Layout.fillWidth: true
+					}
+					Button {
+						text: qsTr("Browse")
+						onClicked: dialogReplayFile.open()
+					}
+
+					LabelDialog {
+						id: labelReplaySpeed
+						title: qsTr("Speed, %")
+						baseTooltipText: qsTr("Replay speed relative to the captured timing.<br/>100 - real time, 0 - maximum speed (no delays and pauses).")
+						errorTooltipText: qsTr("Speed is not set.")
+					}
+					SpinBox {
+						id: replaySpeed
+						wheelEnabled: true
+						from: 0
+						to: 10000
+						stepSize: 10
+						value: 100
+						editable: true
+						Layout.fillWidth: true
+						validator: IntValidator {
+							bottom: replaySpeed.from
+							top: replaySpeed.to
+						}
+					}
+				}
+
+				FileDialog {
+					id: dialogReplayFile
+					title: qsTr("Please choose a traffic capture file")
+					selectExisting: true
+					nameFilters: [ qsTr("Traffic capture ") + "(*.wstraffic)", qsTr("All files ") + "(*)" ]
+					onAccepted: {
+						replayFile.text = dialogReplayFile.fileUrl
+					}
 				}
 			}
 
@@ -347,6 +472,56 @@ Dialog {
 				}
 			}
 
+			LabelDialog {
+				id: labelAdaptiveTimeout
+				title: qsTr("Adaptive timeout")
+				baseTooltipText: qsTr("Response timeout of each device is learned from measured response times.<br/>Timeout above is used until the first response of the device.")
+			}
+			CheckBox {
+				id: adaptiveTimeout
+				checked: false
+			}
+
+			LabelDialog {
+				id: labelAdaptiveTimeoutMin
+				title: qsTr("Min timeout")
+				baseTooltipText: qsTr("Lower bound of the adaptive timeout in ms.")
+				errorTooltipText: qsTr("Min timeout must not exceed Max timeout.")
+			}
+			SpinBox {
+				id: adaptiveTimeoutMin
+				enabled: adaptiveTimeout.checked
+				wheelEnabled: true
+				from: 1
+				to: 60000
+				value: 20
+				editable: true
+				validator: IntValidator {
+					bottom: adaptiveTimeoutMin.from
+					top: adaptiveTimeoutMin.to
+				}
+			}
+
+			LabelDialog {
+				id: labelAdaptiveTimeoutMax
+				title: qsTr("Max timeout")
+				baseTooltipText: qsTr("Upper bound of the adaptive timeout in ms, slow devices may exceed the timeout above up to this value.")
+				errorTooltipText: qsTr("Max timeout is not set.")
+			}
+			SpinBox {
+				id: adaptiveTimeoutMax
+				enabled: adaptiveTimeout.checked
+				wheelEnabled: true
+				from: 1
+				to: 60000
+				value: 5000
+				editable: true
+				validator: IntValidator {
+					bottom: adaptiveTimeoutMax.from
+					top: adaptiveTimeoutMax.to
+				}
+			}
+
 			LabelDialog {
 				id: labelPollingPause
 				title: qsTr("Polling pause")
@@ -367,6 +542,34 @@ Dialog {
 				}
 			}
 
+			LabelDialog {
+				id: labelBlockRead
+				title: qsTr("Block read")
+				baseTooltipText: qsTr("Merge read parameters of one device with adjacent registers into single requests.<br/>Gap - maximum number of unused registers read between merged parameters.")
+				errorTooltipText: qsTr("Gap is not set.")
+			}
+			RowLayout {
+				spacing: 10
+				CheckBox {
+					id: blockRead
+					checked: false
+				}
+				SpinBox {
+					id: blockGap
+					wheelEnabled: true
+					enabled: blockRead.checked
+					from: 0
+					to: 124
+					value: 0
+					editable: true
+					Layout.fillWidth: true
+					validator: IntValidator {
+						bottom: blockGap.from
+						top: blockGap.to
+					}
+				}
+			}
+
 		}
 
 	standardButtons: Dialog.Ok | Dialog.Cancel
@@ -380,7 +583,13 @@ Dialog {
 			res = false
 		}
 
-		if (transportType === "tcp") {
+		// Modbus UDP carries MBAP framed packages only
+		if (transportType === "udp" && protocol.model.get(protocol.currentIndex).type !== "modbus_tcp") {
+			labelTransport.error = true
+			res = false
+		}
+
+		if (transportType === "tcp" || transportType === "udp") {
 			if (!tcpAddress.acceptableInput) {
 				labelTcpAddress.error = true
 				res = false
@@ -389,6 +598,25 @@ Dialog {
 				labelTcpPort.error = true
 				res = false
 			}
+			if (!pipelineWindow.contentItem.acceptableInput) {
+				labelPipelineWindow.error = true
+				res = false
+			}
+			if (transportType === "tcp" && !connections.contentItem.acceptableInput) {
+				labelConnections.error = true
+				res = false
+			}
+		}
+
+		if (transportType === "replay") {
+			if (replayFile.text.length === 0) {
+				labelReplayFile.error = true
+				res = false
+			}
+			if (!replaySpeed.contentItem.acceptableInput) {
+				labelReplaySpeed.error = true
+				res = false
+			}
 		}
 
 		if (transportType === "serial" && !serialPort.acceptableInput) {
@@ -400,21 +628,44 @@ Dialog {
 			labelMaxTimeout.error = true
 			res = false
 		}
+		if (adaptiveTimeout.checked) {
+			if (!adaptiveTimeoutMax.contentItem.acceptableInput) {
+				labelAdaptiveTimeoutMax.error = true
+				res = false
+			}
+			if (!adaptiveTimeoutMin.contentItem.acceptableInput || adaptiveTimeoutMin.value > adaptiveTimeoutMax.value) {
+				labelAdaptiveTimeoutMin.error = true
+				res = false
+			}
+		}
 
 		if (!pollingPause.contentItem.acceptableInput) {
 			labelPollingPause.error = true
 			res = false
 		}
 
+		if (!blockGap.contentItem.acceptableInput) {
+			labelBlockRead.error = true
+			res = false
+		}
+
 		return res
 	}
 
 	function clearErrors() {
+		labelTransport.error = false
 		labelTcpAddress.error = false
 		labelTcpPort.error = false
+		labelPipelineWindow.error = false
+		labelConnections.error = false
+		labelReplayFile.error = false
+		labelReplaySpeed.error = false
 		labelSerialPort.error = false
 		labelMaxTimeout.error = false
+		labelAdaptiveTimeoutMin.error = false
+		labelAdaptiveTimeoutMax.error = false
 		labelPollingPause.error = false
+		labelBlockRead.error = false
 	}
 
 	onAccepted: {
@@ -438,7 +689,17 @@ Dialog {
 					"port": tcpPort.value
 				 },
 				"timeout": maxTimeout.value,
-				"pollingPause": pollingPause.value
+				"pollingPause": pollingPause.value,
+				"blockRead": blockRead.checked,
+				"blockGap": blockGap.value,
+				"pipelineWindow": pipelineWindow.value,
+				"connections": connections.value,
+				"replayFile": replayFile.text,
+				"replaySpeed": replaySpeed.value,
+				"listenOnly": listenOnly.checked,
+				"adaptiveTimeout": adaptiveTimeout.checked,
+				"adaptiveTimeoutMin": adaptiveTimeoutMin.value,
+				"adaptiveTimeoutMax": adaptiveTimeoutMax.value
 			}
 
 			if (newInterface) {
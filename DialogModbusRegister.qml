@@ -49,6 +49,11 @@ Dialog {
 		view.setIndexes(settings.view)
 		byteOrder.setIndex(settings.view.order)
 		settedValue.text = settings.val
+		pollingPeriod.value = (typeof settings.period === "number") ? settings.period : 0
+		pollingPriority.value = (typeof settings.priority === "number") ? settings.priority : 0
+		deadbandMode.setIndex((typeof settings.deadband === "string") ? settings.deadband : "none")
+		deadbandValue.text = (typeof settings.deadband_value === "number") ? settings.deadband_value.toString() : "0"
+		heartbeat.value = (typeof settings.heartbeat === "number") ? settings.heartbeat : 0
 	}
 
 	contentItem:
@@ -273,6 +278,112 @@ Dialog {
 				}
 				Layout.fillWidth: true
 			}
+
+			LabelDialog {
+				id: labelPollingPeriod
+				title: qsTr("Period")
+				baseTooltipText: qsTr("Polling period in ms.<br/>0 - poll as often as possible.")
+				errorTooltipText: qsTr("Period is not set.")
+			}
+			SpinBox {
+				id: pollingPeriod
+				wheelEnabled: true
+				from: 0
+				to: 3600000
+				value: 0
+				stepSize: 100
+				editable: true
+				Layout.fillWidth: true
+				validator: IntValidator {
+					bottom: pollingPeriod.from
+					top: pollingPeriod.to
+				}
+			}
+
+			LabelDialog {
+				id: labelPollingPriority
+				title: qsTr("Priority")
+				baseTooltipText: qsTr("Parameter with higher priority is polled first when several parameters are due at the same time.")
+				errorTooltipText: qsTr("Priority is not set.")
+			}
+			SpinBox {
+				id: pollingPriority
+				wheelEnabled: true
+				from: 0
+				to: 255
+				value: 0
+				editable: true
+				Layout.fillWidth: true
+				validator: IntValidator {
+					bottom: pollingPriority.from
+					top: pollingPriority.to
+				}
+			}
+
+			LabelDialog {
+				id: labelDeadbandMode
+				title: qsTr("Deadband")
+				baseTooltipText: qsTr("Report by exception: unchanged values are not shown.<br/>Raw bytes - any change of the response bytes.<br/>Absolute, Percent - change of a numeric value more than the deadband value.")
+			}
+			ComboBox {
+				id: deadbandMode
+				textRole: "text"
+				model: ListModel {
+					ListElement {text: qsTr("None"); type: "none"}
+					ListElement {text: qsTr("Raw bytes"); type: "raw"}
+					ListElement {text: qsTr("Absolute"); type: "absolute"}
+					ListElement {text: qsTr("Percent"); type: "percent"}
+				}
+				Layout.fillWidth: true
+
+				function setIndex(mode) {
+					for (var i = 0; i < model.count; i++) {
+						if (model.get(i).type === mode) {
+							currentIndex = i
+						}
+					}
+				}
+			}
+
+			LabelDialog {
+				id: labelDeadbandValue
+				title: qsTr("Deadband value")
+				baseTooltipText: qsTr("Minimal change of the value (Absolute) or minimal change in % of the last shown value (Percent).")
+				errorTooltipText: qsTr("Deadband value must be a non-negative number.")
+			}
+			TextField {
+				id: deadbandValue
+				selectByMouse: true
+				text: "0"
+				enabled: deadbandMode.currentIndex > 1
+				validator: DoubleValidator {
+					bottom: 0
+					notation: DoubleValidator.StandardNotation
+				}
+				Layout.fillWidth: true
+			}
+
+			LabelDialog {
+				id: labelHeartbeat
+				title: qsTr("Heartbeat")
+				baseTooltipText: qsTr("Max time in ms without showing an unchanged value.<br/>0 - not limited.")
+				errorTooltipText: qsTr("Heartbeat is not set.")
+			}
+			SpinBox {
+				id: heartbeat
+				wheelEnabled: true
+				from: 0
+				to: 3600000
+				value: 0
+				stepSize: 1000
+				editable: true
+				enabled: deadbandMode.currentIndex > 0
+				Layout.fillWidth: true
+				validator: IntValidator {
+					bottom: heartbeat.from
+					top: heartbeat.to
+				}
+			}
 		}
 
 	standardButtons: Dialog.Ok | Dialog.Cancel
@@ -318,6 +429,22 @@ Dialog {
 			labelRegistersCount.error = true
 			res = false
 		}
+		if (!pollingPeriod.contentItem.acceptableInput) {
+			labelPollingPeriod.error = true
+			res = false
+		}
+		if (!pollingPriority.contentItem.acceptableInput) {
+			labelPollingPriority.error = true
+			res = false
+		}
+		if (!deadbandValue.acceptableInput) {
+			labelDeadbandValue.error = true
+			res = false
+		}
+		if (!heartbeat.contentItem.acceptableInput) {
+			labelHeartbeat.error = true
+			res = false
+		}
 		if (parameterType === "write" && !settedValue.acceptableInput) {
 			labelSettedValue.errorTooltipText = qsTr("Value is not set.")
 			labelSettedValue.error = true
@@ -335,6 +462,10 @@ Dialog {
 		labelView.error = false
 		labelByteOrder.error = false
 		labelSettedValue.error = false
+		labelPollingPeriod.error = false
+		labelPollingPriority.error = false
+		labelDeadbandValue.error = false
+		labelHeartbeat.error = false
 	}
 
 	onAccepted: {
@@ -356,7 +487,12 @@ Dialog {
 					"order": byteOrder.model.get(byteOrder.currentIndex).type
 				 },
 				"val": settedValue.text,
-				"type": parameterType
+				"type": parameterType,
+				"period": pollingPeriod.value,
+				"priority": pollingPriority.value,
+				"deadband": deadbandMode.model.get(deadbandMode.currentIndex).type,
+				"deadband_value": Number(deadbandValue.text),
+				"heartbeat": heartbeat.value
 			}
 			if (parameterType === "write") {
 				var parseValue = mainApp.parseStringValue(settings)
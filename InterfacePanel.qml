@@ -50,6 +50,10 @@ Page {
 	property int selectedIndex: -1
 	property bool minimized: false
 	property int interfaceId
+	// Learned response times of devices: address -> text
+	property var deviceTimings: ({})
+	// Polling statistics of the interface (see WSQMLApplication::interfaceStatistics)
+	property var statistics: ({})
 	property var parameterDialog: null
 	property var interfaceSettings:
 		({
@@ -213,6 +217,8 @@ Page {
 
 	function pollingStarted() {
 		pollingLockFlag = true
+		deviceTimings = {}
+		statistics = {}
 		taskIndicatorText = qsTr("Connection...")
 		showTaskIndicator = true
 		showTaskAnimation = true
@@ -257,24 +263,32 @@ Page {
 		showTaskAnimation = false
 	}
 
-	function errorOccurred(paramId, errCode, errorCounter) {
+	function deviceTiming(device, srtt, rttvar, timeout) {
+		var timings = {}
+		for (var d in deviceTimings) {
+			timings[d] = deviceTimings[d]
+		}
+		timings[device] = "#" + device + ": " + (srtt / 1000).toFixed(1) + " \u00B1 " + (rttvar / 1000).toFixed(1) + " / " + timeout + " " + qsTr("ms")
+		deviceTimings = timings
+	}
+
+	function errorOccurred(paramId, errCode, errorCounter, date) {
 		if (getParamSettingsInModel(paramId).type === "write") {
 			setParamSettingsInModel(paramId, {"status": errCode, "error": errorCounter})
 		} else {
 			setParamSettingsInModel(paramId, {"val": "-", "status": errCode, "error": errorCounter})
-			var date = new Date()
 			addValueToSeries(paramId, date, "-", false, errCode)
 			addValueToTable(paramId, date, "-", errCode)
 		}
 	}
 
-	function valueChanged(paramId, value, valueRaw, responseCounter) {
+	// Date of the latest response, intermediate values are coalesced between deliveries
+	function valueChanged(paramId, value, valueRaw, responseCounter, date) {
 		var textOk = qsTr("OK")
 		if (getParamSettingsInModel(paramId).type === "write") {
 			setParamSettingsInModel(paramId, {"poll": false, "status": textOk, "response": responseCounter})
 		} else {
 			setParamSettingsInModel(paramId, {"val": value, "status": textOk, "response": responseCounter})
-			var date = new Date()
 			addValueToSeries(paramId, date, value, valueRaw, 0)
 			addValueToTable(paramId, date, value, 0)
 		}
@@ -289,6 +303,28 @@ Page {
 		}
 	}
 
+	// Queued setpoint write is finished, latency from queueing to the result
+	function writeCompleted(paramId, latency) {
+		var param = getParamSettingsInModel(paramId)
+		if (param !== null) {
+			setParamSettingsInModel(paramId, {"poll": false, "status": param.status + " (" + latency.toFixed(1) + " " + qsTr("ms") + ")"})
+		}
+	}
+
+	function histogramToString(name, h) {
+		return name + ": " + h.p50.toFixed(1) + " / " + h.p95.toFixed(1) + " / " + h.p99.toFixed(1) + " / " + h.max.toFixed(1) + " " + qsTr("ms")
+	}
+
+	Timer {
+		id: statisticsTimer
+		interval: 1000
+		running: pollingLockFlag
+		repeat: true
+		onTriggered: {
+			statistics = mainApp.interfaceStatistics(interfaceId)
+		}
+	}
+
 	function valueRequest(paramId, requestCounter) {
 		setParamSettingsInModel(paramId, {"request": requestCounter})
 	}
@@ -386,6 +422,11 @@ Page {
 			"val": ((settings.type === "read")?"":settings.val),
 			"status": "",
 			"type": settings.type,
+			"period": settings.hasOwnProperty("period") ? settings.period : 0,
+			"priority": settings.hasOwnProperty("priority") ? settings.priority : 0,
+			"deadband": settings.hasOwnProperty("deadband") ? settings.deadband : "none",
+			"deadband_value": settings.hasOwnProperty("deadband_value") ? settings.deadband_value : 0,
+			"heartbeat": settings.hasOwnProperty("heartbeat") ? settings.heartbeat : 0,
 			"request": 0,
 			"response": 0,
 			"error": 0,
@@ -610,7 +651,7 @@ Page {
 				iconSource: "qrc:/icon/interface_polling_stop.png"
 				iconSourceDisabled: "qrc:/icon/interface_polling_stop_dis.png"
 				ToolTip.text: qsTr("Stop interface polling.")
-				enabled: (listView.model.count > 0) && pollingLockFlag
+				enabled: pollingLockFlag
 				onClicked: pollingStop()
 			}
 			WSToolSeparator {}
@@ -619,7 +660,6 @@ Page {
 				iconSource: "qrc:/icon/parameter_add.png"
 				iconSourceDisabled: "qrc:/icon/parameter_add_dis.png"
 				ToolTip.text: qsTr("Append polling parameter.")
-				enabled: !pollingLockFlag
 				onClicked: newParameter()
 			}
 			WSToolButton {
@@ -627,7 +667,7 @@ Page {
 				iconSource: "qrc:/icon/parameter_edit.png"
 				iconSourceDisabled: "qrc:/icon/parameter_edit_dis.png"
 				ToolTip.text: qsTr("Edit selected parameter.")
-				enabled: (selectedIndex >= 0) && !pollingLockFlag
+				enabled: selectedIndex >= 0
 				onClicked: editParameter()
 			}
 			WSToolButton {
@@ -635,7 +675,7 @@ Page {
 				iconSource: "qrc:/icon/parameter_delete.png"
 				iconSourceDisabled: "qrc:/icon/parameter_delete_dis.png"
 				ToolTip.text: qsTr("Remove selected parameter.")
-				enabled: (selectedIndex >= 0) && !pollingLockFlag
+				enabled: selectedIndex >= 0
 				property bool accepted: false
 				onAcceptedChanged: {
 					if (accepted) {
@@ -720,10 +760,23 @@ Page {
 						+ interfaceSettings.serial.dataBits + "/"
 						+ parity + "/"
 						+ stop + "]"
+						if (interfaceSettings.listenOnly === true) {
+							str += " " + qsTr("(listen only)")
+						}
 					} else if (interfaceSettings.transportType === "tcp") {
 						str += qsTr("TCP")
 						+ " [" + interfaceSettings.tcp.ipAddress + ":"
 						+ interfaceSettings.tcp.port + "]"
+						if (interfaceSettings.connections > 1) {
+							str += " x" + interfaceSettings.connections
+						}
+					} else if (interfaceSettings.transportType === "replay") {
+						str += qsTr("Replay")
+						+ " [" + interfaceSettings.replaySpeed + "%]"
+					} else if (interfaceSettings.transportType === "udp") {
+						str += qsTr("UDP")
+						+ " [" + interfaceSettings.tcp.ipAddress + ":"
+						+ interfaceSettings.tcp.port + "]"
 					}
 					return str
 				}
@@ -733,6 +786,52 @@ Page {
 				verticalAlignment: Qt.AlignVCenter
 				Layout.fillWidth: true
 			}
+			Label {
+				id: labelDeviceTimings
+				property var timings: {
+					var list = []
+					for (var d in deviceTimings) {
+						list.push(deviceTimings[d])
+					}
+					return list
+				}
+				text: (timings.length > 0) ? (qsTr("Response") + "<br/>" + timings[0] + ((timings.length > 1) ? " ..." : "")) : ""
+				visible: timings.length > 0
+				elide: Label.ElideRight
+				horizontalAlignment: Qt.AlignHCenter
+				verticalAlignment: Qt.AlignVCenter
+				Layout.maximumWidth: 200
+				ToolTip.delay: Qt.styleHints.mousePressAndHoldInterval
+				ToolTip.visible: timingsArea.containsMouse
+				ToolTip.text: qsTr("Response time (smoothed \u00B1 variation) / timeout of devices:") + "<br/>" + timings.join("<br/>")
+				MouseArea {
+					id: timingsArea
+					anchors.fill: parent
+					hoverEnabled: true
+				}
+			}
+			Label {
+				id: labelStatistics
+				property bool ready: statistics.hasOwnProperty("rtt")
+				text: ready ? (qsTr("Throughput") + "<br/>" + statistics.framesRate.toFixed(0) + " " + qsTr("frames/s") + ", " + (statistics.bytesRate / 1000).toFixed(1) + " " + qsTr("kB/s")) : ""
+				visible: ready
+				elide: Label.ElideRight
+				horizontalAlignment: Qt.AlignHCenter
+				verticalAlignment: Qt.AlignVCenter
+				Layout.maximumWidth: 200
+				ToolTip.delay: Qt.styleHints.mousePressAndHoldInterval
+				ToolTip.visible: statisticsArea.containsMouse
+				ToolTip.text: ready ? (qsTr("p50 / p95 / p99 / max since the start:") + "<br/>"
+					+ histogramToString(qsTr("Response"), statistics.rtt) + "<br/>"
+					+ histogramToString(qsTr("Cycle"), statistics.cycle) + "<br/>"
+					+ histogramToString(qsTr("Jitter"), statistics.jitter) + "<br/>"
+					+ qsTr("Responses") + ": " + statistics.frames + ", " + qsTr("bytes") + ": " + statistics.bytes) : ""
+				MouseArea {
+					id: statisticsArea
+					anchors.fill: parent
+					hoverEnabled: true
+				}
+			}
 			WSToolButton {
 				id: btnInterfaceEdit
 				enabled: !pollingLockFlag
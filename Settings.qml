@@ -28,6 +28,8 @@ Item {
 	property string dateTimeFormat: qsTr("dd.MM.yyyy hh:mm:ss.zzz")
 	property int chartMaxDataSize: 20000
 	property int traceTableMaxDataSize: 2000
+	// Period of batched parameter values delivery from polling threads in ms
+	property int valuesUpdatePeriod: 40
 	property string projectFileExtension: "weprex"
 	property string csvSeparator: ";"
 	property string csvLineEnd: "\r\n"
@@ -0,0 +1,282 @@
+/****************************************************************************
+
+  This file is part of the Webstella Modbus "C" utility library.
+
+  Copyright (C) 2011 - 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+/*
+ * Codec micro-benchmark for the Modbus "C" library.
+ * Byte order conversion engines are compared in one run (250 bytes, block of 125 registers).
+ * Build it twice to compare CRC engines, e.g.:
+ *   qmake "DEFINES+=MB_CRC16_SLICE=1" && make   (byte-wise table, baseline)
+ *   qmake && make                               (default engine)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "modbus.h"
+
+/* Minimal measuring time of one case in seconds */
+#define BENCH_TIME 0.5
+/* Iterations between clock checks */
+#define BENCH_BATCH 10000
+
+typedef void (*bench_func)(void *ctx);
+
+struct bench_package_ctx {
+	struct modbus_client_parameter *param;
+	uint8_t package[MB_SIZE_MPAB_HEADER + 256];
+	uint16_t package_len;
+	uint8_t type;
+};
+
+struct bench_convert_ctx {
+	uint8_t in[MB_SIZE_REGISTER * 125];
+	uint8_t out[MB_SIZE_REGISTER * 125];
+	uint8_t order;
+};
+
+static volatile uint16_t bench_sink;
+
+static const char *convert_engines[] = {"scalar", "ssse3", "avx2"};
+static const char *convert_orders[] = {"forward", "backward", "forward regs reverse", "backward regs reverse"};
+
+/* Reference bitwise CRC16 (polynom 0xA001) */
+static uint16_t crc16_bitwise(const uint8_t *data, uint16_t length) {
+	uint16_t crc_word = 0xFFFF;
+	uint8_t i;
+	while (length--) {
+		crc_word ^= *data++;
+		for (i = 0; i < 8; i++) {
+			if (crc_word & 1) {
+				crc_word = (crc_word >> 1) ^ 0xA001;
+			} else {
+				crc_word >>= 1;
+			}
+		}
+	}
+	return crc_word;
+}
+
+/* Reference byte-wise conversion */
+static void convert_bytewise(const uint8_t *in, uint8_t *out, uint16_t len, uint8_t order) {
+	uint16_t i;
+	for (i = 0; i < len; i++) {
+		if (order == MB_BO_FORWARD) {
+			out[i] = in[i];
+		} else if (order == MB_BO_BACKWARD) {
+			out[i] = in[len - i - 1];
+		} else if (order == MB_BO_FORWARD_REGS_REVERSE) {
+			out[i] = ((i % 2 == 0)?in[i + 1]:in[i - 1]);
+		} else {
+			out[i] = ((i % 2 == 0)?in[len - i - 2]:in[len - i]);
+		}
+	}
+}
+
+static double bench_run(const char *name, bench_func func, void *ctx, uint32_t bytes_per_call) {
+	clock_t start;
+	double elapsed;
+	uint64_t calls = 0;
+	uint32_t i;
+
+	start = clock();
+	do {
+		for (i = 0; i < BENCH_BATCH; i++) {
+			func(ctx);
+		}
+		calls += BENCH_BATCH;
+		elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+	} while (elapsed < BENCH_TIME);
+	if (bytes_per_call > 0) {
+		printf("%-40s %12.0f calls/s %10.1f MB/s\n", name, calls / elapsed, (calls * bytes_per_call) / elapsed / 1e6);
+	} else {
+		printf("%-40s %12.0f frames/s\n", name, calls / elapsed);
+	}
+	return calls / elapsed;
+}
+
+static uint8_t crc_data[256];
+
+static void bench_crc_bitwise(void *ctx) {
+	(void) ctx;
+	bench_sink = crc16_bitwise(crc_data, sizeof(crc_data));
+}
+
+static void bench_crc_engine(void *ctx) {
+	(void) ctx;
+	bench_sink = modbus_crc16(crc_data, sizeof(crc_data));
+}
+
+static void bench_convert_bytewise(void *ctx) {
+	struct bench_convert_ctx *c = (struct bench_convert_ctx*) ctx;
+	convert_bytewise(c->in, c->out, sizeof(c->in), c->order);
+	bench_sink = c->out[0];
+}
+
+static void bench_convert_engine(void *ctx) {
+	struct bench_convert_ctx *c = (struct bench_convert_ctx*) ctx;
+	modbus_convert_data(c->in, c->out, sizeof(c->in), c->order);
+	bench_sink = c->out[0];
+}
+
+static void bench_request(void *ctx) {
+	struct bench_package_ctx *c = (struct bench_package_ctx*) ctx;
+	bench_sink = modbus_client_request_package(c->param, c->type, c->package, bench_sink);
+}
+
+static void bench_response(void *ctx) {
+	struct bench_package_ctx *c = (struct bench_package_ctx*) ctx;
+	bench_sink = modbus_client_response_package(c->param, c->package, c->package_len, c->type);
+}
+
+/* Build a valid read holding registers response for param */
+static uint16_t make_response(const struct modbus_client_parameter *param, uint8_t type, uint8_t *package) {
+	uint8_t *pdu;
+	uint16_t i;
+	uint16_bytes val2byte;
+
+	pdu = &package[(type == MB_RTU) ? MB_SIZE_SERIAL_HEADER : MB_SIZE_MPAB_HEADER];
+	pdu[MB_OFFSET_FCODE] = param->function_code;
+	pdu[MB_OFFSET_OUT_SIZE] = param->size;
+	for (i = 0; i < param->size; i++) {
+		pdu[MB_OFFSET_OUT_START_DATA + i] = (uint8_t) (i * 7);
+	}
+	if (type == MB_RTU) {
+		package[MB_OFFSET_SERIAL_ADR] = param->device_adr;
+		val2byte.uint = modbus_crc16(package, param->size + MB_OFFSET_OUT_START_DATA + MB_SIZE_SERIAL_HEADER);
+		package[param->size + MB_OFFSET_OUT_START_DATA + MB_SIZE_SERIAL_HEADER] = val2byte.bytes[0];
+		package[param->size + MB_OFFSET_OUT_START_DATA + MB_SIZE_SERIAL_HEADER + 1] = val2byte.bytes[1];
+		return param->size + MB_SIZE_RTU_OUT_READ_SERVICE_BLOCK;
+	}
+	modbus_client_tcp_mpab(0, package, param->size + MB_OFFSET_OUT_START_DATA + 1, param->device_adr);
+	return param->size + MB_OFFSET_OUT_START_DATA + MB_SIZE_MPAB_HEADER;
+}
+
+static int verify_crc(void) {
+	uint8_t buf[300];
+	uint16_t len, i;
+	uint32_t round;
+
+	srand(1);
+	for (round = 0; round < 2000; round++) {
+		len = (uint16_t) (round % sizeof(buf));
+		for (i = 0; i < len; i++) {
+			buf[i] = (uint8_t) rand();
+		}
+		if (modbus_crc16(buf, len) != crc16_bitwise(buf, len)) {
+			printf("CRC mismatch: length %u\n", len);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int verify_convert(void) {
+	uint8_t in[300], ref[300], out[300];
+	uint16_t len, i;
+	uint8_t engine, order;
+
+	for (i = 0; i < sizeof(in); i++) {
+		in[i] = (uint8_t) (i * 13 + 5);
+	}
+	for (engine = MB_CONVERT_SCALAR; engine <= MB_CONVERT_AVX2; engine++) {
+		if (!modbus_convert_set_engine(engine)) {
+			continue;
+		}
+		for (len = 0; len < sizeof(in); len += MB_SIZE_REGISTER) {
+			for (order = MB_BO_FORWARD; order <= MB_BO_BACKWARD_REGS_REVERSE; order++) {
+				convert_bytewise(in, ref, len, order);
+				modbus_convert_data(in, out, len, order);
+				if (memcmp(ref, out, len) != 0) {
+					printf("Conversion mismatch: engine %s, order %s, length %u\n", convert_engines[engine], convert_orders[order], len);
+					return 0;
+				}
+			}
+		}
+	}
+	return 1;
+}
+
+int main(void) {
+	struct bench_convert_ctx conv;
+	uint8_t engine, best_engine;
+	struct bench_package_ctx ctx;
+	uint16_t i;
+	const uint16_t regs[] = {1, 125};
+	uint8_t r;
+	char name[64];
+
+	printf("CRC16 engine: %s\n", (MB_CRC16_SLICE == 1) ? "byte-wise table" : ((MB_CRC16_SLICE == 4) ? "slicing-by-4" : "slicing-by-8"));
+	if (!verify_crc()) {
+		return 1;
+	}
+	printf("CRC16 engine matches bitwise reference\n\n");
+
+	for (i = 0; i < sizeof(crc_data); i++) {
+		crc_data[i] = (uint8_t) (i * 31 + 7);
+	}
+	bench_run("crc16 bitwise (256 bytes)", bench_crc_bitwise, NULL, sizeof(crc_data));
+	bench_run("crc16 engine (256 bytes)", bench_crc_engine, NULL, sizeof(crc_data));
+	printf("\n");
+
+	best_engine = modbus_convert_engine();
+	printf("Byte order engine: %s (best supported)\n", convert_engines[best_engine]);
+	if (!verify_convert()) {
+		return 1;
+	}
+	printf("Byte order engines match byte-wise reference\n\n");
+	for (i = 0; i < sizeof(conv.in); i++) {
+		conv.in[i] = (uint8_t) (i * 17 + 3);
+	}
+	for (conv.order = MB_BO_BACKWARD; conv.order <= MB_BO_BACKWARD_REGS_REVERSE; conv.order++) {
+		snprintf(name, sizeof(name), "%s byte-wise", convert_orders[conv.order]);
+		bench_run(name, bench_convert_bytewise, &conv, sizeof(conv.in));
+		for (engine = MB_CONVERT_SCALAR; engine <= best_engine; engine++) {
+			modbus_convert_set_engine(engine);
+			snprintf(name, sizeof(name), "%s %s", convert_orders[conv.order], convert_engines[engine]);
+			bench_run(name, bench_convert_engine, &conv, sizeof(conv.in));
+		}
+		modbus_convert_set_engine(best_engine);
+	}
+	printf("\n");
+
+	for (r = 0; r < sizeof(regs) / sizeof(regs[0]); r++) {
+		ctx.param = modbus_client_param_create(1, MB_FC_READ_HOLDING_REGISTERS, 100, regs[r], MB_ALWAYS_POLLING);
+		if (ctx.param == NULL) {
+			return 1;
+		}
+		ctx.type = MB_RTU;
+		snprintf(name, sizeof(name), "RTU request (%u regs)", regs[r]);
+		bench_run(name, bench_request, &ctx, 0);
+		ctx.package_len = make_response(ctx.param, MB_RTU, ctx.package);
+		snprintf(name, sizeof(name), "RTU response (%u regs)", regs[r]);
+		bench_run(name, bench_response, &ctx, 0);
+		ctx.type = MB_TCP;
+		snprintf(name, sizeof(name), "TCP request (%u regs)", regs[r]);
+		bench_run(name, bench_request, &ctx, 0);
+		ctx.package_len = make_response(ctx.param, MB_TCP, ctx.package);
+		snprintf(name, sizeof(name), "TCP response (%u regs)", regs[r]);
+		bench_run(name, bench_response, &ctx, 0);
+		modbus_client_param_destroy(ctx.param);
+	}
+	return 0;
+}
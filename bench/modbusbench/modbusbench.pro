@@ -0,0 +1,16 @@
+TEMPLATE = app
+CONFIG += console c99
+CONFIG -= qt app_bundle
+
+TARGET = modbusbench
+
+INCLUDEPATH += ../../protocols
+
+SOURCES += \
+	main.c \
+	../../protocols/modbus.c \
+	../../protocols/libdefs.c
+
+HEADERS += \
+	../../protocols/modbus.h \
+	../../protocols/libdefs.h
@@ -28,8 +28,32 @@ const quint32 Conf::DEVICE_RECONNECTION_PAUSE = 2000;
 const quint32 Conf::DEVICE_CONNECTION_WAIT_TIME = 10000;
 const quint32 Conf::DEVICE_DISCONNECTION_WAIT_TIME = 20000;
 const bool Conf::DEVICE_TCP_AUTO_RECONNECT = true;
+const quint32 Conf::DEVICE_TCP_MAX_PIPELINE_WINDOW = 16;
+// Parallel connections to one gateway, devices are spread over them by unit id
+const quint32 Conf::DEVICE_TCP_MAX_CONNECTIONS = 16;
+// Retransmissions of a lost UDP request
+const quint32 Conf::DEVICE_UDP_RETRIES = 2;
+// Receive buffer capacity in protocol buffer sizes (several pipelined packages in one read)
+const quint32 Conf::DEVICE_RECEIVE_BUFFER_PACKAGES = 4;
 const quint32 Conf::DEVICE_THREAD_SLEEP_PAUSE = 1;
 const quint32 Conf::DEVICE_ERROR_SLEEP_PAUSE = 50;
+// Threads shared by event-driven interfaces (0 - number of CPU cores)
+const quint32 Conf::DEVICE_REACTOR_THREADS = 0;
+// Added to the RTU inter-frame silence, covers delivery latency of serial drivers (USB adapters) in ms
+const quint32 Conf::DEVICE_SERIAL_SILENCE_GUARD = 20;
+// Default bounds of the adaptive response timeout in ms (the interface timeout is used until the first response)
+const quint32 Conf::DEVICE_ADAPTIVE_TIMEOUT_MIN = 20;
+const quint32 Conf::DEVICE_ADAPTIVE_TIMEOUT_MAX = 5000;
+// Minimal period of device round-trip time reports in ms
+const quint32 Conf::DEVICE_TIMING_REPORT_PERIOD = 1000;
+// Default period of batched parameter updates delivery to the UI in ms (about one frame at 25 fps)
+const quint32 Conf::UI_UPDATE_PERIOD = 40;
+const quint16 Conf::MODBUS_MAX_READ_REGISTERS = 125;
+const quint16 Conf::MODBUS_MAX_READ_BITS = 2000;
+// RTU device is quarantined after consecutive timeouts and probed with growing interval (ms)
+const quint8 Conf::MODBUS_QUARANTINE_TIMEOUTS = 3;
+const quint32 Conf::MODBUS_QUARANTINE_PROBE_MIN = 1000;
+const quint32 Conf::MODBUS_QUARANTINE_PROBE_MAX = 30000;
 const QString Conf::DEFAULT_STORE_SETTINGS_FILE = "appset.ini";
 const QString Conf::MANUAL_FILE_PATH = "weprex_0.1.1_manual.pdf";
 
@@ -33,8 +33,23 @@ public:
 	static const quint32 DEVICE_CONNECTION_WAIT_TIME;
 	static const quint32 DEVICE_DISCONNECTION_WAIT_TIME;
 	static const bool DEVICE_TCP_AUTO_RECONNECT;
+	static const quint32 DEVICE_TCP_MAX_PIPELINE_WINDOW;
+	static const quint32 DEVICE_TCP_MAX_CONNECTIONS;
+	static const quint32 DEVICE_UDP_RETRIES;
+	static const quint32 DEVICE_RECEIVE_BUFFER_PACKAGES;
 	static const quint32 DEVICE_THREAD_SLEEP_PAUSE;
 	static const quint32 DEVICE_ERROR_SLEEP_PAUSE;
+	static const quint32 DEVICE_REACTOR_THREADS;
+	static const quint32 DEVICE_SERIAL_SILENCE_GUARD;
+	static const quint32 DEVICE_ADAPTIVE_TIMEOUT_MIN;
+	static const quint32 DEVICE_ADAPTIVE_TIMEOUT_MAX;
+	static const quint32 DEVICE_TIMING_REPORT_PERIOD;
+	static const quint32 UI_UPDATE_PERIOD;
+	static const quint16 MODBUS_MAX_READ_REGISTERS;
+	static const quint16 MODBUS_MAX_READ_BITS;
+	static const quint8 MODBUS_QUARANTINE_TIMEOUTS;
+	static const quint32 MODBUS_QUARANTINE_PROBE_MIN;
+	static const quint32 MODBUS_QUARANTINE_PROBE_MAX;
 	static const QString DEFAULT_STORE_SETTINGS_FILE;
 	static const QString MANUAL_FILE_PATH;
 
@@ -0,0 +1,101 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#include "wslatencyhistogram.h"
+
+WSLatencyHistogram::WSLatencyHistogram() :
+	m_count(0),
+	m_max(0)
+{
+	for (auto &b: m_buckets) {
+		b.store(0, std::memory_order_relaxed);
+	}
+}
+
+void WSLatencyHistogram::record(qint64 value) {
+	if (value < 0) {
+		value = 0;
+	}
+	m_buckets[bucket(static_cast<quint64>(value))].fetch_add(1, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+	qint64 max = m_max.load(std::memory_order_relaxed);
+	while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+void WSLatencyHistogram::reset() {
+	for (auto &b: m_buckets) {
+		b.store(0, std::memory_order_relaxed);
+	}
+	m_count.store(0, std::memory_order_relaxed);
+	m_max.store(0, std::memory_order_relaxed);
+}
+
+quint64 WSLatencyHistogram::count() const {
+	return m_count.load(std::memory_order_relaxed);
+}
+
+qint64 WSLatencyHistogram::max() const {
+	return m_max.load(std::memory_order_relaxed);
+}
+
+qint64 WSLatencyHistogram::percentile(double percentile) const {
+	// Total of the buckets, the counter may run ahead of them while reading
+	quint64 total = 0;
+	for (auto const& b: m_buckets) {
+		total += b.load(std::memory_order_relaxed);
+	}
+	if (total == 0) {
+		return 0;
+	}
+	quint64 rank = static_cast<quint64>(qBound(0.0, percentile, 100.0) / 100.0 * static_cast<double>(total) + 0.5);
+	rank = qBound<quint64>(1, rank, total);
+	quint64 sum = 0;
+	qint64 max = m_max.load(std::memory_order_relaxed);
+	for (quint32 i = 0; i < BUCKETS; i++) {
+		sum += m_buckets[i].load(std::memory_order_relaxed);
+		if (sum >= rank) {
+			return qMin(bucketHighest(i), max);
+		}
+	}
+	return max;
+}
+
+// Values below SUB_BUCKETS are exact, each next power of two range has SUB_BUCKETS buckets
+quint32 WSLatencyHistogram::bucket(quint64 value) {
+	if (value >= (Q_UINT64_C(1) << VALUE_BITS)) {
+		return BUCKETS - 1;
+	}
+	if (value < SUB_BUCKETS) {
+		return static_cast<quint32>(value);
+	}
+	quint32 shift = 63 - static_cast<quint32>(qCountLeadingZeroBits(value)) - SUB_BUCKET_BITS;
+	return shift * SUB_BUCKETS + static_cast<quint32>(value >> shift);
+}
+
+qint64 WSLatencyHistogram::bucketHighest(quint32 bucket) {
+	if (bucket < SUB_BUCKETS) {
+		return bucket;
+	}
+	quint32 shift = bucket / SUB_BUCKETS - 1;
+	quint64 top = bucket % SUB_BUCKETS + SUB_BUCKETS;
+	return static_cast<qint64>(((top + 1) << shift) - 1);
+}
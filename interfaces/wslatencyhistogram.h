@@ -0,0 +1,62 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSLATENCYHISTOGRAM_H
+#define WSLATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <QtCore>
+
+/**
+ * @brief Lock-free histogram of times in us with log-linear buckets (as in HdrHistogram):
+ * each power of two range is split into SUB_BUCKETS linear buckets, relative error is below 1/SUB_BUCKETS.
+ * Written by the polling thread, read by any thread at any time (a read is not an exact snapshot).
+ */
+class WSLatencyHistogram {
+
+public:
+	static const quint32 SUB_BUCKET_BITS = 5;
+	static const quint32 SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+	// Values above are counted as the max value (~71 min)
+	static const quint32 VALUE_BITS = 32;
+	static const quint32 BUCKETS = SUB_BUCKETS * (VALUE_BITS - SUB_BUCKET_BITS + 1);
+
+	WSLatencyHistogram();
+
+	void record(qint64 value);
+	void reset();
+
+	quint64 count() const;
+	qint64 max() const;
+	// Value at the percentile (0 - 100), highest value of the bucket bounded by the max. 0 if empty
+	qint64 percentile(double percentile) const;
+
+private:
+	std::atomic<quint32> m_buckets[BUCKETS];
+	std::atomic<quint64> m_count;
+	std::atomic<qint64> m_max;
+
+	static quint32 bucket(quint64 value);
+	static qint64 bucketHighest(quint32 bucket);
+};
+
+#endif // WSLATENCYHISTOGRAM_H
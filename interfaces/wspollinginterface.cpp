@@ -37,6 +37,13 @@ void WSPollingInterface::start() {
 	setStarted(true);
 	emit started();
 	workerLoop();
+	if (!eventDriven()) {
+		finish();
+	}
+}
+
+// Return to the main thread after polling
+void WSPollingInterface::finish() {
 	if (m_mainThread != nullptr) {
 		moveToThread(m_mainThread);
 	}
@@ -44,6 +51,10 @@ void WSPollingInterface::start() {
 	emit stopped();
 }
 
+bool WSPollingInterface::eventDriven() const {
+	return false;
+}
+
 void WSPollingInterface::stop() {
 	setStopFlag(true);
 }
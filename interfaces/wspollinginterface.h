@@ -30,7 +30,8 @@
 enum class WSInterface {
 	TCP = 0,
 	SERIAL = 1,
-	UDP = 2
+	UDP = 2,
+	REPLAY = 3
 };
 
 class WSPollingInterface : public QObject {
@@ -46,7 +47,10 @@ public:
 	virtual bool isStarted();
 
 	virtual WSInterface type() const = 0;
+	// Blocking polling loop, or start of the state machine for event-driven interface
 	virtual void workerLoop() = 0;
+	// Interface works in the event loop of its thread and calls finish() itself
+	virtual bool eventDriven() const;
 
 signals:
 	void started();
@@ -70,6 +74,7 @@ protected:
 	void setStopFlag(bool stop);
 	bool getStopFlag();
 	void setStarted(bool busy);
+	void finish();
 	
 };
 
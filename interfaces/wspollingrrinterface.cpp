@@ -8,8 +8,21 @@ WSPollingRRInterface::WSPollingRRInterface(WSAbstractRRProtocol *protocol, QThre
 	m_pollingPause(50),
 	m_skipPause(Conf::DEVICE_THREAD_SLEEP_PAUSE),
 	m_errorPause(Conf::DEVICE_ERROR_SLEEP_PAUSE),
-	m_releaseFlag(false)
+	m_releaseFlag(false),
+	m_adaptiveTimeout(false),
+	m_adaptiveTimeoutMin(Conf::DEVICE_ADAPTIVE_TIMEOUT_MIN),
+	m_adaptiveTimeoutMax(Conf::DEVICE_ADAPTIVE_TIMEOUT_MAX),
+	m_dataTrace(true),
+	m_requestDevice(0),
+	m_requestSent(0),
+	m_requestTimeout(1000),
+	m_framesCount(0),
+	m_bytesCount(0),
+	m_cycleStart(-1),
+	m_lastTransmit(-1),
+	m_lastInterval(-1)
 {
+	m_rttClock.start();
 	connectSlotSignals();
 }
 
@@ -17,12 +30,14 @@ WSPollingRRInterface::~WSPollingRRInterface() {
 	if (!m_releaseFlag) {
 		disconnect(this, &WSPollingRRInterface::transmitTimeoutOccurred, m_protocol.get(), &WSAbstractRRProtocol::timeoutOccurred);
 		disconnect(this, &WSPollingRRInterface::receiveTimeoutOccurred, m_protocol.get(), &WSAbstractRRProtocol::timeoutOccurred);
+		disconnect(this, &WSPollingRRInterface::transactionTimeoutOccurred, m_protocol.get(), &WSAbstractRRProtocol::transactionTimeout);
 	}
 }
 
 void WSPollingRRInterface::connectSlotSignals() {
 	connect(this, &WSPollingRRInterface::transmitTimeoutOccurred, m_protocol.get(), &WSAbstractRRProtocol::timeoutOccurred);
 	connect(this, &WSPollingRRInterface::receiveTimeoutOccurred, m_protocol.get(), &WSAbstractRRProtocol::timeoutOccurred);
+	connect(this, &WSPollingRRInterface::transactionTimeoutOccurred, m_protocol.get(), &WSAbstractRRProtocol::transactionTimeout);
 	m_releaseFlag = false;
 }
 
@@ -30,6 +45,7 @@ void WSPollingRRInterface::disconnectSlotSignals() {
 	if (!m_releaseFlag) {
 		disconnect(this, &WSPollingRRInterface::transmitTimeoutOccurred, m_protocol.get(), &WSAbstractRRProtocol::timeoutOccurred);
 		disconnect(this, &WSPollingRRInterface::receiveTimeoutOccurred, m_protocol.get(), &WSAbstractRRProtocol::timeoutOccurred);
+		disconnect(this, &WSPollingRRInterface::transactionTimeoutOccurred, m_protocol.get(), &WSAbstractRRProtocol::transactionTimeout);
 		m_releaseFlag = true;
 	}
 }
@@ -108,3 +124,180 @@ void WSPollingRRInterface::setTransmitTimeout(quint32 transmitTimeout) {
 		m_transmitTimeout = transmitTimeout;
 	}
 }
+
+bool WSPollingRRInterface::adaptiveTimeout() const {
+	QMutexLocker ml(&m_lock);
+	return m_adaptiveTimeout;
+}
+
+void WSPollingRRInterface::setAdaptiveTimeout(bool adaptiveTimeout) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_adaptiveTimeout = adaptiveTimeout;
+	}
+}
+
+quint32 WSPollingRRInterface::adaptiveTimeoutMin() const {
+	QMutexLocker ml(&m_lock);
+	return m_adaptiveTimeoutMin;
+}
+
+void WSPollingRRInterface::setAdaptiveTimeoutMin(quint32 adaptiveTimeoutMin) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_adaptiveTimeoutMin = adaptiveTimeoutMin;
+	}
+}
+
+quint32 WSPollingRRInterface::adaptiveTimeoutMax() const {
+	QMutexLocker ml(&m_lock);
+	return m_adaptiveTimeoutMax;
+}
+
+void WSPollingRRInterface::setAdaptiveTimeoutMax(quint32 adaptiveTimeoutMax) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_adaptiveTimeoutMax = adaptiveTimeoutMax;
+	}
+}
+
+bool WSPollingRRInterface::dataTrace() const {
+	return m_dataTrace;
+}
+
+void WSPollingRRInterface::setDataTrace(bool dataTrace) {
+	m_dataTrace = dataTrace;
+}
+
+QByteArray WSPollingRRInterface::traced(const QByteArray &data) const {
+	return traced(data.constData(), data.size());
+}
+
+QByteArray WSPollingRRInterface::traced(const char *data, qint32 size) const {
+	if (!m_dataTrace) {
+		return QByteArray();
+	}
+	return QByteArray(data, size);
+}
+
+// Learned values are dropped on each start, settings or devices may be changed
+void WSPollingRRInterface::timingReset() {
+	m_rtt.reset();
+	m_rtt.setBounds(m_adaptiveTimeoutMin, m_adaptiveTimeoutMax, m_receiveTimeout);
+	statsReset();
+}
+
+// Time in us
+qint64 WSPollingRRInterface::timingClock() const {
+	return m_rttClock.nsecsElapsed() / 1000;
+}
+
+quint32 WSPollingRRInterface::responseTimeout(quint32 device) const {
+	return m_adaptiveTimeout ? m_rtt.timeout(device) : m_receiveTimeout;
+}
+
+void WSPollingRRInterface::responseReceived(quint32 device, qint64 sent) {
+	qint64 rtt = timingClock() - sent;
+	m_rttHistogram.record(rtt);
+	m_rtt.sample(device, rtt);
+	if (m_rtt.report(device, m_rttClock.elapsed(), Conf::DEVICE_TIMING_REPORT_PERIOD)) {
+		const WSRttState *s = m_rtt.state(device);
+		emit deviceTimingChanged(device, static_cast<quint32>(s->srtt), static_cast<quint32>(s->rttvar), responseTimeout(device));
+	}
+}
+
+void WSPollingRRInterface::responseLost(quint32 device) {
+	if (m_adaptiveTimeout) {
+		m_rtt.backoff(device);
+	}
+}
+
+void WSPollingRRInterface::requestSent() {
+	m_requestDevice = m_protocol->lastDevice();
+	m_requestSent = timingClock();
+	m_requestTimeout = responseTimeout(m_requestDevice);
+}
+
+void WSPollingRRInterface::transmitWindow(WSTransactionWindow &window, quint32 lane, const QElapsedTimer &clock, const std::function<void(const QByteArray &data)> &write) {
+	while (window.ready(clock.elapsed())) {
+		const QByteArray &data = m_protocol->constructLaneRequest(lane);
+		if (data.size() == 0) {
+			if (window.isEmpty()) {
+				emit dataSkipped();
+			}
+			window.pause(clock.elapsed() + m_skipPause);
+			break;
+		}
+		write(data);
+		statsTransmitted(data.size());
+		emit trasmitted(traced(data));
+		quint32 device = m_protocol->lastDevice();
+		quint32 timeout = responseTimeout(device);
+		// Request may be a view of the protocol buffer overwritten by the next request, the kept frame is a deep copy
+		window.insert({m_protocol->lastTransactionId(), clock.elapsed() + timeout, device, timingClock(), timeout, 0, window.keepFrames() ? QByteArray(data.constData(), data.size()) : QByteArray()});
+		window.pause(clock.elapsed() + m_pollingPause);
+	}
+}
+
+void WSPollingRRInterface::transactionAnswered(const WSTransaction &transaction) {
+	// Response time of retransmitted request is ambiguous (Karn's algorithm)
+	if (transaction.retries == 0) {
+		responseReceived(transaction.device, transaction.sent);
+	}
+}
+
+const WSLatencyHistogram &WSPollingRRInterface::rttHistogram() const {
+	return m_rttHistogram;
+}
+
+const WSLatencyHistogram &WSPollingRRInterface::cycleHistogram() const {
+	return m_cycleHistogram;
+}
+
+const WSLatencyHistogram &WSPollingRRInterface::jitterHistogram() const {
+	return m_jitterHistogram;
+}
+
+quint64 WSPollingRRInterface::framesCount() const {
+	return m_framesCount;
+}
+
+quint64 WSPollingRRInterface::bytesCount() const {
+	return m_bytesCount;
+}
+
+void WSPollingRRInterface::statsReset() {
+	m_rttHistogram.reset();
+	m_cycleHistogram.reset();
+	m_jitterHistogram.reset();
+	m_framesCount = 0;
+	m_bytesCount = 0;
+	m_cycleStart = -1;
+	m_lastTransmit = -1;
+	m_lastInterval = -1;
+}
+
+void WSPollingRRInterface::statsTransmitted(qint32 size) {
+	qint64 now = timingClock();
+	m_bytesCount.fetch_add(static_cast<quint64>(size), std::memory_order_relaxed);
+	if (m_lastTransmit >= 0) {
+		qint64 interval = now - m_lastTransmit;
+		if (m_lastInterval >= 0) {
+			m_jitterHistogram.record(qAbs(interval - m_lastInterval));
+		}
+		m_lastInterval = interval;
+	}
+	m_lastTransmit = now;
+	// Cycle is measured from the first request of the previous cycle to the first request of the next one
+	if (m_protocol->cycleCompleted() || m_cycleStart < 0) {
+		if (m_cycleStart >= 0) {
+			m_cycleHistogram.record(now - m_cycleStart);
+		}
+		m_cycleStart = now;
+	}
+}
+
+void WSPollingRRInterface::statsReceived(qint32 size) {
+	m_framesCount.fetch_add(1, std::memory_order_relaxed);
+	m_bytesCount.fetch_add(static_cast<quint64>(size), std::memory_order_relaxed);
+}
@@ -23,9 +23,14 @@
 #ifndef WSPOLLINGRRINTERFACE_H
 #define WSPOLLINGRRINTERFACE_H
 
+#include <atomic>
+#include <functional>
 #include <QtCore>
 #include "wspollinginterface.h"
 #include "protocols/wsabstractrrprotocol.h"
+#include "wsrttestimator.h"
+#include "wslatencyhistogram.h"
+#include "wstransactionwindow.h"
 
 class WSPollingRRInterface : public WSPollingInterface {
 Q_OBJECT
@@ -52,15 +57,41 @@ public:
 	virtual quint32 errorPause() const;
 	virtual void setErrorPause(quint32 errorPause);
 
+	// Response timeout is learned per device within [min, max] (ms), starting from the receive timeout
+	virtual bool adaptiveTimeout() const;
+	virtual void setAdaptiveTimeout(bool adaptiveTimeout);
+
+	virtual quint32 adaptiveTimeoutMin() const;
+	virtual void setAdaptiveTimeoutMin(quint32 adaptiveTimeoutMin);
+
+	virtual quint32 adaptiveTimeoutMax() const;
+	virtual void setAdaptiveTimeoutMax(quint32 adaptiveTimeoutMax);
+
+	// Received data signals carry a copy of the data (log, capture), otherwise they are emitted with empty data.
+	// May be changed while polling.
+	bool dataTrace() const;
+	void setDataTrace(bool dataTrace);
+
+	// Polling statistics since the start, read without stopping the interface (times in us)
+	const WSLatencyHistogram &rttHistogram() const;
+	const WSLatencyHistogram &cycleHistogram() const;
+	const WSLatencyHistogram &jitterHistogram() const;
+	// Valid responses and transmitted + received bytes
+	quint64 framesCount() const;
+	quint64 bytesCount() const;
+
 signals:
 	void transmitTimeoutOccurred(quint32 timeout);
 	void receiveTimeoutOccurred(quint32 timeout);
+	void transactionTimeoutOccurred(quint32 transactionId, quint32 timeout);
 	void trasmitted(QByteArray transmittedData);
 	void received(QByteArray receivedData);
 	void dataSkipped();
 	void validDataReceived(QByteArray validData);
 	void incompleteDataReceived(QByteArray incompleteData);
 	void errorDataReceived(QByteArray errorData);
+	// Smoothed round-trip time and variation in us, response timeout in ms
+	void deviceTimingChanged(quint32 device, quint32 srtt, quint32 rttvar, quint32 timeout);
 
 protected:
 	std::unique_ptr<WSAbstractRRProtocol> m_protocol;
@@ -70,9 +101,48 @@ protected:
 	quint32 m_skipPause;
 	quint32 m_errorPause;
 	bool m_releaseFlag;
+	bool m_adaptiveTimeout;
+	quint32 m_adaptiveTimeoutMin;
+	quint32 m_adaptiveTimeoutMax;
+	std::atomic<bool> m_dataTrace;
+	WSRttEstimator m_rtt;
+	QElapsedTimer m_rttClock;
+	// Last request of the single request-response exchange
+	quint32 m_requestDevice;
+	qint64 m_requestSent;
+	quint32 m_requestTimeout;
+	// Round-trip time of transactions
+	WSLatencyHistogram m_rttHistogram;
+	// Polling cycle duration (until a request is repeated, see WSAbstractRRProtocol::cycleCompleted)
+	WSLatencyHistogram m_cycleHistogram;
+	// Difference of the consecutive intervals between requests
+	WSLatencyHistogram m_jitterHistogram;
+	std::atomic<quint64> m_framesCount;
+	std::atomic<quint64> m_bytesCount;
+	qint64 m_cycleStart;
+	qint64 m_lastTransmit;
+	qint64 m_lastInterval;
 
 	virtual void connectSlotSignals();
 	virtual void disconnectSlotSignals();
+
+	// Copy of the transmitted or received data for signals (never a view of a protocol or receive buffer), empty if the data trace is disabled
+	QByteArray traced(const QByteArray &data) const;
+	QByteArray traced(const char *data, qint32 size) const;
+
+	void timingReset();
+	qint64 timingClock() const;
+	quint32 responseTimeout(quint32 device) const;
+	void responseReceived(quint32 device, qint64 sent);
+	void responseLost(quint32 device);
+	void requestSent();
+	// Fills the window of pipelined requests of the lane, the request is written by the transport
+	void transmitWindow(WSTransactionWindow &window, quint32 lane, const QElapsedTimer &clock, const std::function<void(const QByteArray &data)> &write);
+	void transactionAnswered(const WSTransaction &transaction);
+	void statsReset();
+	// Called after each transmitted request and each valid response
+	void statsTransmitted(qint32 size);
+	void statsReceived(qint32 size);
 };
 
 #endif // WSPOLLINGRRINTERFACE_H
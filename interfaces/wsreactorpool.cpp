@@ -0,0 +1,69 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#include "wsreactorpool.h"
+
+WSReactorPool::WSReactorPool(quint32 size, QObject *parent) :
+	QObject(parent)
+{
+	if (size == 0) {
+		size = static_cast<quint32>(qMax(1, QThread::idealThreadCount()));
+	}
+	for (quint32 i = 0; i < size; i++) {
+		m_threads.emplace_back(new QThread());
+		m_load.push_back(0);
+	}
+}
+
+WSReactorPool::~WSReactorPool() {
+	for (auto const& t: m_threads) {
+		t->quit();
+		t->wait();
+	}
+}
+
+QThread *WSReactorPool::acquire() {
+	size_t best = 0;
+	for (size_t i = 1; i < m_threads.size(); i++) {
+		if (m_load[i] < m_load[best]) {
+			best = i;
+		}
+	}
+	if (!m_threads[best]->isRunning()) {
+		m_threads[best]->start();
+	}
+	m_load[best]++;
+	return m_threads[best].get();
+}
+
+void WSReactorPool::release(QThread *thread) {
+	for (size_t i = 0; i < m_threads.size(); i++) {
+		if (m_threads[i].get() == thread && m_load[i] > 0) {
+			m_load[i]--;
+			break;
+		}
+	}
+}
+
+quint32 WSReactorPool::size() const {
+	return static_cast<quint32>(m_threads.size());
+}
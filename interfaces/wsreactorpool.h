@@ -0,0 +1,51 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSREACTORPOOL_H
+#define WSREACTORPOOL_H
+
+#include <memory>
+#include <vector>
+#include <QObject>
+#include <QtCore>
+#include "conf.h"
+
+// Fixed pool of threads running event loops, event-driven interfaces are multiplexed on them
+// (the Qt event dispatcher waits for readiness of all sockets, serial ports and timers of the thread)
+class WSReactorPool : public QObject {
+Q_OBJECT
+
+public:
+	explicit WSReactorPool(quint32 size = 0, QObject *parent = nullptr);
+	virtual ~WSReactorPool();
+
+	// Least loaded thread, started on demand
+	QThread *acquire();
+	void release(QThread *thread);
+	quint32 size() const;
+
+private:
+	std::vector<std::unique_ptr<QThread> > m_threads;
+	std::vector<quint32> m_load;
+};
+
+#endif // WSREACTORPOOL_H
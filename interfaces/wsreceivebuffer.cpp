@@ -0,0 +1,116 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#include "wsreceivebuffer.h"
+
+WSReceiveBuffer::WSReceiveBuffer() :
+	m_capacity(0),
+	m_begin(0),
+	m_end(0)
+{}
+
+void WSReceiveBuffer::reserve(qint32 capacity) {
+	if (capacity != m_capacity) {
+		m_buffer.reset(new char[static_cast<size_t>(capacity)]);
+		m_capacity = capacity;
+	}
+	clear();
+}
+
+qint32 WSReceiveBuffer::capacity() const {
+	return m_capacity;
+}
+
+void WSReceiveBuffer::clear() {
+	m_begin = 0;
+	m_end = 0;
+}
+
+qint64 WSReceiveBuffer::readFrom(QIODevice *device) {
+	if (m_end == m_capacity || m_capacity - m_end < device->bytesAvailable()) {
+		compact();
+	}
+	if (m_end == m_capacity) {
+		return 0;
+	}
+	qint64 length = device->read(m_buffer.get() + m_end, m_capacity - m_end);
+	if (length <= 0) {
+		return 0;
+	}
+	m_end += static_cast<qint32>(length);
+	return length;
+}
+
+char *WSReceiveBuffer::tail() {
+	compact();
+	return m_buffer.get() + m_end;
+}
+
+qint32 WSReceiveBuffer::available() const {
+	return m_capacity - m_end;
+}
+
+void WSReceiveBuffer::commit(qint32 length) {
+	m_end = qMin(m_end + length, m_capacity);
+}
+
+void WSReceiveBuffer::consume(qint32 length) {
+	m_begin = qMin(m_begin + length, m_end);
+	// Empty buffer starts from the beginning without moving
+	if (m_begin == m_end) {
+		clear();
+	}
+}
+
+qint32 WSReceiveBuffer::size() const {
+	return m_end - m_begin;
+}
+
+bool WSReceiveBuffer::isEmpty() const {
+	return m_end == m_begin;
+}
+
+bool WSReceiveBuffer::isFull() const {
+	return m_begin == 0 && m_end == m_capacity;
+}
+
+const QByteArray &WSReceiveBuffer::view() {
+	return view(size());
+}
+
+// Header of the not shared raw data array is reused by setRawData
+const QByteArray &WSReceiveBuffer::view(qint32 length) {
+	m_view.setRawData(m_buffer.get() + m_begin, static_cast<uint>(qBound(0, length, size())));
+	return m_view;
+}
+
+const char *WSReceiveBuffer::constData() const {
+	return m_buffer.get() + m_begin;
+}
+
+void WSReceiveBuffer::compact() {
+	if (m_begin > 0) {
+		memmove(m_buffer.get(), m_buffer.get() + m_begin, static_cast<size_t>(m_end - m_begin));
+		m_end -= m_begin;
+		m_begin = 0;
+	}
+}
@@ -0,0 +1,69 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSRECEIVEBUFFER_H
+#define WSRECEIVEBUFFER_H
+
+#include <memory>
+#include <QtCore>
+
+// Fixed-capacity receive buffer of the interface. Data is read from the device directly into the free space,
+// complete packages are consumed from the front and the rest is moved to the beginning only when the tail is short.
+// Views are raw data wrappers reusing one header, so the steady-state receive path does not allocate.
+class WSReceiveBuffer {
+
+public:
+	WSReceiveBuffer();
+
+	// Memory is allocated only if the capacity is changed
+	void reserve(qint32 capacity);
+	qint32 capacity() const;
+	void clear();
+
+	// Reads up to the free space, returns number of read bytes
+	qint64 readFrom(QIODevice *device);
+	// Free space written by the caller (e.g. QUdpSocket::readDatagram), commit adds the written bytes
+	char *tail();
+	qint32 available() const;
+	void commit(qint32 length);
+	void consume(qint32 length);
+
+	qint32 size() const;
+	bool isEmpty() const;
+	bool isFull() const;
+
+	// Unconsumed data (or its first length bytes), valid until the buffer is changed, must not be stored or emitted
+	const QByteArray &view();
+	const QByteArray &view(qint32 length);
+	const char *constData() const;
+
+private:
+	std::unique_ptr<char[]> m_buffer;
+	qint32 m_capacity;
+	qint32 m_begin;
+	qint32 m_end;
+	QByteArray m_view;
+
+	void compact();
+};
+
+#endif // WSRECEIVEBUFFER_H
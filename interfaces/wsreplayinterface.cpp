@@ -0,0 +1,242 @@
+#include "wsreplayinterface.h"
+
+WSReplayInterface::WSReplayInterface(const QString &fileName, WSAbstractRRProtocol *protocol, QThread *mainThread, QObject *parent) :
+	WSPollingRRInterface(protocol, mainThread, parent),
+	m_fileName(fileName),
+	m_speed(1),
+	m_state(WSReplayState::NONE),
+	m_mbap(false),
+	m_chunk(0),
+	m_sentAt(0),
+	m_chunkTimer(this),
+	m_timeoutTimer(this),
+	m_pauseTimer(this)
+{
+	m_chunkTimer.setSingleShot(true);
+	m_chunkTimer.setTimerType(Qt::PreciseTimer);
+	m_timeoutTimer.setSingleShot(true);
+	m_timeoutTimer.setTimerType(Qt::PreciseTimer);
+	m_pauseTimer.setSingleShot(true);
+	m_pauseTimer.setTimerType(Qt::PreciseTimer);
+	connect(&m_chunkTimer, &QTimer::timeout, this, &WSReplayInterface::onChunk);
+	connect(&m_timeoutTimer, &QTimer::timeout, this, &WSReplayInterface::onTimeout);
+	connect(&m_pauseTimer, &QTimer::timeout, this, &WSReplayInterface::onPause);
+}
+
+WSInterface WSReplayInterface::type() const {
+	return WSInterface::REPLAY;
+}
+
+QString WSReplayInterface::fileName() const {
+	QMutexLocker ml(&m_lock);
+	return m_fileName;
+}
+
+void WSReplayInterface::setFileName(const QString &fileName) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_fileName = fileName;
+	}
+}
+
+double WSReplayInterface::speed() const {
+	QMutexLocker ml(&m_lock);
+	return m_speed;
+}
+
+void WSReplayInterface::setSpeed(double speed) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_speed = qMax(0.0, speed);
+	}
+}
+
+void WSReplayInterface::workerLoop() {
+	m_clock.start();
+	timingReset();
+	m_mbap = m_protocol->pipelineSupported();
+	if (!load()) {
+		emit connectionErrorOccurred();
+		finish();
+		return;
+	}
+	m_protocol->transactionsReset();
+	m_state = WSReplayState::TRANSMIT;
+	emit connected();
+	transmit();
+}
+
+bool WSReplayInterface::eventDriven() const {
+	return true;
+}
+
+void WSReplayInterface::stop() {
+	WSPollingInterface::stop();
+	// Interface lives in the polling thread
+	QMetaObject::invokeMethod(this, [this]() {shutdown();}, Qt::QueuedConnection);
+}
+
+// Responses are paired with requests by transaction id (MBAP) or by the order
+bool WSReplayInterface::load() {
+	struct Exchange {
+		QByteArray key;
+		qint32 index;
+		qint64 time;
+	};
+	QVector<WSTrafficRecord> records;
+	if (!WSTrafficCapture::load(m_fileName, records)) {
+		return false;
+	}
+	m_exchanges.clear();
+	m_cursors.clear();
+	QHash<quint32, Exchange> outstanding;
+	Exchange last = {QByteArray(), -1, 0};
+	QByteArray stream;
+	qint32 len;
+	quint32 transactionId;
+	for (const WSTrafficRecord &r: records) {
+		if (!r.received) {
+			QVector<QVector<WSReplayChunk> > &responses = m_exchanges[requestKey(r.data)];
+			responses.append(QVector<WSReplayChunk>());
+			last = {requestKey(r.data), responses.size() - 1, r.time};
+			if (m_mbap && m_protocol->frameLength(r.data, &transactionId) > 0) {
+				outstanding.insert(transactionId, last);
+			}
+		} else if (!m_mbap) {
+			if (last.index >= 0) {
+				m_exchanges[last.key][last.index].append({r.time - last.time, r.data});
+			}
+		} else {
+			stream.append(r.data);
+			while ((len = m_protocol->frameLength(stream, &transactionId)) > 0) {
+				auto it = outstanding.find(transactionId);
+				if (it != outstanding.end()) {
+					m_exchanges[it.value().key][it.value().index].append({r.time - it.value().time, stream.left(len)});
+					outstanding.erase(it);
+				}
+				stream.remove(0, len);
+			}
+			// Stream is out of sync
+			if (len < 0) {
+				stream.clear();
+			}
+		}
+	}
+	return true;
+}
+
+QByteArray WSReplayInterface::requestKey(const QByteArray &request) const {
+	return m_mbap ? request.mid(2) : request;
+}
+
+// Captured time in us to the replay delay in ms
+qint32 WSReplayInterface::scaled(qint64 us) const {
+	if (m_speed <= 0) {
+		return 0;
+	}
+	return static_cast<qint32>(qBound(0.0, us / (m_speed * 1000.0), 2147483647.0));
+}
+
+void WSReplayInterface::shutdown() {
+	if (m_state == WSReplayState::NONE) {
+		return;
+	}
+	m_state = WSReplayState::NONE;
+	m_chunkTimer.stop();
+	m_timeoutTimer.stop();
+	m_pauseTimer.stop();
+	m_protocol->transactionsReset();
+	emit disconnected();
+	finish();
+}
+
+void WSReplayInterface::transmit() {
+	if (getStopFlag()) {
+		shutdown();
+		return;
+	}
+	const QByteArray &data = m_protocol->constructRequest();
+	if (data.size() == 0) {
+		emit dataSkipped();
+		pause(m_skipPause);
+		return;
+	}
+	m_request = data;
+	m_recvBuffer.clear();
+	m_state = WSReplayState::RECEIVE;
+	requestSent();
+	statsTransmitted(data.size());
+	emit trasmitted(traced(data));
+	QByteArray key = requestKey(data);
+	auto it = m_exchanges.find(key);
+	m_response.clear();
+	if (it != m_exchanges.end()) {
+		qint32 cursor = m_cursors.value(key, 0);
+		m_response = it.value().at(cursor);
+		m_cursors.insert(key, (cursor + 1) % it.value().size());
+	}
+	m_chunk = 0;
+	m_sentAt = m_clock.nsecsElapsed() / 1000;
+	scheduleChunk();
+}
+
+// Not captured, not responded or incomplete response ends by the timeout
+void WSReplayInterface::scheduleChunk() {
+	if (m_chunk < m_response.size()) {
+		qint64 elapsed = m_clock.nsecsElapsed() / 1000 - m_sentAt;
+		m_chunkTimer.start(qMax(0, scaled(m_response.at(m_chunk).offset) - static_cast<qint32>(elapsed / 1000)));
+	} else {
+		m_timeoutTimer.start(scaled(static_cast<qint64>(m_requestTimeout) * 1000));
+	}
+}
+
+void WSReplayInterface::pause(quint32 ms) {
+	m_pauseTimer.start(scaled(static_cast<qint64>(ms) * 1000));
+}
+
+void WSReplayInterface::onChunk() {
+	if (m_state != WSReplayState::RECEIVE) {
+		return;
+	}
+	QByteArray data = m_response.at(m_chunk++).data;
+	// Captured transaction id is replaced by the current one
+	if (m_mbap && data.size() >= 2 && m_request.size() >= 2) {
+		data.replace(0, 2, m_request.left(2));
+	}
+	m_recvBuffer.append(data);
+	emit received(data);
+	WSProtocolParseCode code = m_protocol->processResponse(m_recvBuffer);
+	if (code == WSProtocolParseCode::INCOMPLETE) {
+		emit incompleteDataReceived(m_recvBuffer);
+		scheduleChunk();
+		return;
+	}
+	m_state = WSReplayState::TRANSMIT;
+	if (code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) {
+		if (code == WSProtocolParseCode::VALID) {
+			responseReceived(m_requestDevice, m_requestSent);
+		}
+		statsReceived(m_recvBuffer.size());
+		emit validDataReceived(m_recvBuffer);
+		pause(m_pollingPause);
+	} else {
+		emit errorDataReceived(m_recvBuffer);
+		pause(qMax(m_pollingPause, m_errorPause));
+	}
+}
+
+void WSReplayInterface::onTimeout() {
+	if (m_state != WSReplayState::RECEIVE) {
+		return;
+	}
+	responseLost(m_requestDevice);
+	emit receiveTimeoutOccurred(m_requestTimeout);
+	m_state = WSReplayState::TRANSMIT;
+	pause(qMax(m_pollingPause, m_errorPause));
+}
+
+void WSReplayInterface::onPause() {
+	if (m_state == WSReplayState::TRANSMIT) {
+		transmit();
+	}
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSREPLAYINTERFACE_H
+#define WSREPLAYINTERFACE_H
+
+#include <QObject>
+#include <QtCore>
+#include "protocols/wsabstractrrprotocol.h"
+#include "utils/wstrafficcapture.h"
+#include "wspollingrrinterface.h"
+
+// Piece of the captured response, offset from the request in us
+struct WSReplayChunk {
+	qint64 offset;
+	QByteArray data;
+};
+
+enum class WSReplayState : quint8 {
+	NONE = 0,
+	TRANSMIT = 1,
+	RECEIVE = 2
+};
+
+// Event-driven stand-in for socket and serial transports: requests are answered from a traffic capture
+// with the captured timing scaled by the speed, nothing is sent to devices
+class WSReplayInterface : public WSPollingRRInterface {
+Q_OBJECT
+
+public:
+	WSReplayInterface(const QString &fileName, WSAbstractRRProtocol *protocolGet, QThread *mainThread, QObject *parent = nullptr);
+
+	WSInterface type() const override;
+	void workerLoop() override;
+	bool eventDriven() const override;
+	void stop() override;
+
+	QString fileName() const;
+	void setFileName(const QString &fileName);
+
+	// 1 - real time, above 1 - accelerated, 0 - maximum speed (no delays and pauses)
+	double speed() const;
+	void setSpeed(double speed);
+
+private:
+	QString m_fileName;
+	double m_speed;
+	WSReplayState m_state;
+	// Transaction id (MBAP) is not the part of the request key, it is patched in responses
+	bool m_mbap;
+	// Captured responses by request, replayed cyclically in the capture order
+	QHash<QByteArray, QVector<QVector<WSReplayChunk> > > m_exchanges;
+	QHash<QByteArray, qint32> m_cursors;
+	QVector<WSReplayChunk> m_response;
+	qint32 m_chunk;
+	QByteArray m_request;
+	QByteArray m_recvBuffer;
+	qint64 m_sentAt;
+	QElapsedTimer m_clock;
+	// Next chunk of the response
+	QTimer m_chunkTimer;
+	// Response timeout
+	QTimer m_timeoutTimer;
+	// Polling, skip and error pauses
+	QTimer m_pauseTimer;
+
+	bool load();
+	QByteArray requestKey(const QByteArray &request) const;
+	qint32 scaled(qint64 us) const;
+	void shutdown();
+	void transmit();
+	void scheduleChunk();
+	void pause(quint32 ms);
+
+	void onChunk();
+	void onTimeout();
+	void onPause();
+};
+
+#endif // WSREPLAYINTERFACE_H
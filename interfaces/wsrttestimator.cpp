@@ -0,0 +1,99 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#include "wsrttestimator.h"
+
+WSRttEstimator::WSRttEstimator() :
+	m_minTimeout(0),
+	m_maxTimeout(1000000),
+	m_initialTimeout(1000000)
+{}
+
+void WSRttEstimator::setBounds(quint32 minTimeout, quint32 maxTimeout, quint32 initialTimeout) {
+	m_minTimeout = static_cast<qint64>(qMin(minTimeout, maxTimeout)) * 1000;
+	m_maxTimeout = static_cast<qint64>(maxTimeout) * 1000;
+	m_initialTimeout = bounded(static_cast<qint64>(initialTimeout) * 1000);
+	for (auto it = m_devices.begin(); it != m_devices.end(); ++it) {
+		it.value().timeout = bounded(it.value().timeout);
+	}
+}
+
+void WSRttEstimator::reset() {
+	m_devices.clear();
+}
+
+quint32 WSRttEstimator::timeout(quint32 device) const {
+	auto it = m_devices.find(device);
+	qint64 t = (it == m_devices.end()) ? m_initialTimeout : it.value().timeout;
+	return static_cast<quint32>((t + 999) / 1000);
+}
+
+void WSRttEstimator::sample(quint32 device, qint64 rtt) {
+	WSRttState &s = this->device(device);
+	if (rtt < 0) {
+		rtt = 0;
+	}
+	if (s.samples == 0) {
+		s.srtt = rtt;
+		s.rttvar = rtt / 2;
+	} else {
+		// RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+		s.rttvar = (3 * s.rttvar + qAbs(s.srtt - rtt)) / 4;
+		s.srtt = (7 * s.srtt + rtt) / 8;
+	}
+	s.samples++;
+	// Timeout = SRTT + max(G, 4 * RTTVAR), clock granularity G is 1 ms
+	s.timeout = bounded(s.srtt + qMax(static_cast<qint64>(1000), 4 * s.rttvar));
+}
+
+void WSRttEstimator::backoff(quint32 device) {
+	WSRttState &s = this->device(device);
+	s.timeout = bounded(s.timeout * 2);
+	// Report the change at once
+	s.reported = -1;
+}
+
+const WSRttState *WSRttEstimator::state(quint32 device) const {
+	auto it = m_devices.find(device);
+	return (it == m_devices.end()) ? nullptr : &it.value();
+}
+
+bool WSRttEstimator::report(quint32 device, qint64 now, quint32 period) {
+	auto it = m_devices.find(device);
+	if (it == m_devices.end() || (it.value().reported >= 0 && now - it.value().reported < period)) {
+		return false;
+	}
+	it.value().reported = now;
+	return true;
+}
+
+WSRttState &WSRttEstimator::device(quint32 device) {
+	auto it = m_devices.find(device);
+	if (it == m_devices.end()) {
+		it = m_devices.insert(device, {0, 0, m_initialTimeout, 0, -1});
+	}
+	return it.value();
+}
+
+qint64 WSRttEstimator::bounded(qint64 timeout) const {
+	return qBound(m_minTimeout, timeout, m_maxTimeout);
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSRTTESTIMATOR_H
+#define WSRTTESTIMATOR_H
+
+#include <QtCore>
+
+/**
+ * @brief Round-trip time statistics of one device (times in us)
+ */
+struct WSRttState {
+	qint64 srtt;						// Smoothed round-trip time
+	qint64 rttvar;						// Round-trip time variation
+	qint64 timeout;						// Learned response timeout
+	quint32 samples;					// Measured responses
+	qint64 reported;					// Last report time (ms), -1 - not reported
+};
+
+/**
+ * @brief Per-device response timeout estimation from measured round-trip times
+ * (smoothed RTT and variation as in TCP retransmission timer, RFC 6298).
+ * Timeout is kept within the bounds, the initial timeout is used until the first response.
+ */
+class WSRttEstimator {
+
+public:
+	WSRttEstimator();
+
+	// Bounds and timeout until the first response of the device in ms
+	void setBounds(quint32 minTimeout, quint32 maxTimeout, quint32 initialTimeout);
+	void reset();
+
+	// Response timeout in ms
+	quint32 timeout(quint32 device) const;
+	// Measured response in us
+	void sample(quint32 device, qint64 rtt);
+	// No response, the timeout is doubled
+	void backoff(quint32 device);
+
+	const WSRttState *state(quint32 device) const;
+	// State is due for report (once per period, ms)
+	bool report(quint32 device, qint64 now, quint32 period);
+
+private:
+	QHash<quint32, WSRttState> m_devices;
+	qint64 m_minTimeout;
+	qint64 m_maxTimeout;
+	qint64 m_initialTimeout;
+
+	WSRttState &device(quint32 device);
+	qint64 bounded(qint64 timeout) const;
+};
+
+#endif // WSRTTESTIMATOR_H
@@ -2,13 +2,33 @@
 
 WSSerialInterface::WSSerialInterface(const QString &portName, WSAbstractRRProtocol *protocol, QThread *mainThread, QObject *parent) :
 	WSPollingRRInterface(protocol, mainThread, parent),
-	m_serial(portName, this)
+	m_serial(portName, this),
+	m_state(WSSerialState::NONE),
+	m_listenOnly(false),
+	m_timeoutTimer(this),
+	m_frameTimer(this),
+	m_silence(0),
+	m_frameSilence(0),
+	m_pauseTimer(this),
+	m_monitorPending(false)
 {
 	m_serial.setFlowControl(QSerialPort::NoFlowControl);
 	m_serial.setBaudRate(QSerialPort::Baud9600);
 	m_serial.setDataBits(QSerialPort::Data8);
 	m_serial.setParity(QSerialPort::NoParity);
 	m_serial.setStopBits(QSerialPort::OneStop);
+	m_timeoutTimer.setSingleShot(true);
+	m_timeoutTimer.setTimerType(Qt::PreciseTimer);
+	m_frameTimer.setSingleShot(true);
+	m_frameTimer.setTimerType(Qt::PreciseTimer);
+	m_pauseTimer.setSingleShot(true);
+	m_pauseTimer.setTimerType(Qt::PreciseTimer);
+	connect(&m_serial, &QSerialPort::readyRead, this, &WSSerialInterface::onReadyRead);
+	connect(&m_serial, &QSerialPort::bytesWritten, this, &WSSerialInterface::onBytesWritten);
+	connect(&m_serial, &QSerialPort::errorOccurred, this, &WSSerialInterface::onError);
+	connect(&m_timeoutTimer, &QTimer::timeout, this, &WSSerialInterface::onTimeout);
+	connect(&m_frameTimer, &QTimer::timeout, this, &WSSerialInterface::onFrameSilence);
+	connect(&m_pauseTimer, &QTimer::timeout, this, &WSSerialInterface::onPause);
 }
 
 WSInterface WSSerialInterface::type() const {
@@ -75,6 +95,35 @@ void WSSerialInterface::setStopBits(const QSerialPort::StopBits &stopBits) {
 	}
 }
 
+bool WSSerialInterface::listenOnly() const {
+	QMutexLocker ml(&m_lock);
+	return m_listenOnly;
+}
+
+void WSSerialInterface::setListenOnly(bool listenOnly) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_listenOnly = listenOnly;
+	}
+}
+
+// Bus silence between frames (t3.5) in us, fixed 1750 us above 19200 baud
+quint32 WSSerialInterface::interFrameTimeout() const {
+	QMutexLocker ml(&m_lock);
+	qint32 baud = m_serial.baudRate();
+	if (baud <= 0 || baud > 19200) {
+		return 1750;
+	}
+	// Start, data, parity and stop bits of one character
+	qint32 bits = 1 + dataBitsToNumber(m_serial.dataBits()) + ((m_serial.parity() == QSerialPort::NoParity) ? 0 : 1) + ((m_serial.stopBits() == QSerialPort::OneStop) ? 1 : 2);
+	return static_cast<quint32>((static_cast<qint64>(bits) * 3500000 + baud - 1) / baud);
+}
+
+// Bus silence between frames (t3.5) in ms
+quint32 WSSerialInterface::silenceInterval() const {
+	return (interFrameTimeout() + 999) / 1000;
+}
+
 QSerialPort::DataBits WSSerialInterface::dataBitsFromNumber(int dataBits) {
 	if (dataBits == 5) {
 		return QSerialPort::Data5;
@@ -155,68 +204,199 @@ QString WSSerialInterface::stopBitsToString(const QSerialPort::StopBits &stopBit
 }
 
 void WSSerialInterface::workerLoop() {
-	if (m_serial.open(QIODevice::ReadWrite)) {
-		emit connected();
+	if (m_listenOnly && !m_protocol->monitorSupported()) {
+		emit connectionErrorOccurred();
+		finish();
+		return;
+	}
+	// Listen-only mode, nothing is transmitted
+	if (!m_serial.open(m_listenOnly ? QIODevice::ReadOnly : QIODevice::ReadWrite)) {
+		emit connectionErrorOccurred();
+		finish();
+		return;
+	}
+	emit connected();
+	m_recvBuffer.reserve(static_cast<qint32>(m_protocol->bufferSize() * Conf::DEVICE_RECEIVE_BUFFER_PACKAGES));
+	m_silence = silenceInterval();
+	m_frameSilence = m_silence + Conf::DEVICE_SERIAL_SILENCE_GUARD;
+	timingReset();
+	if (m_listenOnly) {
+		m_protocol->resetToDefault();
+		m_monitorPending = false;
+		m_state = WSSerialState::MONITOR;
+	} else {
+		m_protocol->transactionsReset();
 		m_state = WSSerialState::TRANSMIT;
-		while (true) {
-			QCoreApplication::processEvents();
-			if (getStopFlag()) {
-				m_serial.close();
-				break;
-			}
-			if (m_state == WSSerialState::TRANSMIT) {
-				QByteArray data = m_protocol->constructRequest();
-				if (data.size() > 0) {
-					m_serial.write(data);
-					if (m_serial.waitForBytesWritten(static_cast<int>(m_transmitTimeout))) {
-						emit trasmitted(data);
-						m_recvBuffer.clear();
-						m_state = WSSerialState::RECEIVE;
-					} else {
-						emit transmitTimeoutOccurred(m_transmitTimeout);
-						QThread::msleep(m_skipPause);
-						continue;
-					}
-				} else {
-					emit dataSkipped();
-					QThread::msleep(m_skipPause);
-					continue;
-				}
-			} else if (m_state == WSSerialState::RECEIVE) {
-				if (m_serial.bytesAvailable() > 0 || m_serial.waitForReadyRead(static_cast<int>(m_receiveTimeout))) {
-					QByteArray readData = m_serial.readAll();
-					m_recvBuffer.append(readData);
-					emit received(readData);
-					WSProtocolParseCode code = m_protocol->processResponse(m_recvBuffer);
-					if (code == WSProtocolParseCode::INCOMPLETE) {
-						emit incompleteDataReceived(m_recvBuffer);
-						QThread::msleep(m_skipPause);
-						continue;
-					} else if (code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) {
-						emit validDataReceived(m_recvBuffer);
-						m_state = WSSerialState::TRANSMIT;
-						QThread::msleep(m_pollingPause);
-						continue;
-					} else {
-						emit errorDataReceived(m_recvBuffer);
-						QThread::msleep((m_pollingPause > m_errorPause) ? m_pollingPause : m_errorPause);
-						m_serial.clear();
-						m_recvBuffer.clear();
-						m_state = WSSerialState::TRANSMIT;
-						continue;
-					}
-				} else {
-					emit receiveTimeoutOccurred(m_receiveTimeout);
-					QThread::msleep(m_skipPause);
-					m_serial.clear();
-					m_recvBuffer.clear();
-					m_state = WSSerialState::TRANSMIT;
-					continue;
-				}
+		transmit();
+	}
+}
+
+bool WSSerialInterface::eventDriven() const {
+	return true;
+}
+
+void WSSerialInterface::stop() {
+	WSPollingInterface::stop();
+	// Interface lives in the polling thread
+	QMetaObject::invokeMethod(this, [this]() {shutdown();}, Qt::QueuedConnection);
+}
+
+void WSSerialInterface::shutdown() {
+	if (m_state == WSSerialState::NONE) {
+		return;
+	}
+	m_timeoutTimer.stop();
+	m_frameTimer.stop();
+	m_pauseTimer.stop();
+	m_serial.close();
+	m_state = WSSerialState::NONE;
+	emit disconnected();
+	finish();
+}
+
+void WSSerialInterface::transmit() {
+	if (getStopFlag()) {
+		shutdown();
+		return;
+	}
+	const QByteArray &data = m_protocol->constructRequest();
+	if (data.size() == 0) {
+		emit dataSkipped();
+		m_pauseTimer.start(static_cast<int>(m_skipPause));
+		return;
+	}
+	m_recvBuffer.clear();
+	m_state = WSSerialState::RECEIVE;
+	m_serial.write(data);
+	requestSent();
+	statsTransmitted(data.size());
+	emit trasmitted(traced(data));
+	// Response timeout is restarted when the request is written
+	m_timeoutTimer.start(static_cast<int>((m_serial.bytesToWrite() > 0) ? m_transmitTimeout : m_requestTimeout));
+}
+
+// Data is read directly into the receive buffer, nothing is allocated per read
+void WSSerialInterface::onReadyRead() {
+	while (m_serial.bytesAvailable() > 0) {
+		qint32 length = static_cast<qint32>(m_recvBuffer.readFrom(&m_serial));
+		if (length == 0) {
+			// Buffer is full, data longer than any package is dropped
+			if (m_state == WSSerialState::RECEIVE) {
+				m_timeoutTimer.stop();
+				m_frameTimer.stop();
+				m_state = WSSerialState::TRANSMIT;
+				receiveError();
+			} else {
+				m_serial.clear();
+				m_recvBuffer.clear();
 			}
+			return;
+		}
+		if (m_state == WSSerialState::RECEIVE) {
+			receive(length);
+		} else if (m_state == WSSerialState::MONITOR) {
+			monitor();
+		} else {
+			// Data without request
+			m_recvBuffer.clear();
+		}
+	}
+}
+
+// Incomplete package is recognized by its header, CRC is calculated once for the complete package
+void WSSerialInterface::receive(qint32 length) {
+	emit received(traced(m_recvBuffer.constData() + m_recvBuffer.size() - length, length));
+	WSProtocolParseCode code = m_protocol->processResponse(m_recvBuffer.view());
+	if (code == WSProtocolParseCode::INCOMPLETE) {
+		// Wait for the rest of the package until the bus is silent
+		emit incompleteDataReceived(traced(m_recvBuffer.view()));
+		m_frameTimer.start(static_cast<int>(m_frameSilence));
+		return;
+	}
+	m_timeoutTimer.stop();
+	m_frameTimer.stop();
+	m_state = WSSerialState::TRANSMIT;
+	if (code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) {
+		if (code == WSProtocolParseCode::VALID) {
+			responseReceived(m_requestDevice, m_requestSent);
 		}
-		emit disconnected();
+		statsReceived(m_recvBuffer.size());
+		emit validDataReceived(traced(m_recvBuffer.view()));
+		// Next request is sent not earlier than t3.5 after the response
+		m_pauseTimer.start(static_cast<int>(qMax(m_pollingPause, m_silence)));
 	} else {
-		emit connectionErrorOccurred();
+		receiveError();
+	}
+}
+
+void WSSerialInterface::receiveError() {
+	emit errorDataReceived(traced(m_recvBuffer.view()));
+	m_serial.clear();
+	m_recvBuffer.clear();
+	m_pauseTimer.start(static_cast<int>(qMax(qMax(m_pollingPause, m_errorPause), m_silence)));
+}
+
+// Frame boundaries are found by CRC, the silence only drops incomplete data (serial drivers may delay bytes)
+void WSSerialInterface::monitor() {
+	const QByteArray &data = m_recvBuffer.view();
+	emit received(traced(data));
+	WSProtocolParseCode code = m_protocol->processMonitored(data, false);
+	if (code == WSProtocolParseCode::VALID) {
+		emit validDataReceived(traced(data));
+	} else if (code == WSProtocolParseCode::INCORRECT) {
+		emit errorDataReceived(traced(data));
+	}
+	// Decoder keeps the frame state, read data is not accumulated
+	m_recvBuffer.clear();
+	m_monitorPending = true;
+	m_frameTimer.start(static_cast<int>(m_frameSilence));
+}
+
+void WSSerialInterface::onBytesWritten() {
+	if (m_state == WSSerialState::RECEIVE && m_serial.bytesToWrite() == 0) {
+		m_timeoutTimer.start(static_cast<int>(m_requestTimeout));
+	}
+}
+
+void WSSerialInterface::onError(QSerialPort::SerialPortError error) {
+	// Device is removed
+	if (error == QSerialPort::ResourceError && m_state != WSSerialState::NONE) {
+		shutdown();
+	}
+}
+
+void WSSerialInterface::onTimeout() {
+	if (m_state == WSSerialState::RECEIVE) {
+		if (m_serial.bytesToWrite() > 0) {
+			emit transmitTimeoutOccurred(m_transmitTimeout);
+		} else {
+			responseLost(m_requestDevice);
+			emit receiveTimeoutOccurred(m_requestTimeout);
+		}
+		m_frameTimer.stop();
+		m_serial.clear();
+		m_recvBuffer.clear();
+		m_state = WSSerialState::TRANSMIT;
+		m_pauseTimer.start(static_cast<int>(qMax(m_skipPause, m_silence)));
+	}
+}
+
+void WSSerialInterface::onFrameSilence() {
+	if (m_state == WSSerialState::MONITOR) {
+		if (m_monitorPending && m_protocol->processMonitored(QByteArray(), true) == WSProtocolParseCode::INCORRECT) {
+			emit errorDataReceived(QByteArray());
+		}
+		m_monitorPending = false;
+	} else if (m_state == WSSerialState::RECEIVE && !m_recvBuffer.isEmpty()) {
+		// Frame is over but not complete, there is no need to wait for the response timeout
+		m_timeoutTimer.stop();
+		m_state = WSSerialState::TRANSMIT;
+		receiveError();
+	}
+}
+
+void WSSerialInterface::onPause() {
+	if (m_state == WSSerialState::TRANSMIT) {
+		transmit();
 	}
 }
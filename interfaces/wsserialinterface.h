@@ -27,13 +27,16 @@
 #include <QSerialPort>
 #include "protocols/wsabstractrrprotocol.h"
 #include "wspollingrrinterface.h"
+#include "wsreceivebuffer.h"
 
 enum class WSSerialState : quint8 {
 	NONE = 0,
 	TRANSMIT = 1,
-	RECEIVE = 2
+	RECEIVE = 2,
+	MONITOR = 3
 };
 
+// Event-driven transport, many interfaces may share one thread
 class WSSerialInterface : public WSPollingRRInterface {
 Q_OBJECT
 
@@ -42,6 +45,8 @@ public:
 
 	WSInterface type() const override;
 	void workerLoop() override;
+	bool eventDriven() const override;
+	void stop() override;
 
 	QString portName() const;
 	void setPortName(const QString &portName);
@@ -58,6 +63,11 @@ public:
 	QSerialPort::StopBits stopBits() const;
 	void setStopBits(const QSerialPort::StopBits &stopBits);
 
+	bool listenOnly() const;
+	void setListenOnly(bool listenOnly);
+	quint32 interFrameTimeout() const;
+	quint32 silenceInterval() const;
+
 	static QSerialPort::DataBits dataBitsFromNumber(int dataBits);
 	static int dataBitsToNumber(const QSerialPort::DataBits &dataBits);
 
@@ -70,7 +80,30 @@ public:
 private:
 	QSerialPort m_serial;
 	WSSerialState m_state;
-	QByteArray m_recvBuffer;
+	WSReceiveBuffer m_recvBuffer;
+	bool m_listenOnly;
+	// Response timeout
+	QTimer m_timeoutTimer;
+	// End of frame by the bus silence (t3.5)
+	QTimer m_frameTimer;
+	quint32 m_silence;
+	quint32 m_frameSilence;
+	// Polling, skip and error pauses
+	QTimer m_pauseTimer;
+	bool m_monitorPending;
+
+	void shutdown();
+	void transmit();
+	void receive(qint32 length);
+	void receiveError();
+	void monitor();
+
+	void onReadyRead();
+	void onBytesWritten();
+	void onError(QSerialPort::SerialPortError error);
+	void onTimeout();
+	void onFrameSilence();
+	void onPause();
 };
 
 #endif // WSSERIALINTERFACE_H
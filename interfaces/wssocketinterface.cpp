@@ -2,14 +2,15 @@
 
 WSSocketInterface::WSSocketInterface(QHostAddress ipAddress, quint16 port, WSAbstractRRProtocol *protocol, QThread *mainThread, QObject *parent) :
 	WSPollingRRInterface(protocol, mainThread, parent),
-	m_socket(this),
 	m_ipAddress(ipAddress),
 	m_port(port),
 	m_autoReconnect(Conf::DEVICE_TCP_AUTO_RECONNECT),
-	m_state(WSSocketState::NONE)
-{
-	m_socket.setProxy(QNetworkProxy::NoProxy);
-}
+	m_pipelineWindow(1),
+	m_connections(1),
+	m_pipelined(false),
+	m_rawFraming(false),
+	m_lanesUp(0)
+{}
 
 WSInterface WSSocketInterface::type() const {
 	return WSInterface::TCP;
@@ -51,86 +52,407 @@ void WSSocketInterface::setPort(quint16 port) {
 	}
 }
 
+quint32 WSSocketInterface::pipelineWindow() const {
+	QMutexLocker ml(&m_lock);
+	return m_pipelineWindow;
+}
+
+void WSSocketInterface::setPipelineWindow(quint32 pipelineWindow) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_pipelineWindow = qBound(static_cast<quint32>(1), pipelineWindow, Conf::DEVICE_TCP_MAX_PIPELINE_WINDOW);
+	}
+}
+
+quint32 WSSocketInterface::connections() const {
+	QMutexLocker ml(&m_lock);
+	return m_connections;
+}
+
+void WSSocketInterface::setConnections(quint32 connections) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_connections = qBound(static_cast<quint32>(1), connections, Conf::DEVICE_TCP_MAX_CONNECTIONS);
+	}
+}
+
 void WSSocketInterface::workerLoop() {
-	bool tryDisconnect = false;
-	while (true) {
-		QCoreApplication::processEvents();
-		m_socket.connectToHost(m_ipAddress, m_port);
-		if (m_socket.waitForConnected(static_cast<int>(m_connectionWaitTime))) {
-			emit connected();
-			m_state = WSSocketState::TRANSMIT;
-			while (true) {
-				QCoreApplication::processEvents();
-				if (getStopFlag()) {
-					tryDisconnect = true;
-					break;
-				}
-				if (m_state == WSSocketState::TRANSMIT) {
-					QByteArray data = m_protocol->constructRequest();
-					if (data.size() > 0) {
-						m_socket.write(data);
-						if (m_socket.waitForBytesWritten(static_cast<int>(m_transmitTimeout))) {
-							emit trasmitted(data);
-							m_recvBuffer.clear();
-							m_state = WSSocketState::RECEIVE;
-						} else {
-							emit transmitTimeoutOccurred(m_transmitTimeout);
-							tryDisconnect = true;
-							break;
-						}
-					} else {
-						emit dataSkipped();
-						QThread::msleep(m_skipPause);
-						continue;
-					}
-				} else if (m_state == WSSocketState::RECEIVE) {
-					if (m_socket.bytesAvailable() > 0 || m_socket.waitForReadyRead(static_cast<int>(m_receiveTimeout))) {
-						QByteArray readData = m_socket.readAll();
-						m_recvBuffer.append(readData);
-						emit received(readData);
-						WSProtocolParseCode code = m_protocol->processResponse(m_recvBuffer);
-						if (code == WSProtocolParseCode::INCOMPLETE) {
-							emit incompleteDataReceived(m_recvBuffer);
-							QThread::msleep(m_skipPause);
-							continue;
-						} else if (code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) {
-							emit validDataReceived(m_recvBuffer);
-							m_state = WSSocketState::TRANSMIT;
-							QThread::msleep(m_pollingPause);
-							continue;
-						} else {
-							emit errorDataReceived(m_recvBuffer);
-							tryDisconnect = true;
-							break;
-						}
-					} else {
-						emit receiveTimeoutOccurred(m_receiveTimeout);
-						tryDisconnect = true;
-						break;
-					}
-				}
+	m_clock.start();
+	timingReset();
+	// Parallel connections need responses matched by transaction id
+	quint32 count = 1;
+	if (m_connections > 1 && m_protocol->pipelineSupported()) {
+		count = qMin(m_connections, m_protocol->maxLanes());
+	}
+	m_protocol->setLanes(count);
+	m_pipelined = (count > 1 || m_pipelineWindow > 1) && m_protocol->pipelineSupported();
+	m_rawFraming = m_protocol->rawFraming();
+	createLanes(count);
+	for (quint32 lane = 0; lane < count; lane++) {
+		connectToHost(lane);
+	}
+}
+
+bool WSSocketInterface::eventDriven() const {
+	return true;
+}
+
+void WSSocketInterface::stop() {
+	WSPollingInterface::stop();
+	// Interface lives in the polling thread
+	QMetaObject::invokeMethod(this, [this]() {shutdown();}, Qt::QueuedConnection);
+}
+
+// Sockets and timers are created in the polling thread
+void WSSocketInterface::createLanes(quint32 count) {
+	while (static_cast<quint32>(m_lanes.size()) > count) {
+		m_lanes.last().socket->deleteLater();
+		m_lanes.last().timeoutTimer->deleteLater();
+		m_lanes.last().pauseTimer->deleteLater();
+		m_lanes.removeLast();
+	}
+	while (static_cast<quint32>(m_lanes.size()) < count) {
+		quint32 lane = static_cast<quint32>(m_lanes.size());
+		WSSocketLane l;
+		l.socket = new QTcpSocket(this);
+		l.socket->setProxy(QNetworkProxy::NoProxy);
+		l.timeoutTimer = new QTimer(this);
+		l.timeoutTimer->setSingleShot(true);
+		l.timeoutTimer->setTimerType(Qt::PreciseTimer);
+		l.pauseTimer = new QTimer(this);
+		l.pauseTimer->setSingleShot(true);
+		l.pauseTimer->setTimerType(Qt::PreciseTimer);
+		l.recvBuffer = std::make_shared<WSReceiveBuffer>();
+		connect(l.socket, &QTcpSocket::connected, this, [this, lane]() {onConnected(lane);});
+		connect(l.socket, &QTcpSocket::disconnected, this, [this, lane]() {onDisconnected(lane);});
+		connect(l.socket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error), this, [this, lane](QAbstractSocket::SocketError) {onError(lane);});
+		connect(l.socket, &QTcpSocket::readyRead, this, [this, lane]() {onReadyRead(lane);});
+		connect(l.socket, &QTcpSocket::bytesWritten, this, [this, lane]() {onBytesWritten(lane);});
+		connect(l.timeoutTimer, &QTimer::timeout, this, [this, lane]() {onTimeout(lane);});
+		connect(l.pauseTimer, &QTimer::timeout, this, [this, lane]() {onPause(lane);});
+		m_lanes.append(l);
+	}
+	for (WSSocketLane &l: m_lanes) {
+		l.state = WSSocketState::NONE;
+		l.up = false;
+		l.recvBuffer->reserve(static_cast<qint32>(m_protocol->bufferSize() * Conf::DEVICE_RECEIVE_BUFFER_PACKAGES));
+		l.transactions.start(m_pipelineWindow, false, 0);
+	}
+	m_lanesUp = 0;
+}
+
+void WSSocketInterface::shutdown() {
+	for (quint32 lane = 0; lane < static_cast<quint32>(m_lanes.size()); lane++) {
+		WSSocketState state = m_lanes.at(lane).state;
+		if (state == WSSocketState::RECONNECT_PAUSE) {
+			reconnectOrFinish(lane);
+		} else if (state != WSSocketState::NONE && state != WSSocketState::DISCONNECTING) {
+			closeConnection(lane);
+		}
+	}
+}
+
+void WSSocketInterface::connectToHost(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	l.state = WSSocketState::CONNECTING;
+	l.socket->connectToHost(m_ipAddress, m_port);
+	if (l.state == WSSocketState::CONNECTING) {
+		l.timeoutTimer->start(static_cast<int>(m_connectionWaitTime));
+	}
+}
+
+void WSSocketInterface::closeConnection(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	l.timeoutTimer->stop();
+	l.pauseTimer->stop();
+	if (m_pipelined && getStopFlag()) {
+		m_protocol->transactionsReset();
+		l.transactions.clear();
+	} else {
+		dropTransactions(lane);
+	}
+	if (l.socket->state() != QAbstractSocket::ConnectedState && l.socket->state() != QAbstractSocket::ClosingState) {
+		l.socket->abort();
+		laneDown(lane);
+		reconnectOrFinish(lane);
+		return;
+	}
+	l.state = WSSocketState::DISCONNECTING;
+	// Disconnected signal may be emitted at once
+	l.socket->disconnectFromHost();
+	if (l.state == WSSocketState::DISCONNECTING) {
+		l.timeoutTimer->start(static_cast<int>(m_disconnectionWaitTime));
+	}
+}
+
+// Outstanding requests of the connection are lost, other connections keep theirs
+void WSSocketInterface::dropTransactions(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	WSTransaction t;
+	while (l.transactions.takeFirst(t)) {
+		emit transactionTimeoutOccurred(t.id, t.timeout);
+	}
+}
+
+// Interface is disconnected with the last connection
+void WSSocketInterface::laneDown(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	if (l.up) {
+		l.up = false;
+		if (--m_lanesUp == 0) {
+			emit disconnected();
+		}
+	}
+}
+
+void WSSocketInterface::reconnectOrFinish(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	if (!getStopFlag() && m_autoReconnect) {
+		l.state = WSSocketState::RECONNECT_PAUSE;
+		l.pauseTimer->start(static_cast<int>(m_reconnectPause));
+		return;
+	}
+	l.timeoutTimer->stop();
+	l.pauseTimer->stop();
+	l.state = WSSocketState::NONE;
+	for (const WSSocketLane &other: m_lanes) {
+		if (other.state != WSSocketState::NONE) {
+			return;
+		}
+	}
+	finish();
+}
+
+void WSSocketInterface::transmit(quint32 lane) {
+	if (getStopFlag()) {
+		closeConnection(lane);
+		return;
+	}
+	if (m_pipelined) {
+		transmitPipelined(lane);
+		return;
+	}
+	WSSocketLane &l = m_lanes[lane];
+	const QByteArray &data = m_protocol->constructRequest();
+	if (data.size() == 0) {
+		emit dataSkipped();
+		l.pauseTimer->start(static_cast<int>(m_skipPause));
+		return;
+	}
+	l.recvBuffer->clear();
+	l.state = WSSocketState::RECEIVE;
+	l.socket->write(data);
+	l.socket->flush();
+	requestSent();
+	statsTransmitted(data.size());
+	emit trasmitted(traced(data));
+	// Response timeout is restarted when the request is written
+	l.timeoutTimer->start(static_cast<int>((l.socket->bytesToWrite() > 0) ? m_transmitTimeout : m_requestTimeout));
+}
+
+void WSSocketInterface::onConnected(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	l.timeoutTimer->stop();
+	l.socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+	l.up = true;
+	if (m_lanesUp++ == 0) {
+		emit connected();
+	}
+	// Stale request of the single connection
+	if (m_lanes.size() == 1) {
+		m_protocol->transactionsReset();
+	}
+	l.recvBuffer->clear();
+	l.transactions.start(m_pipelineWindow, false, m_clock.elapsed());
+	l.state = WSSocketState::TRANSMIT;
+	transmit(lane);
+}
+
+void WSSocketInterface::onDisconnected(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	if (l.state == WSSocketState::DISCONNECTING) {
+		l.timeoutTimer->stop();
+		laneDown(lane);
+		reconnectOrFinish(lane);
+	} else if (l.state == WSSocketState::TRANSMIT || l.state == WSSocketState::RECEIVE) {
+		// Closed by the server
+		l.timeoutTimer->stop();
+		l.pauseTimer->stop();
+		if (m_pipelined) {
+			dropTransactions(lane);
+		} else if (l.state == WSSocketState::RECEIVE) {
+			emit receiveTimeoutOccurred(m_receiveTimeout);
+		}
+		laneDown(lane);
+		reconnectOrFinish(lane);
+	}
+}
+
+void WSSocketInterface::onError(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	// Connection refused or host not found, do not wait for the connection timeout
+	if (l.state == WSSocketState::CONNECTING) {
+		l.timeoutTimer->stop();
+		l.socket->abort();
+		emit connectionErrorOccurred();
+		reconnectOrFinish(lane);
+	}
+}
+
+// Data is read directly into the lane buffer, nothing is allocated per read
+void WSSocketInterface::onReadyRead(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	while (l.socket->bytesAvailable() > 0) {
+		qint32 length = static_cast<qint32>(l.recvBuffer->readFrom(l.socket));
+		bool active = (l.state == WSSocketState::TRANSMIT || l.state == WSSocketState::RECEIVE);
+		if (length == 0) {
+			// Buffer is full, the stream is out of sync
+			if (active) {
+				emit errorDataReceived(traced(l.recvBuffer->view()));
+				closeConnection(lane);
 			}
+			l.recvBuffer->clear();
+			return;
+		}
+		// Closing connection
+		if (!active) {
+			l.recvBuffer->clear();
+			continue;
+		}
+		emit received(traced(l.recvBuffer->constData() + l.recvBuffer->size() - length, length));
+		if (m_pipelined) {
+			receivePipelined(lane);
 		} else {
-			emit connectionErrorOccurred();
+			receive(lane);
 		}
-		if (tryDisconnect) {
-			tryDisconnect = false;
-			if (m_socket.state() != QAbstractSocket::UnconnectedState && m_socket.state() != QAbstractSocket::ClosingState) {
-				m_socket.disconnectFromHost();
-				if (m_socket.state() == QAbstractSocket::UnconnectedState || m_socket.waitForDisconnected(static_cast<int>(m_disconnectionWaitTime))) {
-					emit disconnected();
-				} else {
-					emit disconnectionErrorOccurred();
-					break;
-				}
-			}
+	}
+}
+
+void WSSocketInterface::receive(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	const QByteArray &data = l.recvBuffer->view();
+	// Data without request
+	if (l.state != WSSocketState::RECEIVE) {
+		emit errorDataReceived(traced(data));
+		l.recvBuffer->clear();
+		return;
+	}
+	WSProtocolParseCode code = m_protocol->processResponse(data);
+	if (code == WSProtocolParseCode::INCOMPLETE) {
+		// Wait for the rest of the package
+		emit incompleteDataReceived(traced(data));
+	} else if (code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) {
+		l.timeoutTimer->stop();
+		responseReceived(m_requestDevice, m_requestSent);
+		statsReceived(data.size());
+		emit validDataReceived(traced(data));
+		l.state = WSSocketState::TRANSMIT;
+		l.pauseTimer->start(static_cast<int>(m_pollingPause));
+	} else if (m_rawFraming) {
+		// Late response or noise from the gateway, the response may still come
+		emit errorDataReceived(traced(data));
+		l.recvBuffer->clear();
+	} else {
+		emit errorDataReceived(traced(data));
+		closeConnection(lane);
+	}
+}
+
+void WSSocketInterface::onBytesWritten(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	if (!m_pipelined && l.state == WSSocketState::RECEIVE && l.socket->bytesToWrite() == 0) {
+		l.timeoutTimer->start(static_cast<int>(m_requestTimeout));
+	}
+}
+
+void WSSocketInterface::onTimeout(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	if (l.state == WSSocketState::CONNECTING) {
+		l.socket->abort();
+		emit connectionErrorOccurred();
+		reconnectOrFinish(lane);
+	} else if (l.state == WSSocketState::DISCONNECTING) {
+		l.socket->abort();
+		emit disconnectionErrorOccurred();
+		laneDown(lane);
+		l.state = WSSocketState::NONE;
+		reconnectOrFinish(lane);
+	} else if (m_pipelined && l.state == WSSocketState::TRANSMIT) {
+		// Expire outstanding requests
+		WSTransaction t;
+		while (l.transactions.takeExpired(m_clock.elapsed(), t)) {
+			responseLost(t.device);
+			emit transactionTimeoutOccurred(t.id, t.timeout);
+		}
+		transmit(lane);
+	} else if (l.state == WSSocketState::RECEIVE) {
+		if (l.socket->bytesToWrite() > 0) {
+			emit transmitTimeoutOccurred(m_transmitTimeout);
+			closeConnection(lane);
+		} else {
+			responseLost(m_requestDevice);
+			emit receiveTimeoutOccurred(m_requestTimeout);
+			resync(lane);
+		}
+	}
+}
+
+// Silent device does not break tunnelled frames, other streams are reconnected to drop late responses
+void WSSocketInterface::resync(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	if (!m_rawFraming) {
+		closeConnection(lane);
+		return;
+	}
+	l.recvBuffer->clear();
+	l.state = WSSocketState::TRANSMIT;
+	l.pauseTimer->start(static_cast<int>(qMax(m_pollingPause, m_errorPause)));
+}
+
+void WSSocketInterface::onPause(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	if (l.state == WSSocketState::RECONNECT_PAUSE) {
+		emit reconnecting();
+		connectToHost(lane);
+	} else if (l.state == WSSocketState::TRANSMIT) {
+		transmit(lane);
+	}
+}
+
+void WSSocketInterface::transmitPipelined(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	QTcpSocket *socket = l.socket;
+	transmitWindow(l.transactions, lane, m_clock, [socket](const QByteArray &data) {socket->write(data);});
+	l.socket->flush();
+	l.transactions.schedule(l.timeoutTimer, l.pauseTimer, m_clock.elapsed());
+}
+
+void WSSocketInterface::receivePipelined(quint32 lane) {
+	WSSocketLane &l = m_lanes[lane];
+	WSReceiveBuffer &buffer = *l.recvBuffer;
+	qint32 len;
+	quint32 transactionId;
+	// Split stream to packages from the last parsed position, match them by transaction id
+	while ((len = m_protocol->frameLength(buffer.view(), &transactionId)) > 0) {
+		const QByteArray &frame = buffer.view(len);
+		WSTransaction t;
+		if (l.transactions.take(transactionId, t)) {
+			transactionAnswered(t);
 		}
-		if (!getStopFlag() && m_autoReconnect) {
-			m_state = WSSocketState::NONE;
-			QThread::msleep(m_reconnectPause);
-			emit reconnecting();
+		WSProtocolParseCode code = m_protocol->processTransaction(transactionId, frame);
+		if (code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) {
+			statsReceived(len);
+			emit validDataReceived(traced(frame));
 		} else {
-			break;
+			emit errorDataReceived(traced(frame));
 		}
+		buffer.consume(len);
+	}
+	// Stream is out of sync
+	if (len < 0) {
+		emit errorDataReceived(traced(buffer.view()));
+		closeConnection(lane);
+		return;
 	}
+	transmit(lane);
 }
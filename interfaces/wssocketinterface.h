@@ -30,13 +30,34 @@
 #include <QTcpSocket>
 #include "protocols/wsabstractrrprotocol.h"
 #include "wspollingrrinterface.h"
+#include "wsreceivebuffer.h"
 
 enum class WSSocketState : quint8 {
 	NONE = 0,
 	TRANSMIT = 1,
-	RECEIVE = 2
+	RECEIVE = 2,
+	CONNECTING = 3,
+	DISCONNECTING = 4,
+	RECONNECT_PAUSE = 5
 };
 
+// Connection with own pipeline, objects are owned by the interface
+struct WSSocketLane {
+	QTcpSocket *socket;
+	// Connection, response and disconnection timeouts
+	QTimer *timeoutTimer;
+	// Polling, skip and reconnection pauses
+	QTimer *pauseTimer;
+	WSSocketState state;
+	bool up;
+	// Shared by copies of the lane, allocated once
+	std::shared_ptr<WSReceiveBuffer> recvBuffer;
+	// Outstanding requests
+	WSTransactionWindow transactions;
+};
+
+// Event-driven transport: responses are parsed as soon as data arrives, timers are used for timeouts and pauses only.
+// Several connections (lanes) to one gateway may be opened, devices are spread over them by unit id.
 class WSSocketInterface : public WSPollingRRInterface {
 Q_OBJECT
 
@@ -45,6 +66,8 @@ public:
 
 	WSInterface type() const override;
 	virtual void workerLoop() override;
+	bool eventDriven() const override;
+	void stop() override;
 
 	QHostAddress ipAddress() const;
 	void setIpAddress(const QHostAddress &ipAddress);
@@ -55,13 +78,45 @@ public:
 	bool autoReconnect() const;
 	void setAutoReconnect(bool autoReconnect);
 
+	quint32 pipelineWindow() const;
+	void setPipelineWindow(quint32 pipelineWindow);
+
+	// Parallel connections, used if the protocol matches responses by transaction id
+	quint32 connections() const;
+	void setConnections(quint32 connections);
+
 private:
-	QTcpSocket m_socket;
 	QHostAddress m_ipAddress;
 	quint16 m_port;
 	bool m_autoReconnect;
-	WSSocketState m_state;
-	QByteArray m_recvBuffer;
+	quint32 m_pipelineWindow;
+	quint32 m_connections;
+	bool m_pipelined;
+	bool m_rawFraming;
+	QVector<WSSocketLane> m_lanes;
+	quint32 m_lanesUp;
+	QElapsedTimer m_clock;
+
+	void createLanes(quint32 count);
+	void connectToHost(quint32 lane);
+	void closeConnection(quint32 lane);
+	void dropTransactions(quint32 lane);
+	void laneDown(quint32 lane);
+	void reconnectOrFinish(quint32 lane);
+	void shutdown();
+	void transmit(quint32 lane);
+	void receive(quint32 lane);
+	void transmitPipelined(quint32 lane);
+	void receivePipelined(quint32 lane);
+	void resync(quint32 lane);
+
+	void onConnected(quint32 lane);
+	void onDisconnected(quint32 lane);
+	void onError(quint32 lane);
+	void onReadyRead(quint32 lane);
+	void onBytesWritten(quint32 lane);
+	void onTimeout(quint32 lane);
+	void onPause(quint32 lane);
 };
 
 #endif // WSSOCKETINTERFACE_H
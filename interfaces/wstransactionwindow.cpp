@@ -0,0 +1,107 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#include "wstransactionwindow.h"
+
+WSTransactionWindow::WSTransactionWindow() :
+	m_capacity(1),
+	m_keepFrames(false),
+	m_nextTransmit(0)
+{}
+
+void WSTransactionWindow::start(quint32 capacity, bool keepFrames, qint64 now) {
+	m_transactions.clear();
+	m_capacity = qMax(static_cast<quint32>(1), capacity);
+	m_keepFrames = keepFrames;
+	m_nextTransmit = now;
+}
+
+void WSTransactionWindow::clear() {
+	m_transactions.clear();
+}
+
+qint32 WSTransactionWindow::size() const {
+	return m_transactions.size();
+}
+
+bool WSTransactionWindow::isEmpty() const {
+	return m_transactions.isEmpty();
+}
+
+bool WSTransactionWindow::keepFrames() const {
+	return m_keepFrames;
+}
+
+bool WSTransactionWindow::ready(qint64 now) const {
+	return static_cast<quint32>(m_transactions.size()) < m_capacity && now >= m_nextTransmit;
+}
+
+void WSTransactionWindow::pause(qint64 nextTransmit) {
+	m_nextTransmit = nextTransmit;
+}
+
+void WSTransactionWindow::insert(const WSTransaction &transaction) {
+	qint32 i = m_transactions.size();
+	while (i > 0 && m_transactions.at(i - 1).deadline > transaction.deadline) {
+		i--;
+	}
+	m_transactions.insert(i, transaction);
+}
+
+bool WSTransactionWindow::take(quint32 id, WSTransaction &transaction) {
+	for (qint32 i = 0; i < m_transactions.size(); i++) {
+		if (m_transactions.at(i).id == id) {
+			transaction = m_transactions.takeAt(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool WSTransactionWindow::takeExpired(qint64 now, WSTransaction &transaction) {
+	if (m_transactions.isEmpty() || m_transactions.first().deadline > now) {
+		return false;
+	}
+	transaction = m_transactions.takeFirst();
+	return true;
+}
+
+bool WSTransactionWindow::takeFirst(WSTransaction &transaction) {
+	if (m_transactions.isEmpty()) {
+		return false;
+	}
+	transaction = m_transactions.takeFirst();
+	return true;
+}
+
+void WSTransactionWindow::schedule(QTimer *timeoutTimer, QTimer *pauseTimer, qint64 now) const {
+	if (m_transactions.isEmpty()) {
+		timeoutTimer->stop();
+	} else {
+		timeoutTimer->start(static_cast<int>(qMax(static_cast<qint64>(0), m_transactions.first().deadline - now)));
+	}
+	if (static_cast<quint32>(m_transactions.size()) < m_capacity) {
+		pauseTimer->start(static_cast<int>(qMax(static_cast<qint64>(0), m_nextTransmit - now)));
+	} else {
+		pauseTimer->stop();
+	}
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSTRANSACTIONWINDOW_H
+#define WSTRANSACTIONWINDOW_H
+
+#include <QtCore>
+
+// Outstanding request, deadline in ms of the transport clock, sent time of the timing clock
+struct WSTransaction {
+	quint32 id;
+	qint64 deadline;
+	quint32 device;
+	qint64 sent;
+	quint32 timeout;
+	// Round-trip time of retransmitted request is ambiguous (Karn's algorithm)
+	quint32 retries;
+	// Copy of the request for retransmission (empty if requests are not kept)
+	QByteArray frame;
+};
+
+// Window of pipelined requests of one connection (stream or datagram transport).
+// Requests are ordered by response deadline, timeouts of devices differ.
+class WSTransactionWindow {
+
+public:
+	WSTransactionWindow();
+
+	// Window is emptied, the first request may be sent at the given time
+	void start(quint32 capacity, bool keepFrames, qint64 now);
+	void clear();
+
+	qint32 size() const;
+	bool isEmpty() const;
+	bool keepFrames() const;
+	// Free slot and the pause after the previous request is over
+	bool ready(qint64 now) const;
+	void pause(qint64 nextTransmit);
+
+	void insert(const WSTransaction &transaction);
+	// Transaction of the response, false for late, duplicate or unknown response
+	bool take(quint32 id, WSTransaction &transaction);
+	// Nearest transaction whose deadline is passed
+	bool takeExpired(qint64 now, WSTransaction &transaction);
+	bool takeFirst(WSTransaction &transaction);
+
+	// Timers for the nearest deadline and the next transmission
+	void schedule(QTimer *timeoutTimer, QTimer *pauseTimer, qint64 now) const;
+
+private:
+	QList<WSTransaction> m_transactions;
+	quint32 m_capacity;
+	bool m_keepFrames;
+	qint64 m_nextTransmit;
+};
+
+#endif // WSTRANSACTIONWINDOW_H
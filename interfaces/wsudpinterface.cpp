@@ -0,0 +1,205 @@
+#include "wsudpinterface.h"
+
+WSUdpInterface::WSUdpInterface(QHostAddress ipAddress, quint16 port, WSAbstractRRProtocol *protocol, QThread *mainThread, QObject *parent) :
+	WSPollingRRInterface(protocol, mainThread, parent),
+	m_socket(this),
+	m_ipAddress(ipAddress),
+	m_port(port),
+	m_pipelineWindow(1),
+	m_retries(Conf::DEVICE_UDP_RETRIES),
+	m_active(false),
+	m_timeoutTimer(this),
+	m_pauseTimer(this)
+{
+	m_socket.setProxy(QNetworkProxy::NoProxy);
+	m_timeoutTimer.setSingleShot(true);
+	m_timeoutTimer.setTimerType(Qt::PreciseTimer);
+	m_pauseTimer.setSingleShot(true);
+	m_pauseTimer.setTimerType(Qt::PreciseTimer);
+	connect(&m_socket, &QUdpSocket::readyRead, this, &WSUdpInterface::onReadyRead);
+	connect(&m_timeoutTimer, &QTimer::timeout, this, &WSUdpInterface::onTimeout);
+	connect(&m_pauseTimer, &QTimer::timeout, this, &WSUdpInterface::onPause);
+}
+
+WSInterface WSUdpInterface::type() const {
+	return WSInterface::UDP;
+}
+
+QHostAddress WSUdpInterface::ipAddress() const {
+	QMutexLocker ml(&m_lock);
+	return m_ipAddress;
+}
+
+void WSUdpInterface::setIpAddress(const QHostAddress &ipAddress) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_ipAddress = ipAddress;
+	}
+}
+
+quint16 WSUdpInterface::port() const {
+	QMutexLocker ml(&m_lock);
+	return m_port;
+}
+
+void WSUdpInterface::setPort(quint16 port) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_port = port;
+	}
+}
+
+quint32 WSUdpInterface::pipelineWindow() const {
+	QMutexLocker ml(&m_lock);
+	return m_pipelineWindow;
+}
+
+void WSUdpInterface::setPipelineWindow(quint32 pipelineWindow) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_pipelineWindow = qBound(static_cast<quint32>(1), pipelineWindow, Conf::DEVICE_TCP_MAX_PIPELINE_WINDOW);
+	}
+}
+
+quint32 WSUdpInterface::retries() const {
+	QMutexLocker ml(&m_lock);
+	return m_retries;
+}
+
+void WSUdpInterface::setRetries(quint32 retries) {
+	QMutexLocker ml(&m_lock);
+	if (!m_started) {
+		m_retries = retries;
+	}
+}
+
+void WSUdpInterface::workerLoop() {
+	// Datagrams are matched by transaction id
+	if (!m_protocol->pipelineSupported()) {
+		emit connectionErrorOccurred();
+		finish();
+		return;
+	}
+	// Any local port, there is no connection
+	if (!m_socket.bind(QHostAddress(QHostAddress::AnyIPv4), 0)) {
+		emit connectionErrorOccurred();
+		finish();
+		return;
+	}
+	m_clock.start();
+	timingReset();
+	m_recvBuffer.reserve(static_cast<qint32>(m_protocol->bufferSize() * Conf::DEVICE_RECEIVE_BUFFER_PACKAGES));
+	m_protocol->transactionsReset();
+	m_transactions.start(m_pipelineWindow, true, m_clock.elapsed());
+	m_active = true;
+	emit connected();
+	transmit();
+}
+
+bool WSUdpInterface::eventDriven() const {
+	return true;
+}
+
+void WSUdpInterface::stop() {
+	WSPollingInterface::stop();
+	// Interface lives in the polling thread
+	QMetaObject::invokeMethod(this, [this]() {shutdown();}, Qt::QueuedConnection);
+}
+
+void WSUdpInterface::shutdown() {
+	if (!m_active) {
+		return;
+	}
+	m_active = false;
+	m_timeoutTimer.stop();
+	m_pauseTimer.stop();
+	m_protocol->transactionsReset();
+	m_transactions.clear();
+	m_socket.close();
+	emit disconnected();
+	finish();
+}
+
+void WSUdpInterface::transmit() {
+	if (getStopFlag()) {
+		shutdown();
+		return;
+	}
+	transmitWindow(m_transactions, 0, m_clock, [this](const QByteArray &data) {m_socket.writeDatagram(data, m_ipAddress, m_port);});
+	m_transactions.schedule(&m_timeoutTimer, &m_pauseTimer, m_clock.elapsed());
+}
+
+void WSUdpInterface::onReadyRead() {
+	while (m_socket.hasPendingDatagrams()) {
+		QHostAddress sender;
+		quint16 senderPort;
+		// Datagram longer than the buffer is truncated and rejected by the package length
+		m_recvBuffer.clear();
+		qint64 size = m_socket.readDatagram(m_recvBuffer.tail(), m_recvBuffer.available(), &sender, &senderPort);
+		// Foreign datagram
+		if (!m_active || size <= 0 || sender.toIPv4Address() != m_ipAddress.toIPv4Address() || senderPort != m_port) {
+			continue;
+		}
+		m_recvBuffer.commit(static_cast<qint32>(size));
+		const QByteArray &datagram = m_recvBuffer.view();
+		emit received(traced(datagram));
+		receive(datagram);
+	}
+	if (m_active) {
+		transmit();
+	}
+}
+
+void WSUdpInterface::receive(const QByteArray &datagram) {
+	quint32 transactionId;
+	qint32 len = m_protocol->frameLength(datagram, &transactionId);
+	// Datagram carries exactly one package
+	if (len != datagram.size()) {
+		emit errorDataReceived(traced(datagram));
+		return;
+	}
+	WSTransaction t;
+	// Duplicate or late response, the request is already answered or expired
+	if (!m_transactions.take(transactionId, t)) {
+		return;
+	}
+	transactionAnswered(t);
+	WSProtocolParseCode code = m_protocol->processTransaction(transactionId, datagram);
+	if (code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) {
+		statsReceived(datagram.size());
+		emit validDataReceived(traced(datagram));
+	} else {
+		emit errorDataReceived(traced(datagram));
+	}
+}
+
+void WSUdpInterface::onTimeout() {
+	if (!m_active) {
+		return;
+	}
+	qint64 now = m_clock.elapsed();
+	WSTransaction t;
+	while (m_transactions.takeExpired(now, t)) {
+		responseLost(t.device);
+		if (t.retries < m_retries && !getStopFlag()) {
+			// Datagram or its response is lost, send the same request again
+			t.retries++;
+			t.timeout = responseTimeout(t.device);
+			t.deadline = now + t.timeout;
+			m_socket.writeDatagram(t.frame, m_ipAddress, m_port);
+			// Counted as traffic only, the request is not a new poll
+			m_bytesCount.fetch_add(static_cast<quint64>(t.frame.size()), std::memory_order_relaxed);
+			emit trasmitted(traced(t.frame));
+			m_transactions.insert(t);
+		} else {
+			emit transactionTimeoutOccurred(t.id, t.timeout);
+		}
+	}
+	transmit();
+}
+
+void WSUdpInterface::onPause() {
+	if (m_active) {
+		transmit();
+	}
+}
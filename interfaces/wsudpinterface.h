@@ -0,0 +1,85 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSUDPINTERFACE_H
+#define WSUDPINTERFACE_H
+
+#include <QObject>
+#include <QtCore>
+#include <QtNetwork>
+#include <QUdpSocket>
+#include "protocols/wsabstractrrprotocol.h"
+#include "wspollingrrinterface.h"
+#include "wsreceivebuffer.h"
+
+// Event-driven datagram transport: one request or response per datagram, requests are pipelined
+// and matched by transaction id, lost datagrams are retransmitted by per-request timers
+class WSUdpInterface : public WSPollingRRInterface {
+Q_OBJECT
+
+public:
+	WSUdpInterface(QHostAddress ipAddress, quint16 port, WSAbstractRRProtocol *protocolGet, QThread *mainThread, QObject *parent = nullptr);
+
+	WSInterface type() const override;
+	void workerLoop() override;
+	bool eventDriven() const override;
+	void stop() override;
+
+	QHostAddress ipAddress() const;
+	void setIpAddress(const QHostAddress &ipAddress);
+
+	quint16 port() const;
+	void setPort(quint16 port);
+
+	quint32 pipelineWindow() const;
+	void setPipelineWindow(quint32 pipelineWindow);
+
+	quint32 retries() const;
+	void setRetries(quint32 retries);
+
+private:
+	QUdpSocket m_socket;
+	QHostAddress m_ipAddress;
+	quint16 m_port;
+	quint32 m_pipelineWindow;
+	quint32 m_retries;
+	bool m_active;
+	// Outstanding requests, kept for retransmission
+	WSTransactionWindow m_transactions;
+	// Nearest retransmission or response timeout
+	QTimer m_timeoutTimer;
+	// Polling and skip pauses
+	QTimer m_pauseTimer;
+	QElapsedTimer m_clock;
+	// Datagram is read in place, one at a time
+	WSReceiveBuffer m_recvBuffer;
+
+	void shutdown();
+	void transmit();
+	void receive(const QByteArray &datagram);
+
+	void onReadyRead();
+	void onTimeout();
+	void onPause();
+};
+
+#endif // WSUDPINTERFACE_H
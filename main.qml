@@ -140,23 +140,49 @@ ApplicationWindow {
 		nameFilters: [ qsTr("Weprex session file ") + "(*." + appSettings.projectFileExtension + ")", qsTr("All files ") + "(*)" ]
 	}
 
-	Connections {
-		target: app
-		onValueError: {
-			var iface = interfaces[interfaceId]
-			iface["interface"].errorOccurred(paramId, errCode, errorCounter)
-		}
-		onValueChanged: {
-			var iface = interfaces[interfaceId]
-			iface["interface"].valueChanged(paramId, value, valueRaw, responseCounter)
+	FileDialog {
+		id: dialogTrafficFolder
+		title: qsTr("Please choose a folder for traffic capture files")
+		folder: shortcuts.home
+		selectFolder: true
+		onAccepted: {
+			if (app.startTrafficCapture(dialogTrafficFolder.fileUrl)) {
+				log(whoLog, qsTr("Traffic capture started in \"") + dialogTrafficFolder.fileUrl + "\".")
+			} else {
+				log(whoLog, qsTr("Error. Traffic capture files can not be created."))
+				showAlert(qsTr("Error."), qsTr("Traffic capture files can not be created."))
+			}
+			miTrafficCapture.checked = app.trafficCaptureActive()
 		}
-		onValueTimeout: {
-			var iface = interfaces[interfaceId]
-			iface["interface"].timeoutOccurred(paramId, timeoutCounter)
+		onRejected: {
+			miTrafficCapture.checked = app.trafficCaptureActive()
 		}
-		onValueRequest: {
-			var iface = interfaces[interfaceId]
-			iface["interface"].valueRequest(paramId, requestCounter)
+	}
+
+	Connections {
+		target: app
+		// Coalesced updates since the previous delivery, result: 1 - value, 2 - error, 3 - timeout
+		onValuesUpdated: {
+			for (var i = 0; i < updates.length; i++) {
+				var u = updates[i]
+				var iface = interfaces[u.interfaceId]
+				if (iface === undefined) {
+					continue
+				}
+				if (u.requested) {
+					iface["interface"].valueRequest(u.paramId, u.requestCounter)
+				}
+				if (u.result === 1) {
+					iface["interface"].valueChanged(u.paramId, u.value, u.valueRaw, u.counter, new Date(u.time))
+				} else if (u.result === 2) {
+					iface["interface"].errorOccurred(u.paramId, u.errCode, u.counter, new Date(u.time))
+				} else if (u.result === 3) {
+					iface["interface"].timeoutOccurred(u.paramId, u.counter)
+				}
+				if (u.latency !== undefined) {
+					iface["interface"].writeCompleted(u.paramId, u.latency)
+				}
+			}
 		}
 
 		onInfo: {
@@ -183,9 +209,14 @@ ApplicationWindow {
 			var iface = interfaces[interfaceId]
 			iface["interface"].reconnecting()
 		}
+		onInterfaceDeviceTiming: {
+			var iface = interfaces[interfaceId]
+			iface["interface"].deviceTiming(device, srtt, rttvar, timeout)
+		}
 	}
 
 	Component.onCompleted: {
+		app.setValuesUpdatePeriod(appSettings.valuesUpdatePeriod)
 		dialogInterface.interfaceAdded.connect(appendInterface)
 		dialogInterface.interfaceEdited.connect(editInterface)
 		log(whoLog, qsTr("Application started."))
@@ -270,6 +301,23 @@ ApplicationWindow {
 		return object
 	}
 
+	// Restore optional values, absent keys get default values
+	function optionalFromStore(store, object, defaults) {
+		for (var k in defaults) {
+			var val = store.value(k)
+			if (typeof val === "undefined") {
+				object[k] = defaults[k]
+			} else if (typeof defaults[k] === "boolean") {
+				object[k] = valToBool(val)
+			} else if (typeof defaults[k] === "number" && typeof val === "string") {
+				object[k] = parseFloat(val)
+			} else {
+				object[k] = val
+			}
+		}
+		return object
+	}
+
 	function interfaceFromStore(store) {
 		var template = {
 			"protocol": "string",
@@ -288,7 +336,24 @@ ApplicationWindow {
 			"timeout": "int",
 			"pollingPause": "int"
 		}
-		return objectFromStore(store, template)
+		var iface = objectFromStore(store, template)
+		if (iface === null) {
+			return null
+		}
+		// Settings introduced in later versions
+		var defaults = {
+			"blockRead": false,
+			"blockGap": 0,
+			"pipelineWindow": 1,
+			"connections": 1,
+			"replayFile": "",
+			"replaySpeed": 100,
+			"listenOnly": false,
+			"adaptiveTimeout": false,
+			"adaptiveTimeoutMin": 20,
+			"adaptiveTimeoutMax": 5000
+		}
+		return optionalFromStore(store, iface, defaults)
 	}
 	
 	function parameterFromStore(store, protocol) {
@@ -322,7 +387,19 @@ ApplicationWindow {
 				"table": "boolean"
 			}
 		}
-		return objectFromStore(store, template)
+		var param = objectFromStore(store, template)
+		if (param === null) {
+			return null
+		}
+		// Settings introduced in later versions
+		var defaults = {
+			"period": 0,
+			"priority": 0,
+			"deadband": "none",
+			"deadband_value": 0,
+			"heartbeat": 0
+		}
+		return optionalFromStore(store, param, defaults)
 	}
 
 	function saveProject(fileUrl) {
@@ -696,6 +773,20 @@ ApplicationWindow {
 				}
 				checked: false
 			}
+			MenuItem {
+				id: miTrafficCapture
+				text: qsTr("Capture interfaces traffic...")
+				checkable: true
+				onTriggered: {
+					if (checked) {
+						dialogTrafficFolder.open()
+					} else {
+						app.stopTrafficCapture()
+						log(whoLog, qsTr("Traffic capture stopped."))
+					}
+				}
+				checked: false
+			}
 			MenuItem {
 				id: miAutoScrollTableTrace
 				text: qsTr("Scroll table data")
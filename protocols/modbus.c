@@ -54,6 +54,7 @@ struct modbus_server_handle* modbus_server_create(void *regs, uint8_t *access, i
 	}
 	serv->registers = regs;
 	serv->access = access;
+	serv->access_map = NULL;
 	serv->bytes_size = bytes_size;
 	serv->max_registers_send = max_regs_send;
 	serv->device_adr = adr;
@@ -64,11 +65,141 @@ void modbus_server_destroy(struct modbus_server_handle* serv) {
 	free(serv);
 }
 
+void modbus_server_set_access_map(struct modbus_server_handle* serv, struct modbus_access_map *map) {
+	serv->access_map = map;
+}
+
+struct modbus_access_map* modbus_access_map_create(void) {
+	struct modbus_access_map *map;
+	if ((map = (struct modbus_access_map*) malloc(sizeof(struct modbus_access_map))) == NULL) {
+		return NULL;
+	}
+	map->ranges = NULL;
+	map->size = 0;
+	return map;
+}
+
+void modbus_access_map_destroy(struct modbus_access_map *map) {
+	free(map->ranges);
+	free(map);
+}
+
+uint8_t modbus_access_map_set(struct modbus_access_map *map, uint16_t adr, uint32_t count, uint8_t access) {
+	struct modbus_access_range *ranges, *r;
+	uint32_t i, size = 0;
+	uint32_t end = (uint32_t) adr + count;
+	if (count == 0) {
+		return 1;
+	}
+	/* Existing ranges can be split in two parts + new range */
+	if ((ranges = (struct modbus_access_range*) malloc((map->size + 2) * sizeof(struct modbus_access_range))) == NULL) {
+		return 0;
+	}
+	/* Parts of existing ranges before new range */
+	for (i = 0; i < map->size && map->ranges[i].start < adr; i++) {
+		ranges[size] = map->ranges[i];
+		if (ranges[size].end > adr) {
+			ranges[size].end = adr;
+		}
+		size++;
+	}
+	if (access != MB_ACCESS_DENY) {
+		ranges[size].start = adr;
+		ranges[size].end = end;
+		ranges[size].access = access;
+		size++;
+	}
+	/* Parts of existing ranges after new range */
+	for (i = 0; i < map->size; i++) {
+		r = &map->ranges[i];
+		if (r->end > end) {
+			ranges[size] = *r;
+			if (ranges[size].start < end) {
+				ranges[size].start = (uint16_t) end;
+			}
+			size++;
+		}
+	}
+	/* Merge adjacent ranges with the same access */
+	for (i = 1; i < size; ) {
+		if (ranges[i - 1].end == ranges[i].start && ranges[i - 1].access == ranges[i].access) {
+			ranges[i - 1].end = ranges[i].end;
+			memmove(&ranges[i], &ranges[i + 1], (size - i - 1) * sizeof(struct modbus_access_range));
+			size--;
+		} else {
+			i++;
+		}
+	}
+	free(map->ranges);
+	map->ranges = ranges;
+	map->size = size;
+	return 1;
+}
+
+uint8_t modbus_access_map_check(const struct modbus_access_map *map, uint16_t adr, uint32_t count, uint8_t access) {
+	uint32_t low = 0, high = map->size, mid;
+	uint32_t pos = adr, end = (uint32_t) adr + count;
+	/* Last range starting at or before adr */
+	while (low < high) {
+		mid = (low + high) / 2;
+		if (map->ranges[mid].start <= adr) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	if (low == 0) {
+		return 0;
+	}
+	/* Walk through contiguous ranges covering the requested registers */
+	for (mid = low - 1; mid < map->size; mid++) {
+		if (map->ranges[mid].start > pos || (map->ranges[mid].access & access) != access) {
+			return 0;
+		}
+		pos = map->ranges[mid].end;
+		if (pos >= end) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Access check of registers bytes range */
+static uint8_t modbus_server_access(const struct modbus_server_handle *serv, int32_t adr, int32_t size, uint8_t access) {
+	int32_t i;
+	if (serv->access_map != NULL) {
+		return modbus_access_map_check(serv->access_map, (uint16_t) (adr / MB_SIZE_REGISTER), (uint32_t) (size + 1) / MB_SIZE_REGISTER, access);
+	}
+	if (serv->access == NULL) {
+		return 1;
+	}
+	for (i = adr; i < (adr + size); i++) {
+		if (serv->access[i] != access && serv->access[i] != MB_ACCESS_READ_WRITE) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Copy 16-bit registers with byte swap (host little endian <-> Modbus big endian), 8 bytes at once */
+static void modbus_copy_swap16(uint8_t *dst, const uint8_t *src, uint16_t size) {
+	uint64_t word;
+	uint16_t i = 0;
+	for (; i + sizeof(word) <= size; i += sizeof(word)) {
+		memcpy(&word, &src[i], sizeof(word));
+		word = ((word & 0x00FF00FF00FF00FFULL) << 8) | ((word >> 8) & 0x00FF00FF00FF00FFULL);
+		memcpy(&dst[i], &word, sizeof(word));
+	}
+	for (; i + 1 < size; i += MB_SIZE_REGISTER) {
+		dst[i] = src[i + 1];
+		dst[i + 1] = src[i];
+	}
+}
+
 uint16_t modbus_abstract_server(struct modbus_server_handle *serv, uint8_t *in, uint16_t in_len, uint8_t *out) {
 	uint8_t fcode;
 	uint16_t len, cur_size;
 	int32_t adr;
-	int32_t i;
 	uint16_bytes val2byte;
 	
 	len = 0;
@@ -85,20 +216,13 @@ uint16_t modbus_abstract_server(struct modbus_server_handle *serv, uint8_t *in,
 			/* Check address */
 			if ((adr + cur_size) <= serv->bytes_size) {
 				/* Access check */
-				for (i = adr; i < (adr + cur_size); i++) {
-					if (serv->access[i] != MB_ACCESS_READ && serv->access[i] != MB_ACCESS_READ_WRITE) {
-						len = modbus_error(fcode, MB_EC_ILLEGAL_FUNCTION, out);
-						break;
-					}
-				}
-				/* Access allowed */
-				if (len == 0) {
+				if (!modbus_server_access(serv, adr, cur_size, MB_ACCESS_READ)) {
+					len = modbus_error(fcode, MB_EC_ILLEGAL_FUNCTION, out);
+				} else {
 					/* Response formation */
 					out[MB_OFFSET_FCODE] = fcode;
 					out[MB_OFFSET_OUT_SIZE] = (uint8_t) cur_size;
-					for (i = 0; i < cur_size; i++) {
-						out[i + MB_OFFSET_OUT_START_DATA] = serv->registers[adr + i + ((i % 2 == 0) ? 1 : -1)];
-					}
+					modbus_copy_swap16(&out[MB_OFFSET_OUT_START_DATA], &serv->registers[adr], cur_size);
 					len = cur_size + MB_OFFSET_OUT_START_DATA;
 				}
 			} else {
@@ -109,7 +233,7 @@ uint16_t modbus_abstract_server(struct modbus_server_handle *serv, uint8_t *in,
 		/* Check address */
 		if ((adr + MB_SIZE_REGISTER) <= serv->bytes_size) {
 			/* Check access */
-			if (serv->access[adr] != MB_ACCESS_WRITE && serv->access[adr] != MB_ACCESS_READ_WRITE) {
+			if (!modbus_server_access(serv, adr, MB_SIZE_REGISTER, MB_ACCESS_WRITE)) {
 				len = modbus_error(fcode, MB_EC_ILLEGAL_FUNCTION, out);
 			} else {
 				serv->registers[adr] = in[MB_OFFSET_VALUE_LOW];
@@ -129,17 +253,10 @@ uint16_t modbus_abstract_server(struct modbus_server_handle *serv, uint8_t *in,
 			if (in_len == (cur_size + MB_OFFSET_IN_MULT_REG_START_DATA) && cur_size == in[MB_OFFSET_IN_BYTE_COUNT]) {
 				if ((adr + cur_size) <= serv->bytes_size) {
 					/* Access check */
-					for (i = adr; i < (adr + cur_size); i++) {
-						if (serv->access[i] != MB_ACCESS_WRITE && serv->access[i] != MB_ACCESS_READ_WRITE) {
-							len = modbus_error(fcode, MB_EC_ILLEGAL_FUNCTION, out);
-							break;
-						}
-					}
-					/* Access allowed */
-					if (len == 0) {
-						for (i = 0; i < cur_size; i++) {
-							serv->registers[adr + i] = in[i + MB_OFFSET_IN_MULT_REG_START_DATA + ((i % 2 == 0) ? 1 : -1)];
-						}
+					if (!modbus_server_access(serv, adr, cur_size, MB_ACCESS_WRITE)) {
+						len = modbus_error(fcode, MB_EC_ILLEGAL_FUNCTION, out);
+					} else {
+						modbus_copy_swap16(&serv->registers[adr], &in[MB_OFFSET_IN_MULT_REG_START_DATA], cur_size);
 						/* Response formation */
 						memcpy(out, in, MB_SIZE_WRITE_PACKAGE);
 						len = MB_SIZE_WRITE_PACKAGE;
@@ -265,21 +382,240 @@ int16_t modbus_rtu_server_analyze(uint8_t *in_buf, uint16_t in_buf_len) {
 	return MB_RTU_ERR_INCOMPLETE;
 }
 
+/* Byte order conversion kernels convert the leading part of data and return its size (even),
+ * the rest is converted by byte loops. Kernels of reverse orders read data from the end.
+ * Vector kernels pass the tail to the narrower kernel. */
+typedef uint16_t (*modbus_convert_kernel)(const uint8_t *in, uint8_t *out, uint16_t len);
+
+struct modbus_convert_kernels {
+	modbus_convert_kernel swap16;				/* MB_BO_FORWARD_REGS_REVERSE */
+	modbus_convert_kernel reverse;				/* MB_BO_BACKWARD */
+	modbus_convert_kernel reverse_words;		/* MB_BO_BACKWARD_REGS_REVERSE */
+};
+
+static uint16_t modbus_convert_swap16_scalar(const uint8_t *in, uint8_t *out, uint16_t len) {
+	uint64_t word;
+	uint16_t i;
+	for (i = 0; i + sizeof(word) <= len; i += sizeof(word)) {
+		memcpy(&word, &in[i], sizeof(word));
+		word = ((word & 0x00FF00FF00FF00FFULL) << 8) | ((word >> 8) & 0x00FF00FF00FF00FFULL);
+		memcpy(&out[i], &word, sizeof(word));
+	}
+	return i;
+}
+
+static uint16_t modbus_convert_reverse_words_scalar(const uint8_t *in, uint8_t *out, uint16_t len) {
+	uint64_t word;
+	uint16_t i;
+	for (i = 0; i + sizeof(word) <= len; i += sizeof(word)) {
+		memcpy(&word, &in[len - i - sizeof(word)], sizeof(word));
+		word = (word >> 32) | (word << 32);
+		word = ((word & 0xFFFF0000FFFF0000ULL) >> 16) | ((word & 0x0000FFFF0000FFFFULL) << 16);
+		memcpy(&out[i], &word, sizeof(word));
+	}
+	return i;
+}
+
+static uint16_t modbus_convert_reverse_scalar(const uint8_t *in, uint8_t *out, uint16_t len) {
+	uint64_t word;
+	uint16_t i;
+	for (i = 0; i + sizeof(word) <= len; i += sizeof(word)) {
+		memcpy(&word, &in[len - i - sizeof(word)], sizeof(word));
+		word = (word >> 32) | (word << 32);
+		word = ((word & 0xFFFF0000FFFF0000ULL) >> 16) | ((word & 0x0000FFFF0000FFFFULL) << 16);
+		word = ((word & 0x00FF00FF00FF00FFULL) << 8) | ((word >> 8) & 0x00FF00FF00FF00FFULL);
+		memcpy(&out[i], &word, sizeof(word));
+	}
+	return i;
+}
+
+#if MB_CONVERT_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MB_TARGET_SSSE3
+#define MB_TARGET_AVX2
+#else
+#define MB_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define MB_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/* Shuffle masks (for AVX2 the same mask in both 128-bit lanes) */
+#define MB_MASK_SWAP16 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+#define MB_MASK_REVERSE 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+#define MB_MASK_REVERSE_WORDS 14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1
+
+MB_TARGET_SSSE3 static uint16_t modbus_convert_swap16_ssse3(const uint8_t *in, uint8_t *out, uint16_t len) {
+	const __m128i mask = _mm_setr_epi8(MB_MASK_SWAP16);
+	uint16_t i;
+	for (i = 0; i + 16 <= len; i += 16) {
+		_mm_storeu_si128((__m128i*) &out[i], _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &in[i]), mask));
+	}
+	/* Tail by narrower kernel */
+	return i + modbus_convert_swap16_scalar(&in[i], &out[i], len - i);
+}
+
+MB_TARGET_SSSE3 static uint16_t modbus_convert_reverse_ssse3(const uint8_t *in, uint8_t *out, uint16_t len) {
+	const __m128i mask = _mm_setr_epi8(MB_MASK_REVERSE);
+	uint16_t i;
+	for (i = 0; i + 16 <= len; i += 16) {
+		_mm_storeu_si128((__m128i*) &out[i], _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &in[len - i - 16]), mask));
+	}
+	/* Tail by narrower kernel (reads the data begin) */
+	return i + modbus_convert_reverse_scalar(in, &out[i], len - i);
+}
+
+MB_TARGET_SSSE3 static uint16_t modbus_convert_reverse_words_ssse3(const uint8_t *in, uint8_t *out, uint16_t len) {
+	const __m128i mask = _mm_setr_epi8(MB_MASK_REVERSE_WORDS);
+	uint16_t i;
+	for (i = 0; i + 16 <= len; i += 16) {
+		_mm_storeu_si128((__m128i*) &out[i], _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) &in[len - i - 16]), mask));
+	}
+	/* Tail by narrower kernel (reads the data begin) */
+	return i + modbus_convert_reverse_words_scalar(in, &out[i], len - i);
+}
+
+MB_TARGET_AVX2 static uint16_t modbus_convert_swap16_avx2(const uint8_t *in, uint8_t *out, uint16_t len) {
+	const __m256i mask = _mm256_setr_epi8(MB_MASK_SWAP16, MB_MASK_SWAP16);
+	uint16_t i;
+	for (i = 0; i + 32 <= len; i += 32) {
+		_mm256_storeu_si256((__m256i*) &out[i], _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*) &in[i]), mask));
+	}
+	/* Avoid AVX-SSE transition penalty in the SSSE3 kernel */
+	_mm256_zeroupper();
+	/* Tail by narrower kernel */
+	return i + modbus_convert_swap16_ssse3(&in[i], &out[i], len - i);
+}
+
+/* Lanes are reversed by shuffle, then swapped */
+MB_TARGET_AVX2 static uint16_t modbus_convert_reverse_avx2(const uint8_t *in, uint8_t *out, uint16_t len) {
+	const __m256i mask = _mm256_setr_epi8(MB_MASK_REVERSE, MB_MASK_REVERSE);
+	__m256i data;
+	uint16_t i;
+	for (i = 0; i + 32 <= len; i += 32) {
+		data = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*) &in[len - i - 32]), mask);
+		_mm256_storeu_si256((__m256i*) &out[i], _mm256_permute4x64_epi64(data, 0x4E));
+	}
+	/* Avoid AVX-SSE transition penalty in the SSSE3 kernel */
+	_mm256_zeroupper();
+	/* Tail by narrower kernel (reads the data begin) */
+	return i + modbus_convert_reverse_ssse3(in, &out[i], len - i);
+}
+
+MB_TARGET_AVX2 static uint16_t modbus_convert_reverse_words_avx2(const uint8_t *in, uint8_t *out, uint16_t len) {
+	const __m256i mask = _mm256_setr_epi8(MB_MASK_REVERSE_WORDS, MB_MASK_REVERSE_WORDS);
+	__m256i data;
+	uint16_t i;
+	for (i = 0; i + 32 <= len; i += 32) {
+		data = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*) &in[len - i - 32]), mask);
+		_mm256_storeu_si256((__m256i*) &out[i], _mm256_permute4x64_epi64(data, 0x4E));
+	}
+	/* Avoid AVX-SSE transition penalty in the SSSE3 kernel */
+	_mm256_zeroupper();
+	/* Tail by narrower kernel (reads the data begin) */
+	return i + modbus_convert_reverse_words_ssse3(in, &out[i], len - i);
+}
+
+/* Best engine supported by CPU and OS */
+static uint8_t modbus_convert_detect(void) {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 1) {
+		return MB_CONVERT_SCALAR;
+	}
+	__cpuid(info, 1);
+	/* SSSE3 */
+	if (!(info[2] & (1 << 9))) {
+		return MB_CONVERT_SCALAR;
+	}
+	/* AVX, OSXSAVE and YMM state enabled by OS */
+	if ((info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6) {
+		__cpuid(info, 0);
+		if (info[0] >= 7) {
+			__cpuidex(info, 7, 0);
+			if (info[1] & (1 << 5)) {
+				return MB_CONVERT_AVX2;
+			}
+		}
+	}
+	return MB_CONVERT_SSSE3;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return MB_CONVERT_AVX2;
+	} else if (__builtin_cpu_supports("ssse3")) {
+		return MB_CONVERT_SSSE3;
+	}
+	return MB_CONVERT_SCALAR;
+#endif
+}
+#endif
+
+static const struct modbus_convert_kernels mb_convert_kernels[] = {
+	{modbus_convert_swap16_scalar, modbus_convert_reverse_scalar, modbus_convert_reverse_words_scalar},
+#if MB_CONVERT_SIMD
+	{modbus_convert_swap16_ssse3, modbus_convert_reverse_ssse3, modbus_convert_reverse_words_ssse3},
+	{modbus_convert_swap16_avx2, modbus_convert_reverse_avx2, modbus_convert_reverse_words_avx2}
+#endif
+};
+
+/* Selected engine (0xFF - not detected yet, detection result is the same for all threads) */
+static uint8_t mb_convert_engine = 0xFF;
+static uint8_t mb_convert_engine_max = 0xFF;
+
+uint8_t modbus_convert_engine(void) {
+	if (mb_convert_engine_max == 0xFF) {
+#if MB_CONVERT_SIMD
+		mb_convert_engine_max = modbus_convert_detect();
+#else
+		mb_convert_engine_max = MB_CONVERT_SCALAR;
+#endif
+	}
+	if (mb_convert_engine == 0xFF) {
+		mb_convert_engine = mb_convert_engine_max;
+	}
+	return mb_convert_engine;
+}
+
+uint8_t modbus_convert_set_engine(uint8_t engine) {
+	modbus_convert_engine();
+	if (engine > mb_convert_engine_max) {
+		return 0;
+	}
+	mb_convert_engine = engine;
+	return 1;
+}
+
 void modbus_convert_data(uint8_t *in, uint8_t *out, uint16_t len, uint8_t order) {
+	const struct modbus_convert_kernels *kernels = &mb_convert_kernels[modbus_convert_engine()];
 	uint16_t i;
 	if (order == MB_BO_FORWARD) {
 		memcpy(out, in, len);
 	} else if (order == MB_BO_BACKWARD) {
-		for (i = 0; i < len; i++) {
+		for (i = kernels->reverse(in, out, len); i < len; i++) {
 			out[i] = in[len - i - 1];
 		}
+	} else if (len % 2 != 0) {
+		/* Odd size, byte loops only */
+		if (order == MB_BO_FORWARD_REGS_REVERSE) {
+			for (i = 0; i < len; i++) {
+				out[i] = ((i % 2 == 0)?in[i + 1]:in[i - 1]);
+			}
+		} else if (order == MB_BO_BACKWARD_REGS_REVERSE) {
+			for (i = 0; i < len; i++) {
+				out[i] = ((i % 2 == 0)?in[len - i - 2]:in[len - i]);
+			}
+		}
 	} else if (order == MB_BO_FORWARD_REGS_REVERSE) {
-		for (i = 0; i < len; i++) {
-			out[i] = ((i % 2 == 0)?in[i + 1]:in[i - 1]);
+		for (i = kernels->swap16(in, out, len); i < len; i += 2) {
+			out[i] = in[i + 1];
+			out[i + 1] = in[i];
 		}
 	} else if (order == MB_BO_BACKWARD_REGS_REVERSE) {
-		for (i = 0; i < len; i++) {
-			out[i] = ((i % 2 == 0)?in[len - i - 2]:in[len - i]);
+		for (i = kernels->reverse_words(in, out, len); i < len; i += 2) {
+			out[i] = in[len - i - 2];
+			out[i + 1] = in[len - i - 1];
 		}
 	}
 }
@@ -315,6 +651,12 @@ struct modbus_client_parameter* modbus_client_param_create(uint8_t device_adr, u
 	param->func_size = func_size;
 	param->type = type;
 	param->value = NULL;
+	param->period = 0;
+	param->deadline = 0;
+	param->priority = 0;
+	param->scheduled = 0;
+	param->in_flight = 0;
+	param->polled = 0;
 	if (modbus_client_calc_param_size(param) == 0) {
 		free(param);
 		return NULL;
@@ -328,6 +670,11 @@ void modbus_client_param_destroy(struct modbus_client_parameter* param) {
 	free(param);
 }
 
+static void modbus_health_reset(struct modbus_client_health *health) {
+	memset(health->devices, 0, sizeof(health->devices));
+	health->quarantined = 0;
+}
+
 struct modbus_rtu_client_handle* modbus_client_rtu_create() {
 	struct modbus_rtu_client_handle *client;
 	if ((client = (struct modbus_rtu_client_handle*) malloc(sizeof(struct modbus_rtu_client_handle))) == NULL) {
@@ -340,10 +687,20 @@ struct modbus_rtu_client_handle* modbus_client_rtu_create() {
 	
 	client->param_counter = 0;
 	client->counter = 0;
+	client->sequence = 0;
+	client->sched.heap = NULL;
+	client->sched.size = 0;
+	client->sched.capacity = 0;
+	client->sched.count = 0;
+	client->health.threshold = 0;
+	client->health.backoff_min = 0;
+	client->health.backoff_max = 0;
+	modbus_health_reset(&client->health);
 	return client;
 }
 
 void modbus_client_rtu_destroy(struct modbus_rtu_client_handle *client) {
+	free(client->sched.heap);
 	utils_vect_destroy(client->params);
 	free(client);
 }
@@ -352,6 +709,9 @@ void modbus_client_rtu_reset(struct modbus_rtu_client_handle *client) {
 	struct modbus_client_parameter *cur_param;
 	client->param_counter = 0;
 	client->counter = 0;
+	client->sequence = 0;
+	client->sched.size = 0;
+	client->sched.count = 0;
 	for (uint32_t i = 0; i < utils_vect_size(client->params); i++) {
 		cur_param = (struct modbus_client_parameter*)(utils_vect_get(client->params, i));
 		if (cur_param->function_code != MB_FC_WRITE_SINGLE_COIL
@@ -362,11 +722,21 @@ void modbus_client_rtu_reset(struct modbus_rtu_client_handle *client) {
 			memset(cur_param->value, 0, cur_param->size);
 		}
 		cur_param->err = MB_EC_NO_ERR;
+		cur_param->scheduled = 0;
+		cur_param->in_flight = 0;
+		cur_param->polled = 0;
 	}
+	modbus_health_reset(&client->health);
+}
+
+void modbus_client_rtu_params_changed(struct modbus_rtu_client_handle *client) {
+	client->sched.size = 0;
+	client->sched.count = 0;
 }
 
 struct modbus_tcp_client_handle* modbus_client_tcp_create() {
 	struct modbus_tcp_client_handle *client;
+	uint8_t i;
 	if ((client = (struct modbus_tcp_client_handle*) malloc(sizeof(struct modbus_tcp_client_handle))) == NULL) {
 		return NULL;
 	}
@@ -377,20 +747,38 @@ struct modbus_tcp_client_handle* modbus_client_tcp_create() {
 
 	client->param_counter = 0;
 	client->counter = 0;
+	client->sequence = 0;
 	client->transaction_id = 0;
+	for (i = 0; i < MB_TCP_MAX_LANES; i++) {
+		client->sched[i].heap = NULL;
+		client->sched[i].size = 0;
+		client->sched[i].capacity = 0;
+		client->sched[i].count = 0;
+	}
+	client->lanes = 1;
 	return client;
 }
 
 void modbus_client_tcp_destroy(struct modbus_tcp_client_handle *client) {
+	uint8_t i;
+	for (i = 0; i < MB_TCP_MAX_LANES; i++) {
+		free(client->sched[i].heap);
+	}
 	utils_vect_destroy(client->params);
 	free(client);
 }
 
 void modbus_client_tcp_reset(struct modbus_tcp_client_handle *client) {
 	struct modbus_client_parameter *cur_param;
+	uint8_t i;
 	client->param_counter = 0;
 	client->counter = 0;
+	client->sequence = 0;
 	client->transaction_id = 0;
+	for (i = 0; i < MB_TCP_MAX_LANES; i++) {
+		client->sched[i].size = 0;
+		client->sched[i].count = 0;
+	}
 	for (uint32_t i = 0; i < utils_vect_size(client->params); i++) {
 		cur_param = (struct modbus_client_parameter*)(utils_vect_get(client->params, i));
 		if (cur_param->function_code != MB_FC_WRITE_SINGLE_COIL
@@ -401,51 +789,328 @@ void modbus_client_tcp_reset(struct modbus_tcp_client_handle *client) {
 			memset(cur_param->value, 0, cur_param->size);
 		}
 		cur_param->err = MB_EC_NO_ERR;
+		cur_param->scheduled = 0;
+		cur_param->in_flight = 0;
+		cur_param->polled = 0;
 	}
 }
 
+void modbus_client_tcp_params_changed(struct modbus_tcp_client_handle *client) {
+	uint8_t i;
+	for (i = 0; i < MB_TCP_MAX_LANES; i++) {
+		client->sched[i].size = 0;
+		client->sched[i].count = 0;
+	}
+}
+
+/* CRC16 (polynom 0xA001) lookup tables, row N is the checksum of a byte followed by N zero bytes */
+static const uint16_t mb_crc16_table[MB_CRC16_SLICE][256] = {
+	{
+		0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+		0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+		0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+		0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+		0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+		0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+		0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+		0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+		0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+		0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+		0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+		0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+		0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+		0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+		0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+		0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+		0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+		0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+		0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+		0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+		0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+		0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+		0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+		0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+		0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+		0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+		0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+		0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+		0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+		0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+		0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+		0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+	},
+#if MB_CRC16_SLICE >= 4
+	{
+		0x0000, 0x9001, 0x6001, 0xF000, 0xC002, 0x5003, 0xA003, 0x3002,
+		0xC007, 0x5006, 0xA006, 0x3007, 0x0005, 0x9004, 0x6004, 0xF005,
+		0xC00D, 0x500C, 0xA00C, 0x300D, 0x000F, 0x900E, 0x600E, 0xF00F,
+		0x000A, 0x900B, 0x600B, 0xF00A, 0xC008, 0x5009, 0xA009, 0x3008,
+		0xC019, 0x5018, 0xA018, 0x3019, 0x001B, 0x901A, 0x601A, 0xF01B,
+		0x001E, 0x901F, 0x601F, 0xF01E, 0xC01C, 0x501D, 0xA01D, 0x301C,
+		0x0014, 0x9015, 0x6015, 0xF014, 0xC016, 0x5017, 0xA017, 0x3016,
+		0xC013, 0x5012, 0xA012, 0x3013, 0x0011, 0x9010, 0x6010, 0xF011,
+		0xC031, 0x5030, 0xA030, 0x3031, 0x0033, 0x9032, 0x6032, 0xF033,
+		0x0036, 0x9037, 0x6037, 0xF036, 0xC034, 0x5035, 0xA035, 0x3034,
+		0x003C, 0x903D, 0x603D, 0xF03C, 0xC03E, 0x503F, 0xA03F, 0x303E,
+		0xC03B, 0x503A, 0xA03A, 0x303B, 0x0039, 0x9038, 0x6038, 0xF039,
+		0x0028, 0x9029, 0x6029, 0xF028, 0xC02A, 0x502B, 0xA02B, 0x302A,
+		0xC02F, 0x502E, 0xA02E, 0x302F, 0x002D, 0x902C, 0x602C, 0xF02D,
+		0xC025, 0x5024, 0xA024, 0x3025, 0x0027, 0x9026, 0x6026, 0xF027,
+		0x0022, 0x9023, 0x6023, 0xF022, 0xC020, 0x5021, 0xA021, 0x3020,
+		0xC061, 0x5060, 0xA060, 0x3061, 0x0063, 0x9062, 0x6062, 0xF063,
+		0x0066, 0x9067, 0x6067, 0xF066, 0xC064, 0x5065, 0xA065, 0x3064,
+		0x006C, 0x906D, 0x606D, 0xF06C, 0xC06E, 0x506F, 0xA06F, 0x306E,
+		0xC06B, 0x506A, 0xA06A, 0x306B, 0x0069, 0x9068, 0x6068, 0xF069,
+		0x0078, 0x9079, 0x6079, 0xF078, 0xC07A, 0x507B, 0xA07B, 0x307A,
+		0xC07F, 0x507E, 0xA07E, 0x307F, 0x007D, 0x907C, 0x607C, 0xF07D,
+		0xC075, 0x5074, 0xA074, 0x3075, 0x0077, 0x9076, 0x6076, 0xF077,
+		0x0072, 0x9073, 0x6073, 0xF072, 0xC070, 0x5071, 0xA071, 0x3070,
+		0x0050, 0x9051, 0x6051, 0xF050, 0xC052, 0x5053, 0xA053, 0x3052,
+		0xC057, 0x5056, 0xA056, 0x3057, 0x0055, 0x9054, 0x6054, 0xF055,
+		0xC05D, 0x505C, 0xA05C, 0x305D, 0x005F, 0x905E, 0x605E, 0xF05F,
+		0x005A, 0x905B, 0x605B, 0xF05A, 0xC058, 0x5059, 0xA059, 0x3058,
+		0xC049, 0x5048, 0xA048, 0x3049, 0x004B, 0x904A, 0x604A, 0xF04B,
+		0x004E, 0x904F, 0x604F, 0xF04E, 0xC04C, 0x504D, 0xA04D, 0x304C,
+		0x0044, 0x9045, 0x6045, 0xF044, 0xC046, 0x5047, 0xA047, 0x3046,
+		0xC043, 0x5042, 0xA042, 0x3043, 0x0041, 0x9040, 0x6040, 0xF041
+	},
+	{
+		0x0000, 0xC051, 0xC0A1, 0x00F0, 0xC141, 0x0110, 0x01E0, 0xC1B1,
+		0xC281, 0x02D0, 0x0220, 0xC271, 0x03C0, 0xC391, 0xC361, 0x0330,
+		0xC501, 0x0550, 0x05A0, 0xC5F1, 0x0440, 0xC411, 0xC4E1, 0x04B0,
+		0x0780, 0xC7D1, 0xC721, 0x0770, 0xC6C1, 0x0690, 0x0660, 0xC631,
+		0xCA01, 0x0A50, 0x0AA0, 0xCAF1, 0x0B40, 0xCB11, 0xCBE1, 0x0BB0,
+		0x0880, 0xC8D1, 0xC821, 0x0870, 0xC9C1, 0x0990, 0x0960, 0xC931,
+		0x0F00, 0xCF51, 0xCFA1, 0x0FF0, 0xCE41, 0x0E10, 0x0EE0, 0xCEB1,
+		0xCD81, 0x0DD0, 0x0D20, 0xCD71, 0x0CC0, 0xCC91, 0xCC61, 0x0C30,
+		0xD401, 0x1450, 0x14A0, 0xD4F1, 0x1540, 0xD511, 0xD5E1, 0x15B0,
+		0x1680, 0xD6D1, 0xD621, 0x1670, 0xD7C1, 0x1790, 0x1760, 0xD731,
+		0x1100, 0xD151, 0xD1A1, 0x11F0, 0xD041, 0x1010, 0x10E0, 0xD0B1,
+		0xD381, 0x13D0, 0x1320, 0xD371, 0x12C0, 0xD291, 0xD261, 0x1230,
+		0x1E00, 0xDE51, 0xDEA1, 0x1EF0, 0xDF41, 0x1F10, 0x1FE0, 0xDFB1,
+		0xDC81, 0x1CD0, 0x1C20, 0xDC71, 0x1DC0, 0xDD91, 0xDD61, 0x1D30,
+		0xDB01, 0x1B50, 0x1BA0, 0xDBF1, 0x1A40, 0xDA11, 0xDAE1, 0x1AB0,
+		0x1980, 0xD9D1, 0xD921, 0x1970, 0xD8C1, 0x1890, 0x1860, 0xD831,
+		0xE801, 0x2850, 0x28A0, 0xE8F1, 0x2940, 0xE911, 0xE9E1, 0x29B0,
+		0x2A80, 0xEAD1, 0xEA21, 0x2A70, 0xEBC1, 0x2B90, 0x2B60, 0xEB31,
+		0x2D00, 0xED51, 0xEDA1, 0x2DF0, 0xEC41, 0x2C10, 0x2CE0, 0xECB1,
+		0xEF81, 0x2FD0, 0x2F20, 0xEF71, 0x2EC0, 0xEE91, 0xEE61, 0x2E30,
+		0x2200, 0xE251, 0xE2A1, 0x22F0, 0xE341, 0x2310, 0x23E0, 0xE3B1,
+		0xE081, 0x20D0, 0x2020, 0xE071, 0x21C0, 0xE191, 0xE161, 0x2130,
+		0xE701, 0x2750, 0x27A0, 0xE7F1, 0x2640, 0xE611, 0xE6E1, 0x26B0,
+		0x2580, 0xE5D1, 0xE521, 0x2570, 0xE4C1, 0x2490, 0x2460, 0xE431,
+		0x3C00, 0xFC51, 0xFCA1, 0x3CF0, 0xFD41, 0x3D10, 0x3DE0, 0xFDB1,
+		0xFE81, 0x3ED0, 0x3E20, 0xFE71, 0x3FC0, 0xFF91, 0xFF61, 0x3F30,
+		0xF901, 0x3950, 0x39A0, 0xF9F1, 0x3840, 0xF811, 0xF8E1, 0x38B0,
+		0x3B80, 0xFBD1, 0xFB21, 0x3B70, 0xFAC1, 0x3A90, 0x3A60, 0xFA31,
+		0xF601, 0x3650, 0x36A0, 0xF6F1, 0x3740, 0xF711, 0xF7E1, 0x37B0,
+		0x3480, 0xF4D1, 0xF421, 0x3470, 0xF5C1, 0x3590, 0x3560, 0xF531,
+		0x3300, 0xF351, 0xF3A1, 0x33F0, 0xF241, 0x3210, 0x32E0, 0xF2B1,
+		0xF181, 0x31D0, 0x3120, 0xF171, 0x30C0, 0xF091, 0xF061, 0x3030
+	},
+	{
+		0x0000, 0xFC01, 0xB801, 0x4400, 0x3001, 0xCC00, 0x8800, 0x7401,
+		0x6002, 0x9C03, 0xD803, 0x2402, 0x5003, 0xAC02, 0xE802, 0x1403,
+		0xC004, 0x3C05, 0x7805, 0x8404, 0xF005, 0x0C04, 0x4804, 0xB405,
+		0xA006, 0x5C07, 0x1807, 0xE406, 0x9007, 0x6C06, 0x2806, 0xD407,
+		0xC00B, 0x3C0A, 0x780A, 0x840B, 0xF00A, 0x0C0B, 0x480B, 0xB40A,
+		0xA009, 0x5C08, 0x1808, 0xE409, 0x9008, 0x6C09, 0x2809, 0xD408,
+		0x000F, 0xFC0E, 0xB80E, 0x440F, 0x300E, 0xCC0F, 0x880F, 0x740E,
+		0x600D, 0x9C0C, 0xD80C, 0x240D, 0x500C, 0xAC0D, 0xE80D, 0x140C,
+		0xC015, 0x3C14, 0x7814, 0x8415, 0xF014, 0x0C15, 0x4815, 0xB414,
+		0xA017, 0x5C16, 0x1816, 0xE417, 0x9016, 0x6C17, 0x2817, 0xD416,
+		0x0011, 0xFC10, 0xB810, 0x4411, 0x3010, 0xCC11, 0x8811, 0x7410,
+		0x6013, 0x9C12, 0xD812, 0x2413, 0x5012, 0xAC13, 0xE813, 0x1412,
+		0x001E, 0xFC1F, 0xB81F, 0x441E, 0x301F, 0xCC1E, 0x881E, 0x741F,
+		0x601C, 0x9C1D, 0xD81D, 0x241C, 0x501D, 0xAC1C, 0xE81C, 0x141D,
+		0xC01A, 0x3C1B, 0x781B, 0x841A, 0xF01B, 0x0C1A, 0x481A, 0xB41B,
+		0xA018, 0x5C19, 0x1819, 0xE418, 0x9019, 0x6C18, 0x2818, 0xD419,
+		0xC029, 0x3C28, 0x7828, 0x8429, 0xF028, 0x0C29, 0x4829, 0xB428,
+		0xA02B, 0x5C2A, 0x182A, 0xE42B, 0x902A, 0x6C2B, 0x282B, 0xD42A,
+		0x002D, 0xFC2C, 0xB82C, 0x442D, 0x302C, 0xCC2D, 0x882D, 0x742C,
+		0x602F, 0x9C2E, 0xD82E, 0x242F, 0x502E, 0xAC2F, 0xE82F, 0x142E,
+		0x0022, 0xFC23, 0xB823, 0x4422, 0x3023, 0xCC22, 0x8822, 0x7423,
+		0x6020, 0x9C21, 0xD821, 0x2420, 0x5021, 0xAC20, 0xE820, 0x1421,
+		0xC026, 0x3C27, 0x7827, 0x8426, 0xF027, 0x0C26, 0x4826, 0xB427,
+		0xA024, 0x5C25, 0x1825, 0xE424, 0x9025, 0x6C24, 0x2824, 0xD425,
+		0x003C, 0xFC3D, 0xB83D, 0x443C, 0x303D, 0xCC3C, 0x883C, 0x743D,
+		0x603E, 0x9C3F, 0xD83F, 0x243E, 0x503F, 0xAC3E, 0xE83E, 0x143F,
+		0xC038, 0x3C39, 0x7839, 0x8438, 0xF039, 0x0C38, 0x4838, 0xB439,
+		0xA03A, 0x5C3B, 0x183B, 0xE43A, 0x903B, 0x6C3A, 0x283A, 0xD43B,
+		0xC037, 0x3C36, 0x7836, 0x8437, 0xF036, 0x0C37, 0x4837, 0xB436,
+		0xA035, 0x5C34, 0x1834, 0xE435, 0x9034, 0x6C35, 0x2835, 0xD434,
+		0x0033, 0xFC32, 0xB832, 0x4433, 0x3032, 0xCC33, 0x8833, 0x7432,
+		0x6031, 0x9C30, 0xD830, 0x2431, 0x5030, 0xAC31, 0xE831, 0x1430
+	},
+#endif
+#if MB_CRC16_SLICE >= 8
+	{
+		0x0000, 0xC03D, 0xC079, 0x0044, 0xC0F1, 0x00CC, 0x0088, 0xC0B5,
+		0xC1E1, 0x01DC, 0x0198, 0xC1A5, 0x0110, 0xC12D, 0xC169, 0x0154,
+		0xC3C1, 0x03FC, 0x03B8, 0xC385, 0x0330, 0xC30D, 0xC349, 0x0374,
+		0x0220, 0xC21D, 0xC259, 0x0264, 0xC2D1, 0x02EC, 0x02A8, 0xC295,
+		0xC781, 0x07BC, 0x07F8, 0xC7C5, 0x0770, 0xC74D, 0xC709, 0x0734,
+		0x0660, 0xC65D, 0xC619, 0x0624, 0xC691, 0x06AC, 0x06E8, 0xC6D5,
+		0x0440, 0xC47D, 0xC439, 0x0404, 0xC4B1, 0x048C, 0x04C8, 0xC4F5,
+		0xC5A1, 0x059C, 0x05D8, 0xC5E5, 0x0550, 0xC56D, 0xC529, 0x0514,
+		0xCF01, 0x0F3C, 0x0F78, 0xCF45, 0x0FF0, 0xCFCD, 0xCF89, 0x0FB4,
+		0x0EE0, 0xCEDD, 0xCE99, 0x0EA4, 0xCE11, 0x0E2C, 0x0E68, 0xCE55,
+		0x0CC0, 0xCCFD, 0xCCB9, 0x0C84, 0xCC31, 0x0C0C, 0x0C48, 0xCC75,
+		0xCD21, 0x0D1C, 0x0D58, 0xCD65, 0x0DD0, 0xCDED, 0xCDA9, 0x0D94,
+		0x0880, 0xC8BD, 0xC8F9, 0x08C4, 0xC871, 0x084C, 0x0808, 0xC835,
+		0xC961, 0x095C, 0x0918, 0xC925, 0x0990, 0xC9AD, 0xC9E9, 0x09D4,
+		0xCB41, 0x0B7C, 0x0B38, 0xCB05, 0x0BB0, 0xCB8D, 0xCBC9, 0x0BF4,
+		0x0AA0, 0xCA9D, 0xCAD9, 0x0AE4, 0xCA51, 0x0A6C, 0x0A28, 0xCA15,
+		0xDE01, 0x1E3C, 0x1E78, 0xDE45, 0x1EF0, 0xDECD, 0xDE89, 0x1EB4,
+		0x1FE0, 0xDFDD, 0xDF99, 0x1FA4, 0xDF11, 0x1F2C, 0x1F68, 0xDF55,
+		0x1DC0, 0xDDFD, 0xDDB9, 0x1D84, 0xDD31, 0x1D0C, 0x1D48, 0xDD75,
+		0xDC21, 0x1C1C, 0x1C58, 0xDC65, 0x1CD0, 0xDCED, 0xDCA9, 0x1C94,
+		0x1980, 0xD9BD, 0xD9F9, 0x19C4, 0xD971, 0x194C, 0x1908, 0xD935,
+		0xD861, 0x185C, 0x1818, 0xD825, 0x1890, 0xD8AD, 0xD8E9, 0x18D4,
+		0xDA41, 0x1A7C, 0x1A38, 0xDA05, 0x1AB0, 0xDA8D, 0xDAC9, 0x1AF4,
+		0x1BA0, 0xDB9D, 0xDBD9, 0x1BE4, 0xDB51, 0x1B6C, 0x1B28, 0xDB15,
+		0x1100, 0xD13D, 0xD179, 0x1144, 0xD1F1, 0x11CC, 0x1188, 0xD1B5,
+		0xD0E1, 0x10DC, 0x1098, 0xD0A5, 0x1010, 0xD02D, 0xD069, 0x1054,
+		0xD2C1, 0x12FC, 0x12B8, 0xD285, 0x1230, 0xD20D, 0xD249, 0x1274,
+		0x1320, 0xD31D, 0xD359, 0x1364, 0xD3D1, 0x13EC, 0x13A8, 0xD395,
+		0xD681, 0x16BC, 0x16F8, 0xD6C5, 0x1670, 0xD64D, 0xD609, 0x1634,
+		0x1760, 0xD75D, 0xD719, 0x1724, 0xD791, 0x17AC, 0x17E8, 0xD7D5,
+		0x1540, 0xD57D, 0xD539, 0x1504, 0xD5B1, 0x158C, 0x15C8, 0xD5F5,
+		0xD4A1, 0x149C, 0x14D8, 0xD4E5, 0x1450, 0xD46D, 0xD429, 0x1414
+	},
+	{
+		0x0000, 0xD101, 0xE201, 0x3300, 0x8401, 0x5500, 0x6600, 0xB701,
+		0x4801, 0x9900, 0xAA00, 0x7B01, 0xCC00, 0x1D01, 0x2E01, 0xFF00,
+		0x9002, 0x4103, 0x7203, 0xA302, 0x1403, 0xC502, 0xF602, 0x2703,
+		0xD803, 0x0902, 0x3A02, 0xEB03, 0x5C02, 0x8D03, 0xBE03, 0x6F02,
+		0x6007, 0xB106, 0x8206, 0x5307, 0xE406, 0x3507, 0x0607, 0xD706,
+		0x2806, 0xF907, 0xCA07, 0x1B06, 0xAC07, 0x7D06, 0x4E06, 0x9F07,
+		0xF005, 0x2104, 0x1204, 0xC305, 0x7404, 0xA505, 0x9605, 0x4704,
+		0xB804, 0x6905, 0x5A05, 0x8B04, 0x3C05, 0xED04, 0xDE04, 0x0F05,
+		0xC00E, 0x110F, 0x220F, 0xF30E, 0x440F, 0x950E, 0xA60E, 0x770F,
+		0x880F, 0x590E, 0x6A0E, 0xBB0F, 0x0C0E, 0xDD0F, 0xEE0F, 0x3F0E,
+		0x500C, 0x810D, 0xB20D, 0x630C, 0xD40D, 0x050C, 0x360C, 0xE70D,
+		0x180D, 0xC90C, 0xFA0C, 0x2B0D, 0x9C0C, 0x4D0D, 0x7E0D, 0xAF0C,
+		0xA009, 0x7108, 0x4208, 0x9309, 0x2408, 0xF509, 0xC609, 0x1708,
+		0xE808, 0x3909, 0x0A09, 0xDB08, 0x6C09, 0xBD08, 0x8E08, 0x5F09,
+		0x300B, 0xE10A, 0xD20A, 0x030B, 0xB40A, 0x650B, 0x560B, 0x870A,
+		0x780A, 0xA90B, 0x9A0B, 0x4B0A, 0xFC0B, 0x2D0A, 0x1E0A, 0xCF0B,
+		0xC01F, 0x111E, 0x221E, 0xF31F, 0x441E, 0x951F, 0xA61F, 0x771E,
+		0x881E, 0x591F, 0x6A1F, 0xBB1E, 0x0C1F, 0xDD1E, 0xEE1E, 0x3F1F,
+		0x501D, 0x811C, 0xB21C, 0x631D, 0xD41C, 0x051D, 0x361D, 0xE71C,
+		0x181C, 0xC91D, 0xFA1D, 0x2B1C, 0x9C1D, 0x4D1C, 0x7E1C, 0xAF1D,
+		0xA018, 0x7119, 0x4219, 0x9318, 0x2419, 0xF518, 0xC618, 0x1719,
+		0xE819, 0x3918, 0x0A18, 0xDB19, 0x6C18, 0xBD19, 0x8E19, 0x5F18,
+		0x301A, 0xE11B, 0xD21B, 0x031A, 0xB41B, 0x651A, 0x561A, 0x871B,
+		0x781B, 0xA91A, 0x9A1A, 0x4B1B, 0xFC1A, 0x2D1B, 0x1E1B, 0xCF1A,
+		0x0011, 0xD110, 0xE210, 0x3311, 0x8410, 0x5511, 0x6611, 0xB710,
+		0x4810, 0x9911, 0xAA11, 0x7B10, 0xCC11, 0x1D10, 0x2E10, 0xFF11,
+		0x9013, 0x4112, 0x7212, 0xA313, 0x1412, 0xC513, 0xF613, 0x2712,
+		0xD812, 0x0913, 0x3A13, 0xEB12, 0x5C13, 0x8D12, 0xBE12, 0x6F13,
+		0x6016, 0xB117, 0x8217, 0x5316, 0xE417, 0x3516, 0x0616, 0xD717,
+		0x2817, 0xF916, 0xCA16, 0x1B17, 0xAC16, 0x7D17, 0x4E17, 0x9F16,
+		0xF014, 0x2115, 0x1215, 0xC314, 0x7415, 0xA514, 0x9614, 0x4715,
+		0xB815, 0x6914, 0x5A14, 0x8B15, 0x3C14, 0xED15, 0xDE15, 0x0F14
+	},
+	{
+		0x0000, 0xC010, 0xC023, 0x0033, 0xC045, 0x0055, 0x0066, 0xC076,
+		0xC089, 0x0099, 0x00AA, 0xC0BA, 0x00CC, 0xC0DC, 0xC0EF, 0x00FF,
+		0xC111, 0x0101, 0x0132, 0xC122, 0x0154, 0xC144, 0xC177, 0x0167,
+		0x0198, 0xC188, 0xC1BB, 0x01AB, 0xC1DD, 0x01CD, 0x01FE, 0xC1EE,
+		0xC221, 0x0231, 0x0202, 0xC212, 0x0264, 0xC274, 0xC247, 0x0257,
+		0x02A8, 0xC2B8, 0xC28B, 0x029B, 0xC2ED, 0x02FD, 0x02CE, 0xC2DE,
+		0x0330, 0xC320, 0xC313, 0x0303, 0xC375, 0x0365, 0x0356, 0xC346,
+		0xC3B9, 0x03A9, 0x039A, 0xC38A, 0x03FC, 0xC3EC, 0xC3DF, 0x03CF,
+		0xC441, 0x0451, 0x0462, 0xC472, 0x0404, 0xC414, 0xC427, 0x0437,
+		0x04C8, 0xC4D8, 0xC4EB, 0x04FB, 0xC48D, 0x049D, 0x04AE, 0xC4BE,
+		0x0550, 0xC540, 0xC573, 0x0563, 0xC515, 0x0505, 0x0536, 0xC526,
+		0xC5D9, 0x05C9, 0x05FA, 0xC5EA, 0x059C, 0xC58C, 0xC5BF, 0x05AF,
+		0x0660, 0xC670, 0xC643, 0x0653, 0xC625, 0x0635, 0x0606, 0xC616,
+		0xC6E9, 0x06F9, 0x06CA, 0xC6DA, 0x06AC, 0xC6BC, 0xC68F, 0x069F,
+		0xC771, 0x0761, 0x0752, 0xC742, 0x0734, 0xC724, 0xC717, 0x0707,
+		0x07F8, 0xC7E8, 0xC7DB, 0x07CB, 0xC7BD, 0x07AD, 0x079E, 0xC78E,
+		0xC881, 0x0891, 0x08A2, 0xC8B2, 0x08C4, 0xC8D4, 0xC8E7, 0x08F7,
+		0x0808, 0xC818, 0xC82B, 0x083B, 0xC84D, 0x085D, 0x086E, 0xC87E,
+		0x0990, 0xC980, 0xC9B3, 0x09A3, 0xC9D5, 0x09C5, 0x09F6, 0xC9E6,
+		0xC919, 0x0909, 0x093A, 0xC92A, 0x095C, 0xC94C, 0xC97F, 0x096F,
+		0x0AA0, 0xCAB0, 0xCA83, 0x0A93, 0xCAE5, 0x0AF5, 0x0AC6, 0xCAD6,
+		0xCA29, 0x0A39, 0x0A0A, 0xCA1A, 0x0A6C, 0xCA7C, 0xCA4F, 0x0A5F,
+		0xCBB1, 0x0BA1, 0x0B92, 0xCB82, 0x0BF4, 0xCBE4, 0xCBD7, 0x0BC7,
+		0x0B38, 0xCB28, 0xCB1B, 0x0B0B, 0xCB7D, 0x0B6D, 0x0B5E, 0xCB4E,
+		0x0CC0, 0xCCD0, 0xCCE3, 0x0CF3, 0xCC85, 0x0C95, 0x0CA6, 0xCCB6,
+		0xCC49, 0x0C59, 0x0C6A, 0xCC7A, 0x0C0C, 0xCC1C, 0xCC2F, 0x0C3F,
+		0xCDD1, 0x0DC1, 0x0DF2, 0xCDE2, 0x0D94, 0xCD84, 0xCDB7, 0x0DA7,
+		0x0D58, 0xCD48, 0xCD7B, 0x0D6B, 0xCD1D, 0x0D0D, 0x0D3E, 0xCD2E,
+		0xCEE1, 0x0EF1, 0x0EC2, 0xCED2, 0x0EA4, 0xCEB4, 0xCE87, 0x0E97,
+		0x0E68, 0xCE78, 0xCE4B, 0x0E5B, 0xCE2D, 0x0E3D, 0x0E0E, 0xCE1E,
+		0x0FF0, 0xCFE0, 0xCFD3, 0x0FC3, 0xCFB5, 0x0FA5, 0x0F96, 0xCF86,
+		0xCF79, 0x0F69, 0x0F5A, 0xCF4A, 0x0F3C, 0xCF2C, 0xCF1F, 0x0F0F
+	},
+	{
+		0x0000, 0xCCC1, 0xD981, 0x1540, 0xF301, 0x3FC0, 0x2A80, 0xE641,
+		0xA601, 0x6AC0, 0x7F80, 0xB341, 0x5500, 0x99C1, 0x8C81, 0x4040,
+		0x0C01, 0xC0C0, 0xD580, 0x1941, 0xFF00, 0x33C1, 0x2681, 0xEA40,
+		0xAA00, 0x66C1, 0x7381, 0xBF40, 0x5901, 0x95C0, 0x8080, 0x4C41,
+		0x1802, 0xD4C3, 0xC183, 0x0D42, 0xEB03, 0x27C2, 0x3282, 0xFE43,
+		0xBE03, 0x72C2, 0x6782, 0xAB43, 0x4D02, 0x81C3, 0x9483, 0x5842,
+		0x1403, 0xD8C2, 0xCD82, 0x0143, 0xE702, 0x2BC3, 0x3E83, 0xF242,
+		0xB202, 0x7EC3, 0x6B83, 0xA742, 0x4103, 0x8DC2, 0x9882, 0x5443,
+		0x3004, 0xFCC5, 0xE985, 0x2544, 0xC305, 0x0FC4, 0x1A84, 0xD645,
+		0x9605, 0x5AC4, 0x4F84, 0x8345, 0x6504, 0xA9C5, 0xBC85, 0x7044,
+		0x3C05, 0xF0C4, 0xE584, 0x2945, 0xCF04, 0x03C5, 0x1685, 0xDA44,
+		0x9A04, 0x56C5, 0x4385, 0x8F44, 0x6905, 0xA5C4, 0xB084, 0x7C45,
+		0x2806, 0xE4C7, 0xF187, 0x3D46, 0xDB07, 0x17C6, 0x0286, 0xCE47,
+		0x8E07, 0x42C6, 0x5786, 0x9B47, 0x7D06, 0xB1C7, 0xA487, 0x6846,
+		0x2407, 0xE8C6, 0xFD86, 0x3147, 0xD706, 0x1BC7, 0x0E87, 0xC246,
+		0x8206, 0x4EC7, 0x5B87, 0x9746, 0x7107, 0xBDC6, 0xA886, 0x6447,
+		0x6008, 0xACC9, 0xB989, 0x7548, 0x9309, 0x5FC8, 0x4A88, 0x8649,
+		0xC609, 0x0AC8, 0x1F88, 0xD349, 0x3508, 0xF9C9, 0xEC89, 0x2048,
+		0x6C09, 0xA0C8, 0xB588, 0x7949, 0x9F08, 0x53C9, 0x4689, 0x8A48,
+		0xCA08, 0x06C9, 0x1389, 0xDF48, 0x3909, 0xF5C8, 0xE088, 0x2C49,
+		0x780A, 0xB4CB, 0xA18B, 0x6D4A, 0x8B0B, 0x47CA, 0x528A, 0x9E4B,
+		0xDE0B, 0x12CA, 0x078A, 0xCB4B, 0x2D0A, 0xE1CB, 0xF48B, 0x384A,
+		0x740B, 0xB8CA, 0xAD8A, 0x614B, 0x870A, 0x4BCB, 0x5E8B, 0x924A,
+		0xD20A, 0x1ECB, 0x0B8B, 0xC74A, 0x210B, 0xEDCA, 0xF88A, 0x344B,
+		0x500C, 0x9CCD, 0x898D, 0x454C, 0xA30D, 0x6FCC, 0x7A8C, 0xB64D,
+		0xF60D, 0x3ACC, 0x2F8C, 0xE34D, 0x050C, 0xC9CD, 0xDC8D, 0x104C,
+		0x5C0D, 0x90CC, 0x858C, 0x494D, 0xAF0C, 0x63CD, 0x768D, 0xBA4C,
+		0xFA0C, 0x36CD, 0x238D, 0xEF4C, 0x090D, 0xC5CC, 0xD08C, 0x1C4D,
+		0x480E, 0x84CF, 0x918F, 0x5D4E, 0xBB0F, 0x77CE, 0x628E, 0xAE4F,
+		0xEE0F, 0x22CE, 0x378E, 0xFB4F, 0x1D0E, 0xD1CF, 0xC48F, 0x084E,
+		0x440F, 0x88CE, 0x9D8E, 0x514F, 0xB70E, 0x7BCF, 0x6E8F, 0xA24E,
+		0xE20E, 0x2ECF, 0x3B8F, 0xF74E, 0x110F, 0xDDCE, 0xC88E, 0x044F
+	},
+#endif
+};
+
 uint16_t modbus_crc16(const uint8_t *data, uint16_t length) {
-	static const uint16_t crc_table[] = {
-	0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
-	0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
-	0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
-	0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
-	0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
-	0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
-	0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
-	0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
-	0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
-	0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
-	0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
-	0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
-	0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
-	0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
-	0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
-	0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
-	0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
-	0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
-	0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
-	0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
-	0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
-	0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
-	0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
-	0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
-	0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
-	0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
-	0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
-	0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
-	0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
-	0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
-	0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
-	0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040 };
-
-	uint8_t temp;
 	uint16_t crc_word = 0xFFFF;
 
+#if MB_CRC16_SLICE >= 8
+	/* Slicing-by-8: current checksum is folded into the first two bytes of the block */
+	while (length >= 8) {
+		crc_word ^= (uint16_t) (data[0] | (data[1] << 8));
+		crc_word = mb_crc16_table[7][crc_word & 0xFF] ^ mb_crc16_table[6][crc_word >> 8] ^
+				   mb_crc16_table[5][data[2]] ^ mb_crc16_table[4][data[3]] ^
+				   mb_crc16_table[3][data[4]] ^ mb_crc16_table[2][data[5]] ^
+				   mb_crc16_table[1][data[6]] ^ mb_crc16_table[0][data[7]];
+		data += 8;
+		length -= 8;
+	}
+#endif
+#if MB_CRC16_SLICE >= 4
+	/* Slicing-by-4 */
+	while (length >= 4) {
+		crc_word ^= (uint16_t) (data[0] | (data[1] << 8));
+		crc_word = mb_crc16_table[3][crc_word & 0xFF] ^ mb_crc16_table[2][crc_word >> 8] ^
+				   mb_crc16_table[1][data[2]] ^ mb_crc16_table[0][data[3]];
+		data += 4;
+		length -= 4;
+	}
+#endif
+	/* Byte-wise tail */
 	while (length--) {
-		temp = (uint8_t) (*data++ ^ crc_word);
-		crc_word >>= 8;
-		crc_word ^= crc_table[temp];
+		crc_word = (crc_word >> 8) ^ mb_crc16_table[0][(uint8_t) (*data++ ^ crc_word)];
 	}
 	return crc_word;
 }
@@ -679,33 +1344,283 @@ void modbus_client_tcp_mpab(uint16_t transaction_id, uint8_t *package, uint16_t
 	package[MB_OFFSET_MPAB_UNIT_ID] = unit_id;
 }
 
-void modbus_client_rtu_request(struct modbus_rtu_client_handle *client, uint8_t *out_buf, uint16_t *out_buf_len) {
+/* Parameter a is polled before b: earlier deadline, then higher priority, then least recently polled, then lower index */
+static uint8_t modbus_sched_before(struct utils_vect_handle *params, uint16_t a, uint16_t b) {
+	const struct modbus_client_parameter *pa = (const struct modbus_client_parameter*)(utils_vect_get(params, a));
+	const struct modbus_client_parameter *pb = (const struct modbus_client_parameter*)(utils_vect_get(params, b));
+	int32_t diff = (int32_t) (pa->deadline - pb->deadline);
+	if (diff != 0) {
+		return diff < 0;
+	}
+	if (pa->priority != pb->priority) {
+		return pa->priority > pb->priority;
+	}
+	/* Parameters due as often as possible (the same ms) are polled in turn */
+	diff = (int32_t) (pa->polled - pb->polled);
+	if (diff != 0) {
+		return diff < 0;
+	}
+	return a < b;
+}
+
+static void modbus_sched_sift_down(struct modbus_client_scheduler *sched, struct utils_vect_handle *params, uint16_t pos) {
+	uint16_t child, tmp;
+	while ((child = (uint16_t) (pos * 2 + 1)) < sched->size) {
+		if (child + 1 < sched->size && modbus_sched_before(params, sched->heap[child + 1], sched->heap[child])) {
+			child++;
+		}
+		if (!modbus_sched_before(params, sched->heap[child], sched->heap[pos])) {
+			break;
+		}
+		tmp = sched->heap[pos];
+		sched->heap[pos] = sched->heap[child];
+		sched->heap[child] = tmp;
+		pos = child;
+	}
+}
+
+static void modbus_sched_sift_up(struct modbus_client_scheduler *sched, struct utils_vect_handle *params, uint16_t pos) {
+	uint16_t parent, tmp;
+	while (pos > 0) {
+		parent = (uint16_t) ((pos - 1) / 2);
+		if (!modbus_sched_before(params, sched->heap[pos], sched->heap[parent])) {
+			break;
+		}
+		tmp = sched->heap[pos];
+		sched->heap[pos] = sched->heap[parent];
+		sched->heap[parent] = tmp;
+		pos = parent;
+	}
+}
+
+/* All parameters of the lane are due now */
+static uint8_t modbus_sched_build(struct modbus_client_scheduler *sched, struct utils_vect_handle *params, uint32_t now, uint8_t lane, uint8_t lanes) {
+	struct modbus_client_parameter *param;
+	uint16_t *heap;
+	uint16_t i, count = (uint16_t) utils_vect_size(params);
+	if (count > sched->capacity) {
+		if ((heap = (uint16_t*) realloc(sched->heap, count * sizeof(uint16_t))) == NULL) {
+			return 0;
+		}
+		sched->heap = heap;
+		sched->capacity = count;
+	}
+	sched->size = 0;
+	for (i = 0; i < count; i++) {
+		param = (struct modbus_client_parameter*)(utils_vect_get(params, i));
+		if (lanes > 1 && param->device_adr % lanes != lane) {
+			continue;
+		}
+		sched->heap[sched->size++] = i;
+		/* New parameter is due now, as well as kept one waiting longer than its (possibly shortened) period */
+		if (!param->scheduled || (int32_t) (param->deadline - now) > (int32_t) param->period) {
+			param->deadline = now;
+			param->scheduled = 1;
+		}
+	}
+	sched->count = count;
+	for (i = sched->size / 2; i > 0; i--) {
+		modbus_sched_sift_down(sched, params, (uint16_t) (i - 1));
+	}
+	return 1;
+}
+
+/* Parameters of restored device are due now */
+static void modbus_sched_restore(struct modbus_client_scheduler *sched, struct utils_vect_handle *params, uint8_t device_adr, uint32_t now) {
+	struct modbus_client_parameter *param;
+	uint16_t i;
+	for (i = 0; i < sched->size; i++) {
+		param = (struct modbus_client_parameter*)(utils_vect_get(params, sched->heap[i]));
+		if (param->device_adr == device_adr && (int32_t) (param->deadline - now) > 0) {
+			param->deadline = now;
+		}
+	}
+	for (i = sched->size / 2; i > 0; i--) {
+		modbus_sched_sift_down(sched, params, (uint16_t) (i - 1));
+	}
+}
+
+/* Parameter of quarantined device is polled as the probe only */
+static uint8_t modbus_health_admit(struct modbus_client_health *health, const struct modbus_client_parameter *param, uint32_t now) {
+	struct modbus_device_health *dev = &health->devices[param->device_adr];
+	if (!dev->quarantined) {
+		return 1;
+	}
+	if ((int32_t) (now - dev->probe_at) < 0) {
+		return 0;
+	}
+	/* Other parameters of the device wait for the probe result */
+	dev->probe_at = now + dev->backoff;
+	return 1;
+}
+
+static int32_t modbus_sched_next(struct modbus_client_scheduler *sched, struct utils_vect_handle *params, uint32_t *sequence, uint32_t now, struct modbus_client_health *health, uint8_t lane, uint8_t lanes) {
+	struct modbus_client_parameter *param;
+	uint16_t index, stashed = 0;
+	int32_t result;
+	if ((sched->count == 0 || sched->count != utils_vect_size(params)) && !modbus_sched_build(sched, params, now, lane, lanes)) {
+		return MB_SCHED_IDLE;
+	}
+	if (sched->size == 0) {
+		return MB_SCHED_IDLE;
+	}
+	for (;;) {
+		if (sched->size == 0) {
+			result = MB_SCHED_IDLE;
+			break;
+		}
+		index = sched->heap[0];
+		param = (struct modbus_client_parameter*)(utils_vect_get(params, index));
+		if (param->in_flight) {
+			/* Set aside keeping its deadline, the next due parameter is polled instead */
+			sched->heap[0] = sched->heap[sched->size - 1];
+			sched->heap[sched->size - 1] = index;
+			sched->size--;
+			stashed++;
+			modbus_sched_sift_down(sched, params, 0);
+			continue;
+		}
+		if ((int32_t) (param->deadline - now) > 0) {
+			result = MB_SCHED_IDLE;
+			break;
+		}
+		if (health == NULL || health->quarantined == 0 || modbus_health_admit(health, param, now)) {
+			/* Next deadline, without catching up missed periods */
+			param->deadline += param->period;
+			if ((int32_t) (param->deadline - now) < 0) {
+				param->deadline = now;
+			}
+			param->polled = ++(*sequence);
+			modbus_sched_sift_down(sched, params, 0);
+			result = index;
+			break;
+		}
+		/* Postponed until the next probe of the device */
+		param->deadline = health->devices[param->device_adr].probe_at;
+		modbus_sched_sift_down(sched, params, 0);
+	}
+	/* In-flight parameters are kept after the heap end */
+	while (stashed-- > 0) {
+		modbus_sched_sift_up(sched, params, sched->size++);
+	}
+	return result;
+}
+
+int32_t modbus_client_rtu_next(struct modbus_rtu_client_handle *client, uint32_t now) {
+	int32_t index = modbus_sched_next(&client->sched, client->params, &client->sequence, now, &client->health, 0, 1);
+	if (index != MB_SCHED_IDLE) {
+		client->param_counter = (uint16_t) (index + 1);
+	}
+	return index;
+}
+
+void modbus_client_rtu_health_setup(struct modbus_rtu_client_handle *client, uint8_t threshold, uint32_t backoff_min, uint32_t backoff_max) {
+	client->health.threshold = threshold;
+	client->health.backoff_min = (backoff_min > 0) ? backoff_min : 1;
+	client->health.backoff_max = (backoff_max > client->health.backoff_min) ? backoff_max : client->health.backoff_min;
+	modbus_health_reset(&client->health);
+}
+
+uint8_t modbus_client_rtu_health_report(struct modbus_rtu_client_handle *client, uint8_t device_adr, uint8_t responded, uint32_t now) {
+	struct modbus_client_health *health = &client->health;
+	struct modbus_device_health *dev = &health->devices[device_adr];
+	/* Broadcast requests are not responded */
+	if (health->threshold == 0 || device_adr == 0) {
+		return MB_HEALTH_UNCHANGED;
+	}
+	if (responded) {
+		dev->failures = 0;
+		if (!dev->quarantined) {
+			return MB_HEALTH_UNCHANGED;
+		}
+		dev->quarantined = 0;
+		health->quarantined--;
+		modbus_sched_restore(&client->sched, client->params, device_adr, now);
+		return MB_HEALTH_RESTORED;
+	}
+	if (dev->quarantined) {
+		/* Probe is lost */
+		dev->backoff = (dev->backoff > health->backoff_max / 2) ? health->backoff_max : dev->backoff * 2;
+		dev->probe_at = now + dev->backoff;
+		return MB_HEALTH_UNCHANGED;
+	}
+	if (dev->failures < 0xFF) {
+		dev->failures++;
+	}
+	if (dev->failures < health->threshold) {
+		return MB_HEALTH_UNCHANGED;
+	}
+	dev->quarantined = 1;
+	dev->backoff = health->backoff_min;
+	dev->probe_at = now + dev->backoff;
+	health->quarantined++;
+	return MB_HEALTH_QUARANTINED;
+}
+
+uint8_t modbus_client_rtu_quarantined(const struct modbus_rtu_client_handle *client, uint8_t device_adr) {
+	return client->health.devices[device_adr].quarantined;
+}
+
+int32_t modbus_client_tcp_next(struct modbus_tcp_client_handle *client, uint32_t now, uint16_t *transaction_id) {
+	return modbus_client_tcp_lane_next(client, 0, now, transaction_id);
+}
+
+void modbus_client_tcp_lanes_set(struct modbus_tcp_client_handle *client, uint8_t lanes) {
+	uint8_t i;
+	client->lanes = (lanes == 0) ? 1 : ((lanes > MB_TCP_MAX_LANES) ? MB_TCP_MAX_LANES : lanes);
+	for (i = 0; i < MB_TCP_MAX_LANES; i++) {
+		client->sched[i].size = 0;
+		client->sched[i].count = 0;
+	}
+}
+
+uint8_t modbus_client_tcp_lane(const struct modbus_tcp_client_handle *client, uint8_t unit_id) {
+	return (uint8_t) (unit_id % client->lanes);
+}
+
+int32_t modbus_client_tcp_lane_next(struct modbus_tcp_client_handle *client, uint8_t lane, uint32_t now, uint16_t *transaction_id) {
+	int32_t index;
+	if (lane >= client->lanes) {
+		return MB_SCHED_IDLE;
+	}
+	index = modbus_sched_next(&client->sched[lane], client->params, &client->sequence, now, NULL, lane, client->lanes);
+	if (index != MB_SCHED_IDLE) {
+		client->param_counter = (uint16_t) (index + 1);
+		*transaction_id = client->transaction_id++;
+	}
+	return index;
+}
+
+void modbus_client_tcp_transaction_set(uint8_t *package, uint16_t transaction_id) {
+	uint16_bytes val2byte;
+	val2byte.uint = transaction_id;
+	package[MB_OFFSET_TRANSACTION_ID_HIGH] = val2byte.bytes[1];
+	package[MB_OFFSET_TRANSACTION_ID_LOW] = val2byte.bytes[0];
+}
+
+void modbus_client_rtu_request(struct modbus_rtu_client_handle *client, uint32_t now, uint8_t *out_buf, uint16_t *out_buf_len) {
 	struct modbus_client_parameter *cur_param;
-	/* Polling counter looping */
-	if (client->param_counter == utils_vect_size(client->params)) {
-		client->param_counter = 0;
+	int32_t index = modbus_client_rtu_next(client, now);
+	if (index == MB_SCHED_IDLE) {
+		return;
 	}
-	cur_param = (struct modbus_client_parameter*)(utils_vect_get(client->params, client->param_counter));
+	cur_param = (struct modbus_client_parameter*)(utils_vect_get(client->params, (uint32_t) index));
 	if (cur_param->type != MB_NO_POLLING) {
 		*out_buf_len = modbus_client_request_package(cur_param, MB_RTU, out_buf, 0);
 	}
-	/* Increment counter */
-	client->param_counter++;
 }
 
-void modbus_client_tcp_request(struct modbus_tcp_client_handle *client, uint8_t *out_buf, uint16_t *out_buf_len) {
+void modbus_client_tcp_request(struct modbus_tcp_client_handle *client, uint32_t now, uint8_t *out_buf, uint16_t *out_buf_len) {
 	struct modbus_client_parameter *cur_param;
-	/* Polling counter looping */
-	if (client->param_counter == utils_vect_size(client->params)) {
-		client->param_counter = 0;
+	uint16_t transaction_id;
+	int32_t index = modbus_client_tcp_next(client, now, &transaction_id);
+	if (index == MB_SCHED_IDLE) {
+		return;
 	}
-	cur_param = (struct modbus_client_parameter*)(utils_vect_get(client->params, client->param_counter));
+	cur_param = (struct modbus_client_parameter*)(utils_vect_get(client->params, (uint32_t) index));
 	if (cur_param->type != MB_NO_POLLING) {
-		*out_buf_len = modbus_client_request_package(cur_param, MB_TCP, out_buf, client->transaction_id);
+		*out_buf_len = modbus_client_request_package(cur_param, MB_TCP, out_buf, transaction_id);
 	}
-	/* Increment counter */
-	client->param_counter++;
-	client->transaction_id++;
 }
 
 int8_t modbus_client_rtu_response(struct modbus_rtu_client_handle *client, const uint8_t *in_buf, int16_t in_buf_len) {
@@ -749,11 +1664,23 @@ int8_t modbus_client_rtu_response(struct modbus_rtu_client_handle *client, const
 	return res;
 }
 
+static int8_t modbus_client_tcp_param_response(struct modbus_client_parameter *param, const uint8_t *in_buf, int16_t in_buf_len) {
+	if (modbus_client_response_package(param, in_buf, in_buf_len, MB_TCP) != 0) {
+		if (param->type == MB_SET_VALUE) {
+			if (param->err == MB_EC_NO_ERR) {
+				param->type = MB_NO_POLLING;
+			}
+		}
+		return DEF_PKG_OK;
+	}
+	param->err = MB_EC_RESPONSE_ERR;
+	return DEF_PKG_INCORRECT;
+}
+
 int8_t modbus_client_tcp_response(struct modbus_tcp_client_handle *client, const uint8_t *in_buf, int16_t in_buf_len) {
 	struct modbus_client_parameter* cur_param;
 	uint16_t cur_counter, transaction_id;
 	int8_t res;
-	uint8_t response;
 	
 	if (in_buf_len > 0) {
 		res = modbus_tcp_server_mpab_analyze(in_buf, in_buf_len, &transaction_id);
@@ -769,23 +1696,8 @@ int8_t modbus_client_tcp_response(struct modbus_tcp_client_handle *client, const
 	}
 	cur_counter = client->param_counter - 1;
 	cur_param = (struct modbus_client_parameter*)(utils_vect_get(client->params, cur_counter));
-	if (transaction_id == client->transaction_id - 1) {
-		if (res == DEF_PKG_OK) {
-			response = modbus_client_response_package(cur_param, in_buf, in_buf_len, MB_TCP);
-		} else {
-			response = 0;
-		}
-		if (response != 0) {
-			if (cur_param->type == MB_SET_VALUE) {
-				if (cur_param->err == MB_EC_NO_ERR) {
-					cur_param->type = MB_NO_POLLING;
-				}
-			}
-			res = DEF_PKG_OK;
-		} else {
-			res = DEF_PKG_INCORRECT;
-			cur_param->err = MB_EC_RESPONSE_ERR;
-		}
+	if (transaction_id == client->transaction_id - 1 && res == DEF_PKG_OK) {
+		res = modbus_client_tcp_param_response(cur_param, in_buf, in_buf_len);
 	} else {
 		res = DEF_PKG_INCORRECT;
 		cur_param->err = MB_EC_RESPONSE_ERR;
@@ -797,6 +1709,70 @@ int8_t modbus_client_tcp_response(struct modbus_tcp_client_handle *client, const
 	return res;
 }
 
+int32_t modbus_tcp_package_length(const uint8_t *in_buf, uint16_t in_buf_len, uint16_t *transaction_id) {
+	uint16_bytes val2byte;
+	int32_t len;
+	
+	*transaction_id = 0;
+	if (in_buf_len < MB_SIZE_MPAB_HEADER) {
+		return DEF_PKG_INCOMPLETE;
+	}
+	/* Protocol id (always 0 for Modbus) */
+	if (in_buf[MB_OFFSET_PROTOCOL_ID_HIGH] != 0 || in_buf[MB_OFFSET_PROTOCOL_ID_LOW] != 0) {
+		return DEF_PKG_INCORRECT;
+	}
+	/* Data length: unit id + PDU */
+	val2byte.bytes[0] = in_buf[MB_OFFSET_LENGTH_LOW];
+	val2byte.bytes[1] = in_buf[MB_OFFSET_LENGTH_HIGH];
+	if (val2byte.uint < MB_SIZE_TCP_MIN_PACKAGE - MB_SIZE_MPAB_HEADER + 1 || val2byte.uint > MB_SIZE_MAX_PDU + 1) {
+		return DEF_PKG_INCORRECT;
+	}
+	len = val2byte.uint + MB_SIZE_MPAB_HEADER - 1;
+	if (in_buf_len < len) {
+		return DEF_PKG_INCOMPLETE;
+	}
+	/* Transaction id */
+	val2byte.bytes[0] = in_buf[MB_OFFSET_TRANSACTION_ID_LOW];
+	val2byte.bytes[1] = in_buf[MB_OFFSET_TRANSACTION_ID_HIGH];
+	*transaction_id = val2byte.uint;
+	return len;
+}
+
+int8_t modbus_client_tcp_transaction_response(struct modbus_client_parameter *param, const uint8_t *in_buf, int16_t in_buf_len) {
+	uint16_t transaction_id;
+	
+	if (in_buf_len <= 0 || modbus_tcp_server_mpab_analyze(in_buf, in_buf_len, &transaction_id) != DEF_PKG_OK) {
+		param->err = MB_EC_RESPONSE_ERR;
+		return DEF_PKG_INCORRECT;
+	}
+	return modbus_client_tcp_param_response(param, in_buf, in_buf_len);
+}
+
+int8_t modbus_client_param_response(struct modbus_client_parameter *param, uint8_t type, uint16_t transaction_id, const uint8_t *in_buf, int16_t in_buf_len) {
+	uint16_t response_id;
+	int8_t res;
+	
+	if (in_buf_len <= 0) {
+		return DEF_PKG_INCOMPLETE;
+	}
+	if (type == MB_RTU) {
+		res = modbus_client_rtu_check(in_buf, (uint16_t) in_buf_len);
+	} else {
+		res = modbus_tcp_server_mpab_analyze(in_buf, (uint16_t) in_buf_len, &response_id);
+		if (res == DEF_PKG_OK && response_id != transaction_id) {
+			res = DEF_PKG_INCORRECT;
+		}
+	}
+	if (res == DEF_PKG_INCOMPLETE) {
+		return res;
+	}
+	if (res == DEF_PKG_OK && modbus_client_response_package(param, in_buf, (uint16_t) in_buf_len, type) != 0) {
+		return DEF_PKG_OK;
+	}
+	param->err = MB_EC_RESPONSE_ERR;
+	return DEF_PKG_INCORRECT;
+}
+
 uint32_t modbus_client_rtu_param_add(struct modbus_rtu_client_handle *client, struct modbus_client_parameter *param) {
 	return utils_vect_append(client->params, param);
 }
@@ -820,3 +1796,229 @@ void modbus_client_tcp_param_del(struct modbus_tcp_client_handle *client, uint32
 struct modbus_client_parameter* modbus_client_tcp_param_get(struct modbus_tcp_client_handle *client, uint32_t index) {
 	return utils_vect_get(client->params, index);
 }
+
+struct modbus_rtu_monitor* modbus_rtu_monitor_create(void) {
+	struct modbus_rtu_monitor *mon;
+	if ((mon = (struct modbus_rtu_monitor*) malloc(sizeof(struct modbus_rtu_monitor))) == NULL) {
+		return NULL;
+	}
+	mon->frames = 0;
+	mon->dropped = 0;
+	modbus_rtu_monitor_reset(mon);
+	return mon;
+}
+
+void modbus_rtu_monitor_destroy(struct modbus_rtu_monitor *mon) {
+	free(mon);
+}
+
+void modbus_rtu_monitor_reset(struct modbus_rtu_monitor *mon) {
+	mon->start = 0;
+	mon->len = 0;
+	mon->frame_len = 0;
+	mon->frame_type = 0;
+	mon->request_len = 0;
+	mon->paired = 0;
+}
+
+uint16_t modbus_rtu_monitor_feed(struct modbus_rtu_monitor *mon, const uint8_t *data, uint16_t len) {
+	uint16_t free_size;
+	/* Move undecoded data to the buffer begin */
+	if (mon->start + mon->len + len > MB_SIZE_RTU_MONITOR_BUFFER && mon->start > 0 && mon->frame_type == 0) {
+		memmove(mon->buf, &mon->buf[mon->start], mon->len);
+		mon->start = 0;
+	}
+	free_size = MB_SIZE_RTU_MONITOR_BUFFER - mon->start - mon->len;
+	if (len > free_size) {
+		len = free_size;
+	}
+	memcpy(&mon->buf[mon->start + mon->len], data, len);
+	mon->len += len;
+	return len;
+}
+
+/* Frame size for the request (req) and the response (resp) interpretation of the data,
+ * 0 - interpretation is impossible, UINT16_MAX - more data required. Returns 0 for invalid frame start. */
+static uint8_t modbus_rtu_monitor_sizes(const uint8_t *data, uint16_t len, uint16_t *req, uint16_t *resp) {
+	uint8_t fcode;
+	if (len < MB_SIZE_SERIAL_HEADER + 1 || data[MB_OFFSET_SERIAL_ADR] > 247) {
+		return 0;
+	}
+	fcode = data[MB_SIZE_SERIAL_HEADER + MB_OFFSET_FCODE];
+	*req = 0;
+	*resp = 0;
+	switch (fcode & ~MB_EX_BASE) {
+		case MB_FC_READ_COILS:
+		case MB_FC_READ_DICSRETE_INPUTS:
+		case MB_FC_READ_HOLDING_REGISTERS:
+		case MB_FC_READ_INPUT_REGISTERS:
+			*req = MB_SIZE_RTU_READ_PACKAGE;
+			*resp = (len > MB_SIZE_SERIAL_HEADER + MB_OFFSET_OUT_SIZE) ? (uint16_t) (data[MB_SIZE_SERIAL_HEADER + MB_OFFSET_OUT_SIZE] + MB_SIZE_RTU_OUT_READ_SERVICE_BLOCK) : UINT16_MAX;
+			break;
+		case MB_FC_WRITE_SINGLE_COIL:
+		case MB_FC_WRITE_SINGLE_REGISTER:
+			*req = MB_SIZE_RTU_READ_PACKAGE;
+			*resp = MB_SIZE_RTU_OUT_WRITE_RESPONSE;
+			break;
+		case MB_FC_WRITE_MULTIPLE_COILS:
+		case MB_FC_WRITE_MULTIPLE_REGISTERS:
+			*req = (len > MB_SIZE_SERIAL_HEADER + MB_OFFSET_IN_BYTE_COUNT) ? (uint16_t) (data[MB_SIZE_SERIAL_HEADER + MB_OFFSET_IN_BYTE_COUNT] + MB_SIZE_RTU_WRITE_MULTI_SERVICE_BLOCK) : UINT16_MAX;
+			*resp = MB_SIZE_RTU_OUT_WRITE_RESPONSE;
+			break;
+		default:
+			return 0;
+	}
+	/* Exception response */
+	if (fcode & MB_EX_BASE) {
+		*req = 0;
+		*resp = MB_SIZE_RTU_OUT_ERR_RESPONSE;
+	}
+	/* Broadcast requests have no response */
+	if (data[MB_OFFSET_SERIAL_ADR] == 0) {
+		*resp = 0;
+	}
+	return 1;
+}
+
+/* Checks frame of the size at the data begin: 1 - valid, 0 - invalid, DEF_PKG_INCOMPLETE (as -1) - more data required */
+static int8_t modbus_rtu_monitor_check(const uint8_t *data, uint16_t len, uint16_t size) {
+	uint16_bytes val2byte;
+	if (size == 0 || size > MB_SIZE_RTU_MAX_PACKAGE) {
+		return 0;
+	}
+	if (size > len) {
+		return -1;
+	}
+	val2byte.uint = modbus_crc16(data, size - MB_SIZE_CRC);
+	return (data[size - MB_SIZE_CRC] == val2byte.bytes[0] && data[size - MB_SIZE_CRC + 1] == val2byte.bytes[1]) ? 1 : 0;
+}
+
+int8_t modbus_rtu_monitor_next(struct modbus_rtu_monitor *mon, uint8_t silence) {
+	const uint8_t *data;
+	uint16_t sizes[2];
+	uint8_t types[2];
+	int8_t res;
+	uint8_t i, incomplete, answer;
+
+	/* Release the previous frame */
+	if (mon->frame_type != 0) {
+		mon->start += mon->frame_len;
+		mon->len -= mon->frame_len;
+		if (mon->frame_type == MB_MONITOR_RESPONSE) {
+			mon->request_len = 0;
+		}
+		mon->frame_type = 0;
+		mon->frame_len = 0;
+		mon->paired = 0;
+	}
+	while (mon->len > 0) {
+		data = &mon->buf[mon->start];
+		incomplete = (mon->len < MB_SIZE_SERIAL_HEADER + 1);
+		if (!incomplete && modbus_rtu_monitor_sizes(data, mon->len, &sizes[0], &sizes[1])) {
+			types[0] = MB_MONITOR_REQUEST;
+			types[1] = MB_MONITOR_RESPONSE;
+			/* The response of the pending request is expected first */
+			answer = (mon->request_len > 0 && mon->request[MB_OFFSET_SERIAL_ADR] == data[MB_OFFSET_SERIAL_ADR] &&
+				mon->request[MB_SIZE_SERIAL_HEADER + MB_OFFSET_FCODE] == (data[MB_SIZE_SERIAL_HEADER + MB_OFFSET_FCODE] & ~MB_EX_BASE));
+			for (i = 0; i < 2; i++) {
+				uint8_t k = answer ? (uint8_t) (1 - i) : i;
+				if (sizes[k] == UINT16_MAX) {
+					incomplete = 1;
+					continue;
+				}
+				res = modbus_rtu_monitor_check(data, mon->len, sizes[k]);
+				if (res < 0) {
+					incomplete = 1;
+				} else if (res > 0) {
+					mon->frame_len = sizes[k];
+					mon->frame_type = types[k];
+					mon->frames++;
+					if (types[k] == MB_MONITOR_REQUEST) {
+						memcpy(mon->request, data, sizes[k]);
+						mon->request_len = sizes[k];
+					} else {
+						mon->paired = answer;
+					}
+					return (int8_t) types[k];
+				}
+			}
+		}
+		if (incomplete && !silence) {
+			break;
+		}
+		/* Not a frame start (or the frame was interrupted by the silence), slide by one byte */
+		mon->start++;
+		mon->len--;
+		mon->dropped++;
+	}
+	if (mon->len == 0) {
+		mon->start = 0;
+	}
+	return DEF_PKG_INCOMPLETE;
+}
+
+const uint8_t* modbus_rtu_monitor_frame(const struct modbus_rtu_monitor *mon) {
+	return &mon->buf[mon->start];
+}
+
+uint8_t modbus_client_monitor_response(struct modbus_client_parameter *param, const struct modbus_rtu_monitor *mon) {
+	const uint8_t *req, *resp;
+	uint16_bytes val2byte;
+	uint16_t start, count, offset, bit, i;
+
+	if (mon->frame_type != MB_MONITOR_RESPONSE || !mon->paired) {
+		return 0;
+	}
+	req = &mon->request[MB_SIZE_SERIAL_HEADER];
+	resp = &mon->buf[mon->start + MB_SIZE_SERIAL_HEADER];
+	if (mon->request[MB_OFFSET_SERIAL_ADR] != param->device_adr || req[MB_OFFSET_FCODE] != param->function_code) {
+		return 0;
+	}
+	/* Requested range must cover the parameter */
+	val2byte.bytes[0] = req[MB_OFFSET_IN_ADR_LOW];
+	val2byte.bytes[1] = req[MB_OFFSET_IN_ADR_HIGH];
+	start = val2byte.uint;
+	if (param->function_code == MB_FC_WRITE_SINGLE_COIL || param->function_code == MB_FC_WRITE_SINGLE_REGISTER) {
+		count = 1;
+	} else {
+		val2byte.bytes[0] = req[MB_OFFSET_IN_SIZE_LOW];
+		val2byte.bytes[1] = req[MB_OFFSET_IN_SIZE_HIGH];
+		count = val2byte.uint;
+	}
+	if (param->register_adr < start || (uint32_t) param->register_adr + param->func_size > (uint32_t) start + count) {
+		return 0;
+	}
+	/* Exception */
+	if (resp[MB_OFFSET_FCODE] & MB_EX_BASE) {
+		param->err = resp[MB_OFFSET_OUT_ERR_CODE];
+		return 1;
+	}
+	offset = param->register_adr - start;
+	switch (param->function_code) {
+		case MB_FC_READ_HOLDING_REGISTERS:
+		case MB_FC_READ_INPUT_REGISTERS:
+			if ((uint32_t) offset * MB_SIZE_REGISTER + param->size > resp[MB_OFFSET_OUT_SIZE]) {
+				return 0;
+			}
+			memcpy(param->value, &resp[MB_OFFSET_OUT_START_DATA + offset * MB_SIZE_REGISTER], param->size);
+			break;
+		case MB_FC_READ_COILS:
+		case MB_FC_READ_DICSRETE_INPUTS:
+			if ((uint32_t) offset + param->func_size > (uint32_t) resp[MB_OFFSET_OUT_SIZE] * 8) {
+				return 0;
+			}
+			memset(param->value, 0, param->size);
+			for (i = 0; i < param->func_size; i++) {
+				bit = offset + i;
+				if (resp[MB_OFFSET_OUT_START_DATA + bit / 8] & (1 << (bit % 8))) {
+					param->value[i / 8] |= (uint8_t) (1 << (i % 8));
+				}
+			}
+			break;
+		default:
+			/* Write confirmation, value is known to the writing master only */
+			break;
+	}
+	param->err = MB_EC_NO_ERR;
+	return 1;
+}
@@ -92,6 +92,9 @@
 #define MB_SIZE_RTU_OUT_READ_SERVICE_BLOCK 5
 #define MB_SIZE_CRC 2
 #define MB_SIZE_OUT_ERR 2
+#define MB_SIZE_MAX_PDU 253
+#define MB_SIZE_RTU_MAX_PACKAGE 256
+#define MB_SIZE_RTU_MONITOR_BUFFER 1024
 #define MB_OFFSET_SERIAL_ADR 0
 #define MB_OFFSET_FCODE 0
 #define MB_OFFSET_IN_ADR_HIGH 1
@@ -113,6 +116,44 @@
 #define MB_OFFSET_LENGTH_LOW 5
 #define MB_OFFSET_MPAB_UNIT_ID 6
 
+/* CRC16 engine, selected at compile time:
+ * 1 - byte-wise table, 4 - slicing-by-4, 8 - slicing-by-8 (default) */
+#ifndef MB_CRC16_SLICE
+#define MB_CRC16_SLICE 8
+#endif
+#if MB_CRC16_SLICE != 1 && MB_CRC16_SLICE != 4 && MB_CRC16_SLICE != 8
+#error "MB_CRC16_SLICE must be 1, 4 or 8"
+#endif
+
+/* Byte order conversion engines */
+#define MB_CONVERT_SCALAR 0
+#define MB_CONVERT_SSSE3 1
+#define MB_CONVERT_AVX2 2
+
+/* Vectorised byte order conversion (engine is selected by CPU features at run time), 0 - scalar only */
+#ifndef MB_CONVERT_SIMD
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define MB_CONVERT_SIMD 1
+#else
+#define MB_CONVERT_SIMD 0
+#endif
+#endif
+
+/* Scheduler: no parameter is due */
+#define MB_SCHED_IDLE -1
+
+/* Maximum lanes (parallel connections) of Modbus TCP client */
+#define MB_TCP_MAX_LANES 16
+
+/* Device health changes (dead slave circuit breaker) */
+#define MB_HEALTH_UNCHANGED 0
+#define MB_HEALTH_QUARANTINED 1
+#define MB_HEALTH_RESTORED 2
+
+/* RTU monitor frame types */
+#define MB_MONITOR_REQUEST 1
+#define MB_MONITOR_RESPONSE 2
+
 /* RTU analyze error codes */
 #define MB_RTU_ERR_INCOMPLETE -1
 #define MB_RTU_ERR_SIZE -2
@@ -135,6 +176,39 @@ struct modbus_client_parameter {
 	uint8_t size;								/* Value size in bytes*/
 	uint8_t err;								/* Transmit error (0 - no error) */
 	uint8_t type;								/* Polling type */
+	uint32_t period;							/* Polling period in ms (0 - as often as possible) */
+	uint32_t deadline;							/* Next polling time in ms (scheduler state) */
+	uint8_t priority;							/* Priority between parameters due at the same time */
+	uint8_t scheduled;							/* Deadline is valid, kept by scheduler rebuild */
+	uint8_t in_flight;							/* Request is outstanding (pipelining), skipped by scheduler */
+	uint32_t polled;							/* Sequence number of the last poll (least recently polled first on ties) */
+};
+
+/**
+ * @brief Deadline scheduler of client parameters polling
+ */
+struct modbus_client_scheduler {
+	uint16_t *heap;								/* Parameters indexes ordered by deadline (binary heap) */
+	uint16_t size;								/* Scheduled parameters */
+	uint16_t capacity;							/* Heap capacity */
+	uint16_t count;								/* Client parameters at build (0 - rebuild on next request) */
+};
+
+/**
+ * @brief Registers range with the same access
+ */
+struct modbus_access_range {
+	uint16_t start;								/* First register */
+	uint32_t end;								/* Register after the last one */
+	uint8_t access;								/* Access flags */
+};
+
+/**
+ * @brief Registers access map (sorted not overlapped ranges, registers out of ranges are denied)
+ */
+struct modbus_access_map {
+	struct modbus_access_range *ranges;			/* Ranges sorted by start register */
+	uint32_t size;								/* Number of ranges */
 };
 
 /**
@@ -142,12 +216,35 @@ struct modbus_client_parameter {
  */
 struct modbus_server_handle {
 	uint8_t *registers;							/* Registers map */
-	uint8_t *access;							/* Access mask for registers map */
+	uint8_t *access;							/* Access mask for registers map (per byte) */
+	struct modbus_access_map *access_map;		/* Access ranges (used instead of access mask if set) */
 	int32_t bytes_size;							/* Size of map in bytes */
 	uint16_t max_registers_send;				/* Maximum number of registers/bits requested in one package */
 	uint16_t device_adr;						/* Master (server) address */
 };
 
+/**
+ * @brief Health of polled device
+ */
+struct modbus_device_health {
+	uint8_t failures;							/* Consecutive timeouts */
+	uint8_t quarantined;						/* Device is polled by rare probes only */
+	uint32_t probe_at;							/* Next probe time in ms */
+	uint32_t backoff;							/* Probe interval in ms */
+};
+
+/**
+ * @brief Dead slave circuit breaker: devices not responding are quarantined,
+ * their parameters are postponed until the next probe (interval grows exponentially)
+ */
+struct modbus_client_health {
+	struct modbus_device_health devices[256];	/* Health by device address */
+	uint8_t threshold;							/* Consecutive timeouts to quarantine device (0 - disabled) */
+	uint32_t backoff_min;						/* First probe interval in ms */
+	uint32_t backoff_max;						/* Maximum probe interval in ms */
+	uint16_t quarantined;						/* Number of quarantined devices */
+};
+
 /**
  * @brief Modbus RTU client handle
  */
@@ -155,6 +252,9 @@ struct modbus_rtu_client_handle {
 	struct utils_vect_handle* params;			/* Parameters vector */
 	uint16_t param_counter;						/* Polling counter */
 	uint16_t counter;							/* Total counter */
+	uint32_t sequence;							/* Polls counter, stamps polled parameters */
+	struct modbus_client_scheduler sched;		/* Polling scheduler */
+	struct modbus_client_health health;			/* Devices health */
 };
 
 /**
@@ -165,6 +265,25 @@ struct modbus_tcp_client_handle {
 	uint16_t transaction_id;					/* Transaction Identifier */
 	uint16_t param_counter;						/* Polling counter */
 	uint16_t counter;							/* Total counter */
+	uint32_t sequence;							/* Polls counter (over all lanes), stamps polled parameters */
+	struct modbus_client_scheduler sched[MB_TCP_MAX_LANES];	/* Polling schedulers of lanes */
+	uint8_t lanes;								/* Lanes, parameters are spread by unit id (unit id % lanes) */
+};
+
+/**
+ * @brief Modbus RTU bus monitor (listen-only decoder of master/slave traffic)
+ */
+struct modbus_rtu_monitor {
+	uint8_t buf[MB_SIZE_RTU_MONITOR_BUFFER];	/* Received stream */
+	uint16_t start;								/* Offset of undecoded data */
+	uint16_t len;								/* Size of undecoded data */
+	uint16_t frame_len;							/* Size of the last decoded frame (at start) */
+	uint8_t frame_type;							/* Type of the last decoded frame (0 - none) */
+	uint8_t request[MB_SIZE_RTU_MAX_PACKAGE];	/* Last request waiting for the response */
+	uint16_t request_len;						/* Request size (0 - no request) */
+	uint8_t paired;								/* Last decoded response answers the request */
+	uint32_t frames;							/* Decoded frames */
+	uint32_t dropped;							/* Bytes skipped during resynchronisation */
 };
 
 /**
@@ -184,6 +303,45 @@ struct modbus_server_handle* modbus_server_create(void *regs, uint8_t *access, i
  */
 void modbus_server_destroy(struct modbus_server_handle* serv);
 
+/**
+ * @brief Set registers access map of Modbus server (replaces access mask, NULL - full access if mask is not set)
+ * @param serv Modbus server handle
+ * @param map Access map (not owned by server, can be shared between servers)
+ */
+void modbus_server_set_access_map(struct modbus_server_handle* serv, struct modbus_access_map *map);
+
+/**
+ * @brief Create empty registers access map (all registers are denied)
+ * @return Access map or NULL
+ */
+struct modbus_access_map* modbus_access_map_create(void);
+
+/**
+ * @brief Destroy registers access map
+ * @param map Access map
+ */
+void modbus_access_map_destroy(struct modbus_access_map *map);
+
+/**
+ * @brief Set access of registers range
+ * @param map Access map
+ * @param adr First register
+ * @param count Number of registers
+ * @param access Access flags (MB_ACCESS_*)
+ * @return 1 - success, 0 - allocation error
+ */
+uint8_t modbus_access_map_set(struct modbus_access_map *map, uint16_t adr, uint32_t count, uint8_t access);
+
+/**
+ * @brief Check access of registers range, O(log n)
+ * @param map Access map
+ * @param adr First register
+ * @param count Number of registers
+ * @param access Required access flags (MB_ACCESS_READ or MB_ACCESS_WRITE)
+ * @return 1 - allowed, 0 - denied
+ */
+uint8_t modbus_access_map_check(const struct modbus_access_map *map, uint16_t adr, uint32_t count, uint8_t access);
+
 /**
  * @brief modbus_tcp_server Processing Modbus TCP package and generates responce package
  * @param serv Modbus server handle
@@ -232,6 +390,19 @@ int16_t modbus_rtu_server_analyze(uint8_t *in_buf, uint16_t in_buf_len);
  */
 void modbus_convert_data(uint8_t *in, uint8_t *out, uint16_t len, uint8_t order);
 
+/**
+ * @brief Byte order conversion engine used by modbus_convert_data (detected on the first call)
+ * @return MB_CONVERT_SCALAR, MB_CONVERT_SSSE3 or MB_CONVERT_AVX2
+ */
+uint8_t modbus_convert_engine(void);
+
+/**
+ * @brief Select byte order conversion engine (for benchmarks and tests)
+ * @param engine MB_CONVERT_SCALAR, MB_CONVERT_SSSE3 or MB_CONVERT_AVX2
+ * @return 1 for success, 0 - engine is not supported by CPU or build
+ */
+uint8_t modbus_convert_set_engine(uint8_t engine);
+
 /**
  * @brief Recalculates and set parameter bytes size depends of func_size, reallocate memory for value
  * @param param Modbus client parameter
@@ -274,6 +445,33 @@ void modbus_client_rtu_destroy(struct modbus_rtu_client_handle *client);
  */
 void modbus_client_rtu_reset(struct modbus_rtu_client_handle *client);
 
+/**
+ * @brief Setup dead slave circuit breaker of Modbus RTU client (devices health is reset)
+ * @param client Modbus RTU client handle
+ * @param threshold Consecutive timeouts to quarantine device (0 - disabled)
+ * @param backoff_min First probe interval of quarantined device in ms
+ * @param backoff_max Maximum probe interval in ms (interval is doubled after each lost probe)
+ */
+void modbus_client_rtu_health_setup(struct modbus_rtu_client_handle *client, uint8_t threshold, uint32_t backoff_min, uint32_t backoff_max);
+
+/**
+ * @brief Report result of Modbus RTU client request to device
+ * @param client Modbus RTU client handle
+ * @param device_adr Device address
+ * @param responded 1 - device responded (data or exception), 0 - timeout
+ * @param now Current time in ms
+ * @return MB_HEALTH_UNCHANGED, MB_HEALTH_QUARANTINED or MB_HEALTH_RESTORED
+ */
+uint8_t modbus_client_rtu_health_report(struct modbus_rtu_client_handle *client, uint8_t device_adr, uint8_t responded, uint32_t now);
+
+/**
+ * @brief Check device is quarantined
+ * @param client Modbus RTU client handle
+ * @param device_adr Device address
+ * @return 1 - quarantined, 0 - polled normally
+ */
+uint8_t modbus_client_rtu_quarantined(const struct modbus_rtu_client_handle *client, uint8_t device_adr);
+
 /**
  * @brief Append parameter to client
  * @param client Modbus RTU client handle
@@ -383,21 +581,86 @@ uint8_t modbus_client_response_package(struct modbus_client_parameter *param, co
  */
 void modbus_client_tcp_mpab(uint16_t transaction_id, uint8_t *package, uint16_t package_len, uint8_t unit_id);
 
+/**
+ * @brief Select next polled parameter of Modbus RTU client (earliest deadline, then highest priority, then least recently polled)
+ * @param client Modbus RTU client handle
+ * @param now Current time in ms
+ * @return Parameter index or MB_SCHED_IDLE
+ */
+int32_t modbus_client_rtu_next(struct modbus_rtu_client_handle *client, uint32_t now);
+
+/**
+ * @brief Select next polled parameter of Modbus TCP client (earliest deadline, then highest priority, then least recently polled)
+ * @param client Modbus TCP client handle
+ * @param now Current time in ms
+ * @param transaction_id Transaction id of the request
+ * @return Parameter index or MB_SCHED_IDLE
+ */
+int32_t modbus_client_tcp_next(struct modbus_tcp_client_handle *client, uint32_t now, uint16_t *transaction_id);
+
+/**
+ * @brief Parameters list of Modbus RTU client is changed: scheduler is rebuilt on the next request,
+ * kept parameters keep their deadlines, new parameters are due at once (polling cycle is not restarted)
+ * @param client Modbus RTU client handle
+ */
+void modbus_client_rtu_params_changed(struct modbus_rtu_client_handle *client);
+
+/**
+ * @brief Parameters list of Modbus TCP client is changed: schedulers of all lanes are rebuilt on the next request,
+ * kept parameters keep their deadlines, new parameters are due at once (polling cycle is not restarted)
+ * @param client Modbus TCP client handle
+ */
+void modbus_client_tcp_params_changed(struct modbus_tcp_client_handle *client);
+
+/**
+ * @brief Split parameters of Modbus TCP client to lanes (independent schedulers, e.g. parallel connections)
+ * @param client Modbus TCP client handle
+ * @param lanes Number of lanes [1, MB_TCP_MAX_LANES]
+ */
+void modbus_client_tcp_lanes_set(struct modbus_tcp_client_handle *client, uint8_t lanes);
+
+/**
+ * @brief Lane of device
+ * @param client Modbus TCP client handle
+ * @param unit_id Unit id (device address)
+ * @return Lane index
+ */
+uint8_t modbus_client_tcp_lane(const struct modbus_tcp_client_handle *client, uint8_t unit_id);
+
+/**
+ * @brief Select next polled parameter of the lane of Modbus TCP client (earliest deadline, then highest priority, then least recently polled), parameters in flight are skipped keeping their deadlines
+ * @param client Modbus TCP client handle
+ * @param lane Lane index
+ * @param now Current time in ms
+ * @param transaction_id Transaction id of the request (unique over all lanes)
+ * @return Parameter index or MB_SCHED_IDLE
+ */
+int32_t modbus_client_tcp_lane_next(struct modbus_tcp_client_handle *client, uint8_t lane, uint32_t now, uint16_t *transaction_id);
+
+/**
+ * @brief Replace transaction id in built Modbus TCP package
+ * @param package Package buffer
+ * @param transaction_id Transaction id
+ */
+void modbus_client_tcp_transaction_set(uint8_t *package, uint16_t transaction_id);
+
 /**
  * @brief Modbus RTU slave (client) request function
  * @param client Modbus RTU client handle
+ * @param now Current time in ms
  * @param out_buf Buffer for created package
  * @param out_buf_len Pointer to package size
  */
-void modbus_client_rtu_request(struct modbus_rtu_client_handle *client, uint8_t *out_buf, uint16_t *out_buf_len);
+void modbus_client_rtu_request(struct modbus_rtu_client_handle *client, uint32_t now, uint8_t *out_buf, uint16_t *out_buf_len);
 
 /**
  * @brief Modbus TCP slave (client) request function
  * @param client Modbus TCP client handle
+ * @param now Current time in ms
  * @param out_buf Buffer for created package
  * @param out_buf_len Pointer to package size
  */
-void modbus_client_tcp_request(struct modbus_tcp_client_handle *client, uint8_t *out_buf, uint16_t *out_buf_len);
+void modbus_client_tcp_request(struct modbus_tcp_client_handle *client, uint32_t now, uint8_t *out_buf, uint16_t *out_buf_len);
 
 /**
  * @brief Modbus RTU slave (client) response function
@@ -418,6 +681,85 @@ int8_t modbus_client_rtu_response(struct modbus_rtu_client_handle *client, const
  */
 int8_t modbus_client_tcp_response(struct modbus_tcp_client_handle *client, const uint8_t *in_buf, int16_t in_buf_len);
 
+/**
+ * @brief Size of the first Modbus TCP package in the received stream (by MPAB header)
+ * @param in_buf Received stream data
+ * @param in_buf_len Stream data size
+ * @param transaction_id Transaction id of the complete package
+ * @return Package size, DEF_PKG_INCOMPLETE or DEF_PKG_INCORRECT (corrupted header)
+ */
+int32_t modbus_tcp_package_length(const uint8_t *in_buf, uint16_t in_buf_len, uint16_t *transaction_id);
+
+/**
+ * @brief Modbus TCP slave (client) response function for one of several outstanding transactions
+ * @param param Parameter requested by the transaction
+ * @param in_buf Complete Modbus servers package
+ * @param in_buf_len Package size
+ * @return Parse status
+ */
+int8_t modbus_client_tcp_transaction_response(struct modbus_client_parameter *param, const uint8_t *in_buf, int16_t in_buf_len);
+
+/**
+ * @brief Modbus slave (client) response to the request of single parameter out of the polling cycle (e.g. queued write)
+ * @param param Requested parameter
+ * @param type Modbus client type (MB_RTU or MB_TCP)
+ * @param transaction_id Transaction id of the request (for TCP only)
+ * @param in_buf Modbus servers package
+ * @param in_buf_len Package size
+ * @return Parse status
+ */
+int8_t modbus_client_param_response(struct modbus_client_parameter *param, uint8_t type, uint16_t transaction_id, const uint8_t *in_buf, int16_t in_buf_len);
+
+/**
+ * @brief Create Modbus RTU bus monitor
+ * @return Monitor handle or NULL
+ */
+struct modbus_rtu_monitor* modbus_rtu_monitor_create(void);
+
+/**
+ * @brief Destroy Modbus RTU bus monitor
+ * @param mon Monitor handle
+ */
+void modbus_rtu_monitor_destroy(struct modbus_rtu_monitor *mon);
+
+/**
+ * @brief Drop received data and pending request
+ * @param mon Monitor handle
+ */
+void modbus_rtu_monitor_reset(struct modbus_rtu_monitor *mon);
+
+/**
+ * @brief Append received bytes to the monitor stream
+ * @param mon Monitor handle
+ * @param data Received bytes
+ * @param len Number of bytes
+ * @return Number of accepted bytes (less than len if the buffer is full, decode frames and feed the rest)
+ */
+uint16_t modbus_rtu_monitor_feed(struct modbus_rtu_monitor *mon, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Decode next frame of the stream, frame boundaries are found by CRC (sliding by one byte on errors)
+ * @param mon Monitor handle
+ * @param silence Bus was silent (t3.5) after the fed data, incomplete data is dropped
+ * @return MB_MONITOR_REQUEST, MB_MONITOR_RESPONSE or DEF_PKG_INCOMPLETE (no more frames)
+ */
+int8_t modbus_rtu_monitor_next(struct modbus_rtu_monitor *mon, uint8_t silence);
+
+/**
+ * @brief Decoded frame (valid until the next call of modbus_rtu_monitor_next)
+ * @param mon Monitor handle
+ * @return Frame data (size in frame_len)
+ */
+const uint8_t* modbus_rtu_monitor_frame(const struct modbus_rtu_monitor *mon);
+
+/**
+ * @brief Update parameter from the last monitored response if the paired request covers it
+ * @param param Modbus client parameter
+ * @param mon Monitor handle
+ * @return 1 if parameter value or error is updated, 0 - parameter is not covered
+ */
+uint8_t modbus_client_monitor_response(struct modbus_client_parameter *param, const struct modbus_rtu_monitor *mon);
+
 #if defined (__cplusplus)
 }
 #endif
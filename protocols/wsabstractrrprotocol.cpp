@@ -20,12 +20,14 @@
 
 ****************************************************************************/
 
+#include <algorithm>
 #include "wsabstractrrprotocol.h"
 
 WSAbstractRRProtocol::WSAbstractRRProtocol(quint32 bufferSize, QObject *parent) :
 	QObject(parent),
 	m_bufferSize(bufferSize),
-	m_buffer(new char[bufferSize])
+	m_buffer(new char[bufferSize]),
+	m_cycleCompleted(false)
 {}
 
 const QByteArray& WSAbstractRRProtocol::constructRequest() {
@@ -38,7 +40,75 @@ const QByteArray& WSAbstractRRProtocol::constructRequest() {
 	return m_array;
 }
 
+bool WSAbstractRRProtocol::pipelineSupported() const {
+	return false;
+}
+
+qint32 WSAbstractRRProtocol::frameLength(const QByteArray &, quint32 *transactionId) const {
+	*transactionId = 0;
+	return static_cast<qint32>(WSProtocolParseCode::INCORRECT);
+}
+
+quint32 WSAbstractRRProtocol::lastDevice() const {
+	return 0;
+}
+
+quint32 WSAbstractRRProtocol::lastTransactionId() const {
+	return 0;
+}
+
+WSProtocolParseCode WSAbstractRRProtocol::processTransaction(quint32, const QByteArray &) {
+	return WSProtocolParseCode::INCORRECT;
+}
+
+void WSAbstractRRProtocol::transactionTimeout(quint32, quint32) {}
+
+void WSAbstractRRProtocol::transactionsReset() {}
+
+quint32 WSAbstractRRProtocol::maxLanes() const {
+	return 1;
+}
+
+void WSAbstractRRProtocol::setLanes(quint32) {}
+
+const QByteArray &WSAbstractRRProtocol::constructLaneRequest(quint32) {
+	return constructRequest();
+}
+
+bool WSAbstractRRProtocol::rawFraming() const {
+	return false;
+}
+
+bool WSAbstractRRProtocol::monitorSupported() const {
+	return false;
+}
+
+WSProtocolParseCode WSAbstractRRProtocol::processMonitored(const QByteArray &, bool) {
+	return WSProtocolParseCode::INCORRECT;
+}
+
 quint32 WSAbstractRRProtocol::bufferSize() const {
 	return m_bufferSize;
 }
 
+bool WSAbstractRRProtocol::cycleCompleted() {
+	bool completed = m_cycleCompleted;
+	m_cycleCompleted = false;
+	return completed;
+}
+
+void WSAbstractRRProtocol::cycleRequest(quint32 index) {
+	if (index >= m_cycleRequested.size()) {
+		m_cycleRequested.resize(index + 1, false);
+	}
+	if (m_cycleRequested[index]) {
+		m_cycleCompleted = true;
+		std::fill(m_cycleRequested.begin(), m_cycleRequested.end(), false);
+	}
+	m_cycleRequested[index] = true;
+}
+
+// Request indexes are changed (e.g. replanned), the next cycle starts from scratch
+void WSAbstractRRProtocol::cycleReset() {
+	std::fill(m_cycleRequested.begin(), m_cycleRequested.end(), false);
+}
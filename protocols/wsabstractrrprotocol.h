@@ -25,6 +25,7 @@
 
 #include <QtCore>
 #include <memory>
+#include <vector>
 
 enum class WSProtocolParseCode : qint8 {
 	INCORRECT = -1,
@@ -58,13 +59,45 @@ public:
 	virtual WSRRProtocol type() const = 0;
 	virtual void timeoutOccurred(quint32 timeout) = 0;
 	virtual bool readyToPolling() = 0;
+	// Device address of the last constructed request
+	virtual quint32 lastDevice() const;
+
+	// Several outstanding requests (pipelining), responses are matched by transaction id
+	virtual bool pipelineSupported() const;
+	virtual qint32 frameLength(const QByteArray &data, quint32 *transactionId) const;
+	virtual quint32 lastTransactionId() const;
+	virtual WSProtocolParseCode processTransaction(quint32 transactionId, const QByteArray &frame);
+	virtual void transactionTimeout(quint32 transactionId, quint32 timeout);
+	virtual void transactionsReset();
+
+	// Parameters are spread over lanes (parallel connections) by device, lanes are polled independently
+	virtual quint32 maxLanes() const;
+	virtual void setLanes(quint32 lanes);
+	virtual const QByteArray &constructLaneRequest(quint32 lane);
+
+	// Frames have no stream envelope (e.g. RTU tunnelled over TCP), a lost or garbled response does not break the connection
+	virtual bool rawFraming() const;
+
+	// Listen-only mode, traffic of another master is decoded (silence - bus was idle after the data)
+	virtual bool monitorSupported() const;
+	virtual WSProtocolParseCode processMonitored(const QByteArray &data, bool silence);
 
 	quint32 bufferSize() const;
 
+	// Last constructed request repeats a request of the current polling cycle (the cycle is completed),
+	// the flag is cleared by the call
+	bool cycleCompleted();
+
 protected:
 	quint32 m_bufferSize;
 	std::unique_ptr<char[]> m_buffer;
 	QByteArray m_array;
+	// Requests (e.g. blocks) sent in the current cycle
+	std::vector<bool> m_cycleRequested;
+	bool m_cycleCompleted;
+
+	void cycleRequest(quint32 index);
+	void cycleReset();
 
 	virtual qint32 construct(char *data) = 0;
 };
@@ -27,6 +27,7 @@
 #include <memory>
 #include <limits>
 #include "conf.h"
+#include "modbus.h"
 
 enum class WSConversionState : quint8 {
 	OK = 0,
@@ -181,10 +182,14 @@ private:
 	qint32 m_count;
 	bool m_need_delete;
 
+	// WSByteOrder values are the same as MB_BO_* of the Modbus library
 	void convert() {
 		qint32 i;
 		if (m_size == 1) {
 			m_converted_bytes[0] = m_bytes[0];
+		} else if (m_size <= std::numeric_limits<uint16_t>::max()) {
+			// Vectorised kernels
+			modbus_convert_data(reinterpret_cast<uint8_t*>(m_bytes), reinterpret_cast<uint8_t*>(m_converted_bytes), static_cast<uint16_t>(m_size), static_cast<uint8_t>(m_order));
 		} else {
 			if (m_order == WSByteOrder::FORWARD) {
 				memcpy(m_converted_bytes, m_bytes, m_size);
@@ -0,0 +1,241 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#include "wsmodbusblockplanner.h"
+#include <algorithm>
+#include <map>
+#include <new>
+
+WSModbusBlock::WSModbusBlock(quint32 id, const std::shared_ptr<WSModbusParameter> &param) :
+	m_blockParam(nullptr, modbus_client_param_destroy),
+	m_param(param->param()),
+	m_members(1, WSModbusBlockMember{id, param, 0})
+{}
+
+WSModbusBlock::WSModbusBlock(struct modbus_client_parameter *blockParam, const std::vector<WSModbusBlockMember> &members) :
+	m_blockParam(blockParam, modbus_client_param_destroy),
+	m_param(blockParam),
+	m_members(members)
+{}
+
+modbus_client_parameter *WSModbusBlock::param() const {
+	return m_param;
+}
+
+const std::vector<WSModbusBlockMember> &WSModbusBlock::members() const {
+	return m_members;
+}
+
+bool WSModbusBlock::merged() const {
+	return m_blockParam != nullptr;
+}
+
+void WSModbusBlock::distribute() {
+	if (!merged()) {
+		return;
+	}
+	for (auto const& m: m_members) {
+		struct modbus_client_parameter *mp = m.param->param();
+		mp->err = m_param->err;
+		if (m_param->err != MB_EC_NO_ERR) {
+			continue;
+		}
+		if (WSModbusBlockPlanner::bitFunction(m_param->function_code)) {
+			// Coils/inputs are packed LSB first
+			memset(mp->value, 0, mp->size);
+			for (quint32 i = 0; i < mp->func_size; i++) {
+				quint32 bit = m.offset + i;
+				if (m_param->value[bit / 8] & (1 << (bit % 8))) {
+					mp->value[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+				}
+			}
+		} else {
+			memcpy(mp->value, m_param->value + m.offset * MB_SIZE_REGISTER, mp->size);
+		}
+	}
+}
+
+const QByteArray &WSModbusBlock::frame() const {
+	return m_frame;
+}
+
+void WSModbusBlock::compile(quint8 type) {
+	uint8_t buf[MB_SIZE_MPAB_HEADER + MB_SIZE_SIMPLE_REQUEST_PACKAGE + MB_SIZE_CRC];
+	quint8 fcode = m_param->function_code;
+	m_frame.clear();
+	// Read requests does not change between cycles (except TCP transaction id)
+	if (m_param->type == MB_ALWAYS_POLLING && m_param->func_size > 0 &&
+		(WSModbusBlockPlanner::bitFunction(fcode) || fcode == MB_FC_READ_HOLDING_REGISTERS || fcode == MB_FC_READ_INPUT_REGISTERS)) {
+		uint16_t size = modbus_client_request_package(m_param, type, buf, 0);
+		if (size > 0) {
+			m_frame = QByteArray(reinterpret_cast<const char*>(buf), size);
+		}
+	}
+}
+
+WSModbusBlockPlanner::WSModbusBlockPlanner() :
+	m_enabled(false),
+	m_gap(0)
+{}
+
+bool WSModbusBlockPlanner::enabled() const {
+	return m_enabled;
+}
+
+void WSModbusBlockPlanner::setEnabled(bool enabled) {
+	m_enabled = enabled;
+}
+
+quint16 WSModbusBlockPlanner::gap() const {
+	return m_gap;
+}
+
+void WSModbusBlockPlanner::setGap(quint16 gap) {
+	m_gap = gap;
+}
+
+bool WSModbusBlockPlanner::bitFunction(quint8 functionCode) {
+	return functionCode == MB_FC_READ_COILS || functionCode == MB_FC_READ_DICSRETE_INPUTS;
+}
+
+bool WSModbusBlockPlanner::mergeable(const WSModbusParameter *param) {
+	quint8 fcode = param->param()->function_code;
+	return param->enabled() &&
+		param->param()->type == MB_ALWAYS_POLLING &&
+		param->param()->func_size > 0 &&
+		(bitFunction(fcode) || fcode == MB_FC_READ_HOLDING_REGISTERS || fcode == MB_FC_READ_INPUT_REGISTERS);
+}
+
+std::vector<std::shared_ptr<WSModbusBlock> > WSModbusBlockPlanner::plan(const WSParametersHash<WSModbusParameter>::Snapshot &params) const {
+	std::vector<std::shared_ptr<WSModbusBlock> > blocks;
+	// Read parameters grouped by device address and function code
+	std::map<quint16, std::vector<WSModbusBlockMember> > groups;
+	for (auto const& p: params) {
+		if (m_enabled && mergeable(p.second.get())) {
+			quint16 key = static_cast<quint16>((p.second->param()->device_adr << 8) | p.second->param()->function_code);
+			groups[key].push_back(WSModbusBlockMember{p.first, p.second, 0});
+		} else {
+			blocks.emplace_back(new WSModbusBlock(p.first, p.second));
+		}
+	}
+	for (auto &g: groups) {
+		std::vector<WSModbusBlockMember> &group = g.second;
+		std::sort(group.begin(), group.end(), [](const WSModbusBlockMember &a, const WSModbusBlockMember &b) {
+			return a.param->param()->register_adr < b.param->param()->register_adr;
+		});
+		const struct modbus_client_parameter *head = group.front().param->param();
+		bool bits = bitFunction(head->function_code);
+		// Gap is set in registers, one register carries 16 coils/inputs
+		quint32 gap = bits ? m_gap * 16u : m_gap;
+		quint32 maxSize = bits ? Conf::MODBUS_MAX_READ_BITS : Conf::MODBUS_MAX_READ_REGISTERS;
+		std::vector<WSModbusBlockMember> members;
+		quint32 start = 0, end = 0;
+		for (size_t i = 0; i <= group.size(); i++) {
+			quint32 adr = 0, adrEnd = 0;
+			if (i < group.size()) {
+				adr = group[i].param->param()->register_adr;
+				adrEnd = adr + group[i].param->param()->func_size;
+				if (!members.empty() && adr <= end + gap && std::max(end, adrEnd) - start <= maxSize) {
+					members.push_back(group[i]);
+					end = std::max(end, adrEnd);
+					continue;
+				}
+			}
+			// Close current block
+			if (members.size() == 1) {
+				blocks.emplace_back(new WSModbusBlock(members.front().id, members.front().param));
+			} else if (members.size() > 1) {
+				struct modbus_client_parameter *bp = modbus_client_param_create(head->device_adr, head->function_code, static_cast<uint16_t>(start), static_cast<uint16_t>(end - start), MB_ALWAYS_POLLING);
+				if (bp == nullptr) {
+					throw std::bad_alloc();
+				}
+				// Block is polled as often as its fastest member
+				bp->period = members.front().param->param()->period;
+				bp->priority = 0;
+				for (auto &m: members) {
+					m.offset = static_cast<quint16>(m.param->param()->register_adr - start);
+					bp->period = std::min(bp->period, m.param->param()->period);
+					bp->priority = std::max(bp->priority, m.param->param()->priority);
+				}
+				std::sort(members.begin(), members.end(), [](const WSModbusBlockMember &a, const WSModbusBlockMember &b) {
+					return a.id < b.id;
+				});
+				blocks.emplace_back(new WSModbusBlock(bp, members));
+			}
+			members.clear();
+			if (i < group.size()) {
+				members.push_back(group[i]);
+				start = adr;
+				end = adrEnd;
+			}
+		}
+	}
+	// Keep polling order close to parameters order
+	std::sort(blocks.begin(), blocks.end(), [](const std::shared_ptr<WSModbusBlock> &a, const std::shared_ptr<WSModbusBlock> &b) {
+		return a->members().front().id < b->members().front().id;
+	});
+	return blocks;
+}
+
+void WSModbusBlockPlanner::inherit(const std::vector<std::shared_ptr<WSModbusBlock> > &previous, std::vector<std::shared_ptr<WSModbusBlock> > &blocks) {
+	// Device, function, first register and size of merged block
+	auto key = [](const struct modbus_client_parameter *p) {
+		return (static_cast<quint64>(p->device_adr) << 48) | (static_cast<quint64>(p->function_code) << 40) | (static_cast<quint64>(p->register_adr) << 16) | p->func_size;
+	};
+	auto sameMembers = [](const WSModbusBlock *a, const WSModbusBlock *b) {
+		return a->members().size() == b->members().size() && std::equal(a->members().begin(), a->members().end(), b->members().begin(), [](const WSModbusBlockMember &x, const WSModbusBlockMember &y) {
+			return x.id == y.id && x.param == y.param && x.offset == y.offset;
+		});
+	};
+	std::map<quint64, std::shared_ptr<WSModbusBlock> > merged;
+	for (auto const& b: previous) {
+		if (b->merged()) {
+			merged[key(b->param())] = b;
+		}
+	}
+	if (merged.empty()) {
+		return;
+	}
+	for (auto &b: blocks) {
+		if (!b->merged()) {
+			continue;
+		}
+		auto it = merged.find(key(b->param()));
+		if (it == merged.end()) {
+			continue;
+		}
+		struct modbus_client_parameter *prev = it->second->param();
+		// The same block object is kept, so its outstanding request (in flight) is matched by the response
+		if (sameMembers(it->second.get(), b.get())) {
+			prev->period = b->param()->period;
+			prev->priority = b->param()->priority;
+			b = it->second;
+			continue;
+		}
+		if (!prev->scheduled) {
+			continue;
+		}
+		b->param()->deadline = prev->deadline;
+		b->param()->polled = prev->polled;
+		b->param()->scheduled = 1;
+	}
+}
@@ -0,0 +1,97 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSMODBUSBLOCKPLANNER_H
+#define WSMODBUSBLOCKPLANNER_H
+
+#include <QtCore>
+#include <memory>
+#include <vector>
+#include "modbus.h"
+#include "wsmodbusparameter.h"
+#include "wsparametershash.h"
+#include "conf.h"
+
+/**
+ * @brief Parameter served by a block request
+ */
+struct WSModbusBlockMember {
+	quint32 id;							// Parameter id
+	std::shared_ptr<WSModbusParameter> param;	// Parameter (kept alive while the block is used)
+	quint16 offset;						// Offset from the block start (registers or bits)
+};
+
+/**
+ * @brief Single library request and the parameters it serves.
+ * Not merged block uses the parameter's own library structure.
+ */
+class WSModbusBlock {
+
+public:
+	WSModbusBlock(quint32 id, const std::shared_ptr<WSModbusParameter> &param);
+	WSModbusBlock(struct modbus_client_parameter *blockParam, const std::vector<WSModbusBlockMember> &members);
+
+	struct modbus_client_parameter *param() const;
+	const std::vector<WSModbusBlockMember> &members() const;
+	bool merged() const;
+	void distribute();
+
+	// Prebuilt request frame (static read requests only), TCP transaction id is patched in a copy
+	const QByteArray &frame() const;
+	void compile(quint8 type);
+
+private:
+	std::unique_ptr<struct modbus_client_parameter, void(*)(struct modbus_client_parameter*)> m_blockParam;
+	struct modbus_client_parameter *m_param;
+	std::vector<WSModbusBlockMember> m_members;
+	QByteArray m_frame;
+};
+
+/**
+ * @brief Groups read parameters by device address and function code
+ * and merges close register ranges into block requests
+ */
+class WSModbusBlockPlanner {
+
+public:
+	WSModbusBlockPlanner();
+
+	bool enabled() const;
+	void setEnabled(bool enabled);
+
+	quint16 gap() const;
+	void setGap(quint16 gap);
+
+	std::vector<std::shared_ptr<WSModbusBlock> > plan(const WSParametersHash<WSModbusParameter>::Snapshot &params) const;
+	// Merged blocks with the same members are replaced by the blocks of the previous plan,
+	// blocks covering the same registers keep their polling deadlines
+	static void inherit(const std::vector<std::shared_ptr<WSModbusBlock> > &previous, std::vector<std::shared_ptr<WSModbusBlock> > &blocks);
+
+	static bool mergeable(const WSModbusParameter *param);
+	static bool bitFunction(quint8 functionCode);
+
+private:
+	bool m_enabled;
+	quint16 m_gap;
+};
+
+#endif // WSMODBUSBLOCKPLANNER_H
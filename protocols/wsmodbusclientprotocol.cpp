@@ -0,0 +1,165 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#include "wsmodbusclientprotocol.h"
+
+WSModbusClientProtocol::WSModbusClientProtocol(quint8 frameType, quint32 bufferSize) :
+	WSAbstractRRProtocol(bufferSize),
+	m_frameType(frameType),
+	m_params([this](quint32 id) {paramCountChanged(id);}),
+	m_planChanged(false),
+	m_writing(false)
+{
+	m_clock.start();
+}
+
+WSParametersHash<WSModbusParameter> &WSModbusClientProtocol::params() {
+	return m_params;
+}
+
+void WSModbusClientProtocol::setBlockRead(bool enabled, quint16 gap) {
+	QMutexLocker ml(&m_planLock);
+	if (m_planner.enabled() != enabled || m_planner.gap() != gap) {
+		m_planner.setEnabled(enabled);
+		m_planner.setGap(gap);
+		m_planChanged = true;
+	}
+}
+
+bool WSModbusClientProtocol::queueWrite(quint32 id) {
+	std::shared_ptr<WSModbusParameter> p = m_params.share(id);
+	if (p == nullptr || p->pollingType() != WSPollingType::ONCE_SET) {
+		return false;
+	}
+	m_writes.enqueue(id, p, m_clock.nsecsElapsed() / 1000);
+	return true;
+}
+
+bool WSModbusClientProtocol::readyToPolling() {
+	return !m_params.isEmpty();
+}
+
+quint32 WSModbusClientProtocol::lastDevice() const {
+	if (m_writing) {
+		return m_write.request->device_adr;
+	}
+	return getCurrentBlock()->param()->device_adr;
+}
+
+// Called by the thread editing parameters, planning is deferred (bulk changes are planned once)
+void WSModbusClientProtocol::paramCountChanged(quint32) {
+	m_planChanged = true;
+}
+
+void WSModbusClientProtocol::replan() {
+	if (!m_planChanged.exchange(false)) {
+		return;
+	}
+	WSModbusBlockPlanner planner;
+	{
+		QMutexLocker ml(&m_planLock);
+		planner = m_planner;
+	}
+	std::vector<std::shared_ptr<WSModbusBlock> > blocks = planner.plan(m_params.snapshot());
+	WSModbusBlockPlanner::inherit(m_blocks, blocks);
+	struct utils_vect_handle* vect = clientParams();
+	// Replace internal (library) parameters list
+	utils_vector_clear(vect);
+	for (auto const& b: blocks) {
+		utils_vect_append(vect, b->param());
+		b->compile(m_frameType);
+	}
+	clientParamsChanged();
+	// Blocks of outstanding requests are released by their responses or timeouts
+	m_blocks.swap(blocks);
+	cycleReset();
+}
+
+WSModbusBlock *WSModbusClientProtocol::getCurrentBlock() const {
+	return m_blocks.at(clientParamCounter() - 1).get();
+}
+
+void WSModbusClientProtocol::blockRequest(const WSModbusBlock *block) {
+	for (auto const& m: block->members()) {
+		m.param->setRequestsCount(m.param->requestsCount() + 1);
+		emit parameterRequest(m.id, m.param.get());
+	}
+}
+
+void WSModbusClientProtocol::blockResponse(WSModbusBlock *block, WSProtocolParseCode code) {
+	// Split block value/error to parameters
+	block->distribute();
+	for (auto const& m: block->members()) {
+		WSModbusParameter *p = m.param.get();
+		// Valid data
+		if (code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) {
+			// Responded data
+			if (p->param()->err == MB_EC_NO_ERR) {
+				p->setResponsesCount(p->responsesCount() + 1);
+				// Unchanged value is dropped here (deadband)
+				if (p->reportChange(m_clock.elapsed())) {
+					emit parameterChanged(m.id, p);
+				}
+			// Parsed error
+			} else {
+				p->setErrorsCount(p->errorsCount() + 1);
+				emit parameterError(m.id, p);
+			}
+		// Invalid data
+		} else {
+			p->setErrorsCount(p->errorsCount() + 1);
+			emit parameterError(m.id, p);
+		}
+	}
+}
+
+void WSModbusClientProtocol::blockTimeout(const WSModbusBlock *block) {
+	for (auto const& m: block->members()) {
+		m.param->setTimeoutsCount(m.param->timeoutsCount() + 1);
+		emit parameterTimeout(m.id, m.param.get());
+	}
+}
+
+void WSModbusClientProtocol::writeRequest(const WSModbusWrite &write) {
+	write.param->setRequestsCount(write.param->requestsCount() + 1);
+	emit parameterRequest(write.id, write.param.get());
+}
+
+void WSModbusClientProtocol::writeResponse(const WSModbusWrite &write, WSProtocolParseCode code) {
+	WSModbusParameter *p = write.param.get();
+	p->param()->err = write.request->err;
+	if ((code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) && write.request->err == MB_EC_NO_ERR) {
+		p->setResponsesCount(p->responsesCount() + 1);
+		emit parameterChanged(write.id, p);
+	} else {
+		p->setErrorsCount(p->errorsCount() + 1);
+		emit parameterError(write.id, p);
+	}
+	emit parameterWritten(write.id, p, static_cast<quint32>(m_clock.nsecsElapsed() / 1000 - write.queued));
+}
+
+void WSModbusClientProtocol::writeTimeout(const WSModbusWrite &write) {
+	WSModbusParameter *p = write.param.get();
+	p->setTimeoutsCount(p->timeoutsCount() + 1);
+	emit parameterTimeout(write.id, p);
+	emit parameterWritten(write.id, p, static_cast<quint32>(m_clock.nsecsElapsed() / 1000 - write.queued));
+}
@@ -0,0 +1,95 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSMODBUSCLIENTPROTOCOL_H
+#define WSMODBUSCLIENTPROTOCOL_H
+
+#include <memory>
+#include <atomic>
+#include <vector>
+#include "modbus.h"
+#include "libdefs.h"
+#include "wsabstractrrprotocol.h"
+#include "wsmodbusparameter.h"
+#include "wsparametershash.h"
+#include "wsmodbusblockplanner.h"
+#include "wsmodbuswritequeue.h"
+
+// Parameters, block planning and queued writes of Modbus client, shared by the transport protocols (RTU, TCP).
+// Transport protocol owns the library client handle and selects the polled block.
+class WSModbusClientProtocol : public WSAbstractRRProtocol {
+Q_OBJECT
+
+public:
+	// Frame type is MB_RTU or MB_TCP
+	WSModbusClientProtocol(quint8 frameType, quint32 bufferSize);
+
+	WSParametersHash<WSModbusParameter> &params();
+	void setBlockRead(bool enabled, quint16 gap);
+	// Current value of the write parameter is written ahead of the polling cycle
+	bool queueWrite(quint32 id);
+
+	bool readyToPolling() override;
+	quint32 lastDevice() const override;
+
+protected:
+	quint8 m_frameType;
+	WSParametersHash<WSModbusParameter> m_params;
+	WSModbusBlockPlanner m_planner;
+	QElapsedTimer m_clock;
+	std::vector<std::shared_ptr<WSModbusBlock> > m_blocks;
+	// Parameters or planner settings are changed, the polling thread adopts the new plan before the next request
+	std::atomic<bool> m_planChanged;
+	mutable QMutex m_planLock;
+	WSModbusWriteQueue m_writes;
+	// Last request is the queued write
+	bool m_writing;
+	WSModbusWrite m_write;
+
+	// Library parameters list of the client (replaced by the plan) and the polling counter
+	virtual struct utils_vect_handle *clientParams() const = 0;
+	virtual void clientParamsChanged() = 0;
+	virtual quint16 clientParamCounter() const = 0;
+
+	// Called by the polling thread between requests, the polling cycle continues with the new plan
+	void replan();
+	WSModbusBlock *getCurrentBlock() const;
+	void blockRequest(const WSModbusBlock *block);
+	void blockResponse(WSModbusBlock *block, WSProtocolParseCode code);
+	void blockTimeout(const WSModbusBlock *block);
+	void writeRequest(const WSModbusWrite &write);
+	void writeResponse(const WSModbusWrite &write, WSProtocolParseCode code);
+	void writeTimeout(const WSModbusWrite &write);
+
+private:
+	void paramCountChanged(quint32 id);
+
+signals:
+	void parameterChanged(quint32 id, WSModbusParameter *param);
+	void parameterError(quint32 id, WSModbusParameter *param);
+	void parameterTimeout(quint32 id, WSModbusParameter *param);
+	void parameterRequest(quint32 id, WSModbusParameter *param);
+	// Queued write is finished (response, error or timeout), latency in us since queueing
+	void parameterWritten(quint32 id, WSModbusParameter *param, quint32 latency);
+};
+
+#endif // WSMODBUSCLIENTPROTOCOL_H
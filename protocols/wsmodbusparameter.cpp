@@ -20,6 +20,7 @@
 
 ****************************************************************************/
 
+#include <cmath>
 #include "wsmodbusparameter.h"
 #include "wsabstractrrprotocol.h"
 
@@ -46,11 +47,20 @@ WSModbusParameter::WSModbusParameter(QString alias,
 	m_errorsCount(0),
 	m_timeoutsCount(0),
 	m_param(modbus_client_param_create(deviceAdr, funcCode, regAdr, funcSize, static_cast<quint8>(pollingType)), modbus_client_param_destroy),
-	m_lastPollingType(static_cast<quint8>(pollingType))
+	m_lastPollingType(static_cast<quint8>(pollingType)),
+	m_deadband(WSDeadband::NONE),
+	m_deadbandValue(0),
+	m_heartbeat(0),
+	m_reported(false),
+	m_reportTime(0),
+	m_reportFailures(0)
 {
 	if (m_param == nullptr) {
 		throw std::bad_alloc();
 	}
+	m_reportBytes.resize(m_param->size);
+	m_reportValues.resize(m_param->size);
+	m_convertBytes.resize(m_param->size);
 }
 
 quint32 WSModbusParameter::timeoutsCount() const {
@@ -91,6 +101,7 @@ WSByteOrder WSModbusParameter::dataByteOrder() const {
 
 void WSModbusParameter::setDataByteOrder(const WSByteOrder &dataByteOrder) {
 	m_dataByteOrder = dataByteOrder;
+	m_reported = false;
 }
 
 QString WSModbusParameter::alias() const {
@@ -117,6 +128,11 @@ void WSModbusParameter::setEnabled(bool enabled) {
 		m_timeoutsCount = 0;
 	}
 	m_enabled = enabled;
+	m_reported = false;
+}
+
+WSPollingType WSModbusParameter::pollingType() const {
+	return static_cast<WSPollingType>(m_enabled ? m_param->type : m_lastPollingType);
 }
 
 quint8 WSModbusParameter::dataTypeSize() const {
@@ -125,6 +141,7 @@ quint8 WSModbusParameter::dataTypeSize() const {
 
 void WSModbusParameter::setDataTypeSize(const quint8 &dataTypeSize) {
 	m_dataTypeSize = dataTypeSize;
+	m_reported = false;
 }
 
 WSDataType WSModbusParameter::dataType() const {
@@ -133,6 +150,7 @@ WSDataType WSModbusParameter::dataType() const {
 
 void WSModbusParameter::setDataType(const WSDataType &dataType) {
 	m_dataType = dataType;
+	m_reported = false;
 }
 
 modbus_client_parameter *WSModbusParameter::param() const {
@@ -145,6 +163,7 @@ WSDataRepresent WSModbusParameter::dataRepresent() const {
 
 void WSModbusParameter::setDataRepresent(const WSDataRepresent &dataRepresent) {
 	m_dataRepresent = dataRepresent;
+	m_reported = false;
 }
 
 bool WSModbusParameter::dataSigned() const {
@@ -153,4 +172,136 @@ bool WSModbusParameter::dataSigned() const {
 
 void WSModbusParameter::setDataSigned(bool dataSigned) {
 	m_dataSigned = dataSigned;
+	m_reported = false;
+}
+
+quint32 WSModbusParameter::period() const {
+	return m_param->period;
+}
+
+void WSModbusParameter::setPeriod(quint32 period) {
+	m_param->period = period;
+}
+
+quint8 WSModbusParameter::priority() const {
+	return m_param->priority;
+}
+
+void WSModbusParameter::setPriority(quint8 priority) {
+	m_param->priority = priority;
+}
+
+WSDeadband WSModbusParameter::deadband() const {
+	return m_deadband;
+}
+
+void WSModbusParameter::setDeadband(WSDeadband deadband) {
+	m_deadband = deadband;
+	m_reported = false;
+}
+
+double WSModbusParameter::deadbandValue() const {
+	return m_deadbandValue;
+}
+
+void WSModbusParameter::setDeadbandValue(double deadbandValue) {
+	m_deadbandValue = deadbandValue;
+	m_reported = false;
+}
+
+quint32 WSModbusParameter::heartbeat() const {
+	return m_heartbeat;
+}
+
+void WSModbusParameter::setHeartbeat(quint32 heartbeat) {
+	m_heartbeat = heartbeat;
+}
+
+bool WSModbusParameter::reportChange(qint64 now) {
+	if (m_deadband == WSDeadband::NONE) {
+		return true;
+	}
+	quint8 *value = m_param->value;
+	quint16 size = m_param->size;
+	quint32 failures = m_errorsCount + m_timeoutsCount;
+	bool report = !m_reported || failures != m_reportFailures || (m_heartbeat > 0 && now - m_reportTime >= m_heartbeat);
+	// Identical bytes are dropped without conversion
+	if (!report && memcmp(m_reportBytes.data(), value, size) == 0) {
+		return false;
+	}
+	// View may be edited by the GUI thread
+	quint8 typeSize = m_dataTypeSize;
+	bool numeric = numericDeadband(typeSize);
+	quint32 count = numeric ? size / typeSize : 0;
+	if (numeric) {
+		if (size == 1) {
+			m_convertBytes[0] = value[0];
+		} else {
+			modbus_convert_data(value, m_convertBytes.data(), size, static_cast<uint8_t>(m_dataByteOrder));
+		}
+		for (quint32 i = 0; i < count && !report; i++) {
+			double v = numericValue(&m_convertBytes[i * typeSize], typeSize);
+			double last = m_reportValues[i];
+			double limit = (m_deadband == WSDeadband::ABSOLUTE) ? m_deadbandValue : std::fabs(last) * m_deadbandValue / 100.0;
+			report = std::fabs(v - last) > limit || std::isnan(v) != std::isnan(last);
+		}
+	} else {
+		report = true;
+	}
+	if (report) {
+		memcpy(m_reportBytes.data(), value, size);
+		for (quint32 i = 0; i < count; i++) {
+			m_reportValues[i] = numericValue(&m_convertBytes[i * typeSize], typeSize);
+		}
+		m_reported = true;
+		m_reportTime = now;
+		m_reportFailures = failures;
+	}
+	return report;
+}
+
+// Deadband value is applied to the integer and floating point views, other views are compared by bytes
+bool WSModbusParameter::numericDeadband(quint8 typeSize) const {
+	if (m_deadband == WSDeadband::RAW || m_param->size == 0) {
+		return false;
+	}
+	if (m_dataType == WSDataType::INTEGER) {
+		if (typeSize != 1 && typeSize != 2 && typeSize != 4 && typeSize != 8) {
+			return false;
+		}
+	} else if (m_dataType == WSDataType::FLOAT) {
+		if (typeSize != 4 && typeSize != 8) {
+			return false;
+		}
+	} else {
+		return false;
+	}
+	return m_param->size % typeSize == 0;
+}
+
+double WSModbusParameter::numericValue(const quint8 *bytes, quint8 typeSize) const {
+	if (m_dataType == WSDataType::FLOAT) {
+		if (typeSize == 4) {
+			float v;
+			memcpy(&v, bytes, sizeof(v));
+			return static_cast<double>(v);
+		}
+		double v;
+		memcpy(&v, bytes, sizeof(v));
+		return v;
+	}
+	if (typeSize == 1) {
+		return m_dataSigned ? static_cast<double>(static_cast<qint8>(bytes[0])) : static_cast<double>(bytes[0]);
+	} else if (typeSize == 2) {
+		quint16 v;
+		memcpy(&v, bytes, sizeof(v));
+		return m_dataSigned ? static_cast<double>(static_cast<qint16>(v)) : static_cast<double>(v);
+	} else if (typeSize == 4) {
+		quint32 v;
+		memcpy(&v, bytes, sizeof(v));
+		return m_dataSigned ? static_cast<double>(static_cast<qint32>(v)) : static_cast<double>(v);
+	}
+	quint64 v;
+	memcpy(&v, bytes, sizeof(v));
+	return m_dataSigned ? static_cast<double>(static_cast<qint64>(v)) : static_cast<double>(v);
 }
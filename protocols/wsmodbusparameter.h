@@ -29,6 +29,19 @@
 #include "wsdataconverter.h"
 #include "wsabstractrrprotocol.h"
 #include <memory>
+#include <vector>
+
+// Report-by-exception filter of the valid responses
+enum class WSDeadband : quint8 {
+	// Every response is reported
+	NONE = 0,
+	// Raw bytes are changed
+	RAW = 1,
+	// Numeric value is changed more than by the deadband value
+	ABSOLUTE = 2,
+	// Numeric value is changed more than by the deadband value (% of the last reported value)
+	PERCENT = 3
+};
 
 enum class WSModbusExtendedError : qint16 {
 	TIMEOUT = -5,
@@ -79,6 +92,8 @@ public:
 
 	bool enabled() const;
 	void setEnabled(bool enabled);
+	// Configured polling type (kept while the parameter is disabled)
+	WSPollingType pollingType() const;
 
 	quint8 dataTypeSize() const;
 	void setDataTypeSize(const quint8 &dataTypeSize);
@@ -94,6 +109,26 @@ public:
 	bool dataSigned() const;
 	void setDataSigned(bool dataSigned);
 
+	quint32 period() const;
+	void setPeriod(quint32 period);
+
+	quint8 priority() const;
+	void setPriority(quint8 priority);
+
+	WSDeadband deadband() const;
+	void setDeadband(WSDeadband deadband);
+
+	double deadbandValue() const;
+	void setDeadbandValue(double deadbandValue);
+
+	// Max time without report of the unchanged value, ms (0 - not limited)
+	quint32 heartbeat() const;
+	void setHeartbeat(quint32 heartbeat);
+
+	// Valid response is reported: value left the deadband, heartbeat is due or failures occurred since the last report.
+	// Called by the polling thread before any conversion, now - ms of the protocol clock
+	bool reportChange(qint64 now);
+
 private:
 	bool m_enabled;
 
@@ -109,6 +144,20 @@ private:
 	quint32 m_timeoutsCount;
 	std::unique_ptr<struct modbus_client_parameter, void(*)(struct modbus_client_parameter*)> m_param;
 	quint8 m_lastPollingType;
+	WSDeadband m_deadband;
+	double m_deadbandValue;
+	quint32 m_heartbeat;
+	// Last reported state (false - the next response is reported)
+	bool m_reported;
+	qint64 m_reportTime;
+	quint32 m_reportFailures;
+	// Preallocated for the parameter size
+	std::vector<quint8> m_reportBytes;
+	std::vector<double> m_reportValues;
+	std::vector<quint8> m_convertBytes;
+
+	bool numericDeadband(quint8 typeSize) const;
+	double numericValue(const quint8 *bytes, quint8 typeSize) const;
 };
 
 #endif // WSMODBUSPARAMETER_H
@@ -23,103 +23,176 @@
 #include "wsmodbusrtuprotocol.h"
 
 WSModbusRTUProtocol::WSModbusRTUProtocol(quint32 bufferSize) :
-	WSAbstractRRProtocol(bufferSize),
+	WSModbusClientProtocol(MB_RTU, bufferSize),
 	m_hModbusClient(modbus_client_rtu_create(), modbus_client_rtu_destroy),
-	m_params([this](quint32 id) {paramCountChanged(id);})
+	m_hMonitor(modbus_rtu_monitor_create(), modbus_rtu_monitor_destroy)
 {
-	if (m_hModbusClient.get() == nullptr) {
+	if (m_hModbusClient.get() == nullptr || m_hMonitor.get() == nullptr) {
 		throw std::bad_alloc();
 	}
+	modbus_client_rtu_health_setup(m_hModbusClient.get(), Conf::MODBUS_QUARANTINE_TIMEOUTS, Conf::MODBUS_QUARANTINE_PROBE_MIN, Conf::MODBUS_QUARANTINE_PROBE_MAX);
 }
 
 WSRRProtocol WSModbusRTUProtocol::type() const {
 	return WSRRProtocol::MODBUS_RTU;
 }
 
-qint32 WSModbusRTUProtocol::construct(char *data) {
-	quint16 size = 0;
-	modbus_client_rtu_request(m_hModbusClient.get(), reinterpret_cast<uint8_t*>(data), &size);
-	if (size > 0) {
-		quint32 pid;
-		WSModbusParameter *p;
-		pid = getCurrentParamId();
-		p = m_params.get(pid);
-		p->setRequestsCount(p->requestsCount() + 1);
-		emit parameterRequest(pid, p);
+const QByteArray &WSModbusRTUProtocol::constructRequest() {
+	m_array = QByteArray();
+	replan();
+	// Queued setpoint takes the slot ahead of the polling cycle, the cycle continues from the same place
+	m_writing = m_writes.take(m_write);
+	if (m_writing) {
+		WSAbstractRRProtocol::constructRequest();
+		if (m_array.size() > 0) {
+			writeRequest(m_write);
+		}
+		return m_array;
+	}
+	qint32 index = modbus_client_rtu_next(m_hModbusClient.get(), static_cast<quint32>(m_clock.elapsed()));
+	// Nothing is due yet
+	if (index == MB_SCHED_IDLE) {
+		return m_array;
+	}
+	WSModbusBlock *b = m_blocks.at(static_cast<quint32>(index)).get();
+	if (b->param()->type == MB_NO_POLLING) {
+		return m_array;
 	}
-	return size;
+	if (b->frame().isEmpty()) {
+		WSAbstractRRProtocol::constructRequest();
+	} else {
+		m_array = b->frame();
+	}
+	if (m_array.size() > 0) {
+		cycleRequest(static_cast<quint32>(index));
+		blockRequest(b);
+	}
+	return m_array;
 }
 
-WSParametersHash<WSModbusParameter> &WSModbusRTUProtocol::params() {
-	return m_params;
+qint32 WSModbusRTUProtocol::construct(char *data) {
+	const struct modbus_client_parameter *param = m_writing ? m_write.request.get() : getCurrentBlock()->param();
+	return modbus_client_request_package(param, MB_RTU, reinterpret_cast<uint8_t*>(data), 0);
 }
 
 WSProtocolParseCode WSModbusRTUProtocol::processResponse(const QByteArray &data) {
 	WSProtocolParseCode code = WSProtocolParseCode::INCORRECT;
 	char *d = const_cast<char*>(data.data());
+	if (m_writing) {
+		code = static_cast<WSProtocolParseCode>(modbus_client_param_response(m_write.request.get(), MB_RTU, 0, reinterpret_cast<uint8_t*>(d), static_cast<int16_t>(data.size())));
+		if (code != WSProtocolParseCode::INCOMPLETE) {
+			writeResponse(m_write, code);
+		}
+		return code;
+	}
 	code = static_cast<WSProtocolParseCode>(modbus_client_rtu_response(m_hModbusClient.get(), reinterpret_cast<uint8_t*>(d), static_cast<uint16_t>(data.size())));
-	// Get id from index
-	quint32 pid;
-	WSModbusParameter *p;
-	pid = getCurrentParamId();
-	p = m_params.get(pid);
-	// Valid data
+	if (code == WSProtocolParseCode::INCOMPLETE) {
+		return code;
+	}
 	if (code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) {
-		// Responded data
-		if (p->param()->err == MB_EC_NO_ERR) {
-			p->setResponsesCount(p->responsesCount() + 1);
-			emit parameterChanged(pid, p);
-		// Parsed error
-		} else {
-			p->setErrorsCount(p->errorsCount() + 1);
-			emit parameterError(pid, p);
-		}
-	// Invalid data
-	} else if (code != WSProtocolParseCode::INCOMPLETE) {
-		p->setErrorsCount(p->errorsCount() + 1);
-		emit parameterError(pid, p);
+		healthReport(true);
 	}
+	blockResponse(getCurrentBlock(), code);
 	return code;
 }
 
 void WSModbusRTUProtocol::resetToDefault() {
 	modbus_client_rtu_reset(m_hModbusClient.get());
+	modbus_rtu_monitor_reset(m_hMonitor.get());
+	for (auto const& b: m_blocks) {
+		b->distribute();
+	}
 }
 
-void WSModbusRTUProtocol::paramCountChanged(quint32) {
-	struct utils_vect_handle* vect = m_hModbusClient->params;
-	// Clear internal (library) parameters list
-	utils_vector_clear(vect);
-	// Clear indexes vector
-	m_paramIdToLibIndex.clear();
-	for (auto const& p: m_params) {
-		// Add parameter into library
-		utils_vect_append(vect, p.second->param());
-		// Add index
-		m_paramIdToLibIndex.append(p.first);
-	}
-	resetToDefault();
+struct utils_vect_handle *WSModbusRTUProtocol::clientParams() const {
+	return m_hModbusClient->params;
 }
 
-quint32 WSModbusRTUProtocol::getParamIdFromLibIndex(int id) const {
-	return m_paramIdToLibIndex.at(id);
+void WSModbusRTUProtocol::clientParamsChanged() {
+	modbus_client_rtu_params_changed(m_hModbusClient.get());
 }
 
-quint32 WSModbusRTUProtocol::getCurrentParamId() const {
-	return getParamIdFromLibIndex(m_hModbusClient->param_counter - 1);
+quint16 WSModbusRTUProtocol::clientParamCounter() const {
+	return m_hModbusClient->param_counter;
 }
 
 void WSModbusRTUProtocol::timeoutOccurred(quint32) {
-	// Get id from index
-	quint32 pid;
-	WSModbusParameter *p;
-	pid = getCurrentParamId();
-	p = m_params.get(pid);
-	p->setTimeoutsCount(p->timeoutsCount() + 1);
-	emit parameterTimeout(pid, m_params.get(pid));
+	// Write does not count against the device health, the polling does
+	if (m_writing) {
+		writeTimeout(m_write);
+		m_writing = false;
+		return;
+	}
+	blockTimeout(getCurrentBlock());
+	healthReport(false);
 }
 
-bool WSModbusRTUProtocol::readyToPolling() {
-	return (m_params.begin() != m_params.end());
+// Dead slave circuit breaker, parameters of quarantined device are polled by rare probes only
+void WSModbusRTUProtocol::healthReport(bool responded) {
+	quint8 device = getCurrentBlock()->param()->device_adr;
+	quint8 health = modbus_client_rtu_health_report(m_hModbusClient.get(), device, responded ? 1 : 0, static_cast<quint32>(m_clock.elapsed()));
+	if (health == MB_HEALTH_QUARANTINED) {
+		emit deviceHealthChanged(device, false);
+	} else if (health == MB_HEALTH_RESTORED) {
+		emit deviceHealthChanged(device, true);
+	}
+}
+
+// Written request is dropped with the transport state, queued writes are kept
+void WSModbusRTUProtocol::transactionsReset() {
+	m_writing = false;
+}
+
+bool WSModbusRTUProtocol::rawFraming() const {
+	return true;
+}
+
+bool WSModbusRTUProtocol::monitorSupported() const {
+	return true;
 }
 
+WSProtocolParseCode WSModbusRTUProtocol::processMonitored(const QByteArray &data, bool silence) {
+	const uint8_t *d = reinterpret_cast<const uint8_t*>(data.constData());
+	replan();
+	quint32 dropped = m_hMonitor->dropped;
+	bool decoded = false;
+	qint32 pos = 0;
+	// Buffer may be full, decode frames and feed the rest
+	do {
+		pos += modbus_rtu_monitor_feed(m_hMonitor.get(), d + pos, static_cast<uint16_t>(qMin(data.size() - pos, MB_SIZE_RTU_MONITOR_BUFFER)));
+		decoded = monitorDecode(silence && pos == data.size()) || decoded;
+	} while (pos < data.size());
+	if (m_hMonitor->dropped != dropped) {
+		return WSProtocolParseCode::INCORRECT;
+	}
+	return decoded ? WSProtocolParseCode::VALID : WSProtocolParseCode::INCOMPLETE;
+}
+
+bool WSModbusRTUProtocol::monitorDecode(bool silence) {
+	bool decoded = false;
+	int8_t type;
+	while ((type = modbus_rtu_monitor_next(m_hMonitor.get(), silence ? 1 : 0)) != DEF_PKG_INCOMPLETE) {
+		decoded = true;
+		if (type != MB_MONITOR_RESPONSE) {
+			continue;
+		}
+		// Response of other master request, update covered parameters (every parameter is a member of one block)
+		for (auto const& b: m_blocks) {
+			for (auto const& m: b->members()) {
+				WSModbusParameter *p = m.param.get();
+				if (modbus_client_monitor_response(p->param(), m_hMonitor.get())) {
+					if (p->param()->err == MB_EC_NO_ERR) {
+						p->setResponsesCount(p->responsesCount() + 1);
+						if (p->reportChange(m_clock.elapsed())) {
+							emit parameterChanged(m.id, p);
+						}
+					} else {
+						p->setErrorsCount(p->errorsCount() + 1);
+						emit parameterError(m.id, p);
+					}
+				}
+			}
+		}
+	}
+	return decoded;
+}
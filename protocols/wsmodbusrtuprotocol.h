@@ -27,40 +27,40 @@
 #include <memory>
 #include "modbus.h"
 #include "libdefs.h"
-#include "wsabstractrrprotocol.h"
-#include "wsmodbusparameter.h"
-#include "wsparametershash.h"
+#include "wsmodbusclientprotocol.h"
 
-class WSModbusRTUProtocol : public WSAbstractRRProtocol {
+class WSModbusRTUProtocol : public WSModbusClientProtocol {
 Q_OBJECT
 
 public:
 	WSModbusRTUProtocol(quint32 bufferSize = 255);
+	virtual const QByteArray &constructRequest() override;
 	virtual WSProtocolParseCode processResponse(const QByteArray &data) override;
 	virtual void resetToDefault() override;
 	virtual WSRRProtocol type() const override;
 
-	WSParametersHash<WSModbusParameter> &params();
-
 	void timeoutOccurred(quint32 timeout) override;
-	bool readyToPolling() override;
+
+	bool rawFraming() const override;
+	bool monitorSupported() const override;
+	WSProtocolParseCode processMonitored(const QByteArray &data, bool silence) override;
+	void transactionsReset() override;
 
 private:
 	std::unique_ptr<struct modbus_rtu_client_handle, void(*)(struct modbus_rtu_client_handle*)> m_hModbusClient;
-	WSParametersHash<WSModbusParameter> m_params;
-	QVector<quint32> m_paramIdToLibIndex;
-	void paramCountChanged(quint32 id);
-	quint32 getParamIdFromLibIndex(int id) const;
-	quint32 getCurrentParamId() const;
+	std::unique_ptr<struct modbus_rtu_monitor, void(*)(struct modbus_rtu_monitor*)> m_hMonitor;
+	bool monitorDecode(bool silence);
+	void healthReport(bool responded);
 
 protected:
 	virtual qint32 construct(char *data) override;
+	struct utils_vect_handle *clientParams() const override;
+	void clientParamsChanged() override;
+	quint16 clientParamCounter() const override;
 
 signals:
-	void parameterChanged(quint32 id, WSModbusParameter *param);
-	void parameterError(quint32 id, WSModbusParameter *param);
-	void parameterTimeout(quint32 id, WSModbusParameter *param);
-	void parameterRequest(quint32 id, WSModbusParameter *param);
+	// Device is quarantined (not responding) or restored
+	void deviceHealthChanged(quint32 device, bool alive);
 };
 
 #endif // WSMODBUSRTUPROTOCOL_H
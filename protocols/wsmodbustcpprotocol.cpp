@@ -23,9 +23,9 @@
 #include "wsmodbustcpprotocol.h"
 
 WSModbusTCPProtocol::WSModbusTCPProtocol(quint32 bufferSize) :
-	WSAbstractRRProtocol(bufferSize),
+	WSModbusClientProtocol(MB_TCP, bufferSize),
 	m_hModbusClient(modbus_client_tcp_create(), modbus_client_tcp_destroy),
-	m_params([this](quint32 id) {paramCountChanged(id);})
+	m_lastTransactionId(0)
 {
 	if (m_hModbusClient.get() == nullptr) {
 		throw std::bad_alloc();
@@ -36,89 +36,182 @@ WSRRProtocol WSModbusTCPProtocol::type() const {
 	return WSRRProtocol::MODBUS_TCP;
 }
 
-qint32 WSModbusTCPProtocol::construct(char *data) {
-	quint16 size = 0;
-	modbus_client_tcp_request(m_hModbusClient.get(), reinterpret_cast<uint8_t*>(data), &size);
-	if (size > 0) {
-		quint32 pid;
-		WSModbusParameter *p;
-		pid = getCurrentParamId();
-		p = m_params.get(pid);
-		p->setRequestsCount(p->requestsCount() + 1);
-		emit parameterRequest(pid, p);
+const QByteArray &WSModbusTCPProtocol::constructRequest() {
+	return constructLaneRequest(0);
+}
+
+const QByteArray &WSModbusTCPProtocol::constructLaneRequest(quint32 lane) {
+	struct modbus_tcp_client_handle *client = m_hModbusClient.get();
+	m_array = QByteArray();
+	replan();
+	// Queued setpoint takes the next free slot of its device lane, the polling cycle continues from the same place
+	m_writing = !m_writes.isEmpty() && m_writes.take(m_write, [client, lane](quint8 device) {return modbus_client_tcp_lane(client, device) == lane;});
+	if (m_writing) {
+		m_lastTransactionId = client->transaction_id++;
+		m_write.transactionId = m_lastTransactionId;
+		WSAbstractRRProtocol::constructRequest();
+		if (m_array.size() > 0) {
+			m_writeTransactions.insert(m_lastTransactionId, m_write);
+			writeRequest(m_write);
+		}
+		return m_array;
+	}
+	qint32 index = modbus_client_tcp_lane_next(client, static_cast<uint8_t>(lane), static_cast<quint32>(m_clock.elapsed()), &m_lastTransactionId);
+	// Nothing is due yet, blocks waiting for response are skipped by scheduler (pipelining)
+	if (index == MB_SCHED_IDLE) {
+		return m_array;
 	}
-	return size;
+	WSModbusBlock *b = m_blocks.at(static_cast<quint32>(index)).get();
+	if (b->param()->type == MB_NO_POLLING) {
+		return m_array;
+	}
+	if (b->frame().isEmpty()) {
+		WSAbstractRRProtocol::constructRequest();
+	} else {
+		// Cached frame is copied to the request buffer and patched there, it is never shared or detached
+		const QByteArray &frame = b->frame();
+		memcpy(m_buffer.get(), frame.constData(), static_cast<size_t>(frame.size()));
+		modbus_client_tcp_transaction_set(reinterpret_cast<uint8_t*>(m_buffer.get()), m_lastTransactionId);
+		m_array = QByteArray::fromRawData(m_buffer.get(), frame.size());
+	}
+	if (m_array.size() > 0) {
+		cycleRequest(static_cast<quint32>(index));
+		m_transactions.insert(m_lastTransactionId, m_blocks.at(static_cast<quint32>(index)));
+		b->param()->in_flight = 1;
+		blockRequest(b);
+	}
+	return m_array;
 }
 
-WSParametersHash<WSModbusParameter> &WSModbusTCPProtocol::params() {
-	return m_params;
+qint32 WSModbusTCPProtocol::construct(char *data) {
+	const struct modbus_client_parameter *param = m_writing ? m_write.request.get() : getCurrentBlock()->param();
+	return modbus_client_request_package(param, MB_TCP, reinterpret_cast<uint8_t*>(data), m_lastTransactionId);
 }
 
 WSProtocolParseCode WSModbusTCPProtocol::processResponse(const QByteArray &data) {
 	WSProtocolParseCode code = WSProtocolParseCode::INCORRECT;
 	char *d = const_cast<char*>(data.data());
-	code = static_cast<WSProtocolParseCode>(modbus_client_tcp_response(m_hModbusClient.get(), reinterpret_cast<uint8_t*>(d), static_cast<uint16_t>(data.size())));
-	// Get id from index
-	quint32 pid;
-	WSModbusParameter *p;
-	pid = getCurrentParamId();
-	p = m_params.get(pid);
-	// Valid data
-	if (code == WSProtocolParseCode::VALID || code == WSProtocolParseCode::VALID_BROADCAST) {
-		// Responded data
-		if (p->param()->err == MB_EC_NO_ERR) {
-			p->setResponsesCount(p->responsesCount() + 1);
-			emit parameterChanged(pid, p);
-		// Parsed error
-		} else {
-			p->setErrorsCount(p->errorsCount() +1);
-			emit parameterError(pid, p);
+	if (m_writing) {
+		code = static_cast<WSProtocolParseCode>(modbus_client_param_response(m_write.request.get(), MB_TCP, m_write.transactionId, reinterpret_cast<uint8_t*>(d), static_cast<int16_t>(data.size())));
+		if (code != WSProtocolParseCode::INCOMPLETE && m_writeTransactions.remove(m_write.transactionId) > 0) {
+			writeResponse(m_write, code);
 		}
-	// Invalid data
-	} else if (code != WSProtocolParseCode::INCOMPLETE) {
-		p->setErrorsCount(p->errorsCount() +1);
-		emit parameterError(pid, p);
+		return code;
 	}
+	code = static_cast<WSProtocolParseCode>(modbus_client_tcp_response(m_hModbusClient.get(), reinterpret_cast<uint8_t*>(d), static_cast<uint16_t>(data.size())));
+	if (code == WSProtocolParseCode::INCOMPLETE) {
+		return code;
+	}
+	clearTransactions();
+	blockResponse(getCurrentBlock(), code);
 	return code;
 }
 
 void WSModbusTCPProtocol::resetToDefault() {
 	modbus_client_tcp_reset(m_hModbusClient.get());
+	clearTransactions();
+	m_writeTransactions.clear();
+	m_writing = false;
+	for (auto const& b: m_blocks) {
+		b->distribute();
+	}
 }
 
-void WSModbusTCPProtocol::paramCountChanged(quint32) {
-	struct utils_vect_handle* vect = m_hModbusClient->params;
-	// Clear internal (library) parameters list
-	utils_vector_clear(vect);
-	// Clear indexes vector
-	m_paramIdToLibIndex.clear();
-	for (auto const& p: m_params) {
-		// Add parameter into library
-		utils_vect_append(vect, p.second->param());
-		// Add index
-		m_paramIdToLibIndex.append(p.first);
-	}
-	resetToDefault();
+struct utils_vect_handle *WSModbusTCPProtocol::clientParams() const {
+	return m_hModbusClient->params;
 }
 
-quint32 WSModbusTCPProtocol::getParamIdFromLibIndex(int id) const {
-	return m_paramIdToLibIndex.at(id);
+void WSModbusTCPProtocol::clientParamsChanged() {
+	modbus_client_tcp_params_changed(m_hModbusClient.get());
 }
 
-quint32 WSModbusTCPProtocol::getCurrentParamId() const {
-	return getParamIdFromLibIndex(m_hModbusClient->param_counter - 1);
+quint16 WSModbusTCPProtocol::clientParamCounter() const {
+	return m_hModbusClient->param_counter;
 }
 
 void WSModbusTCPProtocol::timeoutOccurred(quint32) {
-	// Get id from index
-	quint32 pid;
-	WSModbusParameter *p;
-	pid = getCurrentParamId();
-	p = m_params.get(pid);
-	p->setTimeoutsCount(p->timeoutsCount() + 1);
-	emit parameterTimeout(pid, m_params.get(pid));
+	// All outstanding requests are lost
+	for (auto const& b: m_transactions) {
+		blockTimeout(b.get());
+	}
+	clearTransactions();
+	for (auto const& w: m_writeTransactions) {
+		writeTimeout(w);
+	}
+	m_writeTransactions.clear();
+}
+
+bool WSModbusTCPProtocol::pipelineSupported() const {
+	return true;
+}
+
+qint32 WSModbusTCPProtocol::frameLength(const QByteArray &data, quint32 *transactionId) const {
+	quint16 tid = 0;
+	qint32 len = modbus_tcp_package_length(reinterpret_cast<const uint8_t*>(data.constData()), static_cast<uint16_t>(qMin(data.size(), 0xFFFF)), &tid);
+	*transactionId = tid;
+	return len;
+}
+
+quint32 WSModbusTCPProtocol::lastTransactionId() const {
+	return m_lastTransactionId;
+}
+
+WSProtocolParseCode WSModbusTCPProtocol::processTransaction(quint32 transactionId, const QByteArray &frame) {
+	auto w = m_writeTransactions.find(static_cast<quint16>(transactionId));
+	if (w != m_writeTransactions.end()) {
+		WSModbusWrite write = w.value();
+		m_writeTransactions.erase(w);
+		WSProtocolParseCode code = static_cast<WSProtocolParseCode>(modbus_client_param_response(write.request.get(), MB_TCP, write.transactionId, reinterpret_cast<const uint8_t*>(frame.constData()), static_cast<int16_t>(frame.size())));
+		writeResponse(write, code);
+		return code;
+	}
+	auto it = m_transactions.find(static_cast<quint16>(transactionId));
+	// Late or unknown response
+	if (it == m_transactions.end()) {
+		return WSProtocolParseCode::INCORRECT;
+	}
+	std::shared_ptr<WSModbusBlock> b = it.value();
+	m_transactions.erase(it);
+	b->param()->in_flight = 0;
+	WSProtocolParseCode code = static_cast<WSProtocolParseCode>(modbus_client_tcp_transaction_response(b->param(), reinterpret_cast<const uint8_t*>(frame.constData()), static_cast<int16_t>(frame.size())));
+	blockResponse(b.get(), code);
+	return code;
 }
 
-bool WSModbusTCPProtocol::readyToPolling() {
-	return (m_params.begin() != m_params.end());
+void WSModbusTCPProtocol::transactionTimeout(quint32 transactionId, quint32) {
+	auto w = m_writeTransactions.find(static_cast<quint16>(transactionId));
+	if (w != m_writeTransactions.end()) {
+		writeTimeout(w.value());
+		m_writeTransactions.erase(w);
+		return;
+	}
+	auto it = m_transactions.find(static_cast<quint16>(transactionId));
+	if (it != m_transactions.end()) {
+		blockTimeout(it.value().get());
+		it.value()->param()->in_flight = 0;
+		m_transactions.erase(it);
+	}
+}
+
+// Written requests are dropped with the connection, queued writes are kept
+void WSModbusTCPProtocol::transactionsReset() {
+	clearTransactions();
+	m_writeTransactions.clear();
+	m_writing = false;
+}
+
+quint32 WSModbusTCPProtocol::maxLanes() const {
+	return MB_TCP_MAX_LANES;
+}
+
+void WSModbusTCPProtocol::setLanes(quint32 lanes) {
+	modbus_client_tcp_lanes_set(m_hModbusClient.get(), static_cast<uint8_t>(qMin(lanes, static_cast<quint32>(MB_TCP_MAX_LANES))));
+}
+
+// Blocks are polled again by scheduler
+void WSModbusTCPProtocol::clearTransactions() {
+	for (auto const& b: m_transactions) {
+		b->param()->in_flight = 0;
+	}
+	m_transactions.clear();
 }
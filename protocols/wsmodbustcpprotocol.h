@@ -27,40 +27,45 @@
 #include <memory>
 #include "modbus.h"
 #include "libdefs.h"
-#include "wsabstractrrprotocol.h"
-#include "wsmodbusparameter.h"
-#include "wsparametershash.h"
+#include "wsmodbusclientprotocol.h"
 
-class WSModbusTCPProtocol : public WSAbstractRRProtocol {
+class WSModbusTCPProtocol : public WSModbusClientProtocol {
 Q_OBJECT
 
 public:
 	WSModbusTCPProtocol(quint32 bufferSize = 255);
+	virtual const QByteArray &constructRequest() override;
 	virtual WSProtocolParseCode processResponse(const QByteArray &data) override;
 	virtual void resetToDefault() override;
 	virtual WSRRProtocol type() const override;
-	
-	WSParametersHash<WSModbusParameter> &params();
 
 	void timeoutOccurred(quint32 timeout) override;
-	bool readyToPolling() override;
+
+	bool pipelineSupported() const override;
+	qint32 frameLength(const QByteArray &data, quint32 *transactionId) const override;
+	quint32 lastTransactionId() const override;
+	WSProtocolParseCode processTransaction(quint32 transactionId, const QByteArray &frame) override;
+	void transactionTimeout(quint32 transactionId, quint32 timeout) override;
+	void transactionsReset() override;
+
+	quint32 maxLanes() const override;
+	void setLanes(quint32 lanes) override;
+	const QByteArray &constructLaneRequest(quint32 lane) override;
 
 private:
 	std::unique_ptr<struct modbus_tcp_client_handle, void(*)(struct modbus_tcp_client_handle*)> m_hModbusClient;
-	WSParametersHash<WSModbusParameter> m_params;
-	QVector<quint32> m_paramIdToLibIndex;
-	void paramCountChanged(quint32 id);
-	quint32 getParamIdFromLibIndex(int id) const;
-	quint32 getCurrentParamId() const;
+	// Outstanding requests: transaction id -> block (outlives replaced plan)
+	QHash<quint16, std::shared_ptr<WSModbusBlock> > m_transactions;
+	quint16 m_lastTransactionId;
+	// Outstanding writes: transaction id -> write
+	QHash<quint16, WSModbusWrite> m_writeTransactions;
+	void clearTransactions();
 
 protected:
 	virtual qint32 construct(char *data) override;
-
-signals:
-	void parameterChanged(quint32 id, WSModbusParameter *param);
-	void parameterError(quint32 id, WSModbusParameter *param);
-	void parameterTimeout(quint32 id, WSModbusParameter *param);
-	void parameterRequest(quint32 id, WSModbusParameter *param);
+	struct utils_vect_handle *clientParams() const override;
+	void clientParamsChanged() override;
+	quint16 clientParamCounter() const override;
 };
 
 #endif // WSMODBUSTCPPROTOCOL_H
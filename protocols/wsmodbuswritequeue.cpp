@@ -0,0 +1,73 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#include "wsmodbuswritequeue.h"
+
+WSModbusWriteQueue::WSModbusWriteQueue() :
+	m_size(0)
+{}
+
+void WSModbusWriteQueue::enqueue(quint32 id, const std::shared_ptr<WSModbusParameter> &param, qint64 now) {
+	const struct modbus_client_parameter *p = param->param();
+	std::shared_ptr<struct modbus_client_parameter> request(modbus_client_param_create(p->device_adr, p->function_code, p->register_adr, p->func_size, MB_SET_VALUE), modbus_client_param_destroy);
+	if (request.get() == nullptr) {
+		throw std::bad_alloc();
+	}
+	memcpy(request->value, p->value, p->size);
+	QMutexLocker ml(&m_lock);
+	// Newer setpoint of the same parameter replaces the pending one
+	for (auto &w: m_writes) {
+		if (w.id == id) {
+			w.param = param;
+			w.request = request;
+			return;
+		}
+	}
+	m_writes.push_back(WSModbusWrite{id, param, request, now, 0});
+	m_size = static_cast<quint32>(m_writes.size());
+}
+
+bool WSModbusWriteQueue::isEmpty() const {
+	return m_size == 0;
+}
+
+bool WSModbusWriteQueue::take(WSModbusWrite &write, const std::function<bool(quint8)> &accept) {
+	if (m_size == 0) {
+		return false;
+	}
+	QMutexLocker ml(&m_lock);
+	for (auto it = m_writes.begin(); it != m_writes.end(); ++it) {
+		if (accept == nullptr || accept(it->request->device_adr)) {
+			write = *it;
+			m_writes.erase(it);
+			m_size = static_cast<quint32>(m_writes.size());
+			return true;
+		}
+	}
+	return false;
+}
+
+void WSModbusWriteQueue::clear() {
+	QMutexLocker ml(&m_lock);
+	m_writes.clear();
+	m_size = 0;
+}
@@ -0,0 +1,65 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSMODBUSWRITEQUEUE_H
+#define WSMODBUSWRITEQUEUE_H
+
+#include <memory>
+#include <deque>
+#include <atomic>
+#include <functional>
+#include <QtCore>
+#include "modbus.h"
+#include "wsmodbusparameter.h"
+
+// Setpoint write taken out of the polling cycle. The request is built from the copy of the value made at queueing,
+// results are counted and reported with the original parameter.
+struct WSModbusWrite {
+	quint32 id;
+	std::shared_ptr<WSModbusParameter> param;
+	std::shared_ptr<struct modbus_client_parameter> request;
+	// Queueing time, us
+	qint64 queued;
+	quint16 transactionId;
+};
+
+// Pending writes of the protocol: queued by the GUI thread, taken by the polling thread for the next transmit slot
+// (ahead of the polling cycle, after requests already in flight)
+class WSModbusWriteQueue {
+
+public:
+	WSModbusWriteQueue();
+
+	void enqueue(quint32 id, const std::shared_ptr<WSModbusParameter> &param, qint64 now);
+	bool isEmpty() const;
+	// Oldest write accepted by the device filter (e.g. devices of the lane)
+	bool take(WSModbusWrite &write, const std::function<bool(quint8)> &accept = nullptr);
+	void clear();
+
+private:
+	mutable QMutex m_lock;
+	std::deque<WSModbusWrite> m_writes;
+	// Queue is checked before each request without locking
+	std::atomic<quint32> m_size;
+};
+
+#endif // WSMODBUSWRITEQUEUE_H
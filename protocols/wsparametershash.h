@@ -28,56 +28,90 @@
 #include <new>
 #include <map>
 #include <functional>
+#include <vector>
 
+// Parameters are edited by the GUI thread while the polling thread plans requests from snapshots.
+// A snapshot shares the parameters, a removed parameter lives until the last plan using it is released.
 template <class T> class WSParametersHash {
 
 public:
+	typedef std::vector<std::pair<quint32, std::shared_ptr<T> > > Snapshot;
+
 	WSParametersHash(std::function<void(quint32)> callbackFunction) :
 		m_callbackFunction(callbackFunction),
 		m_lastId(0)
 	{}
 
+	// Appends the parameter or replaces the parameter with the same id
 	void append(quint32 id, T *param) {
-		m_params[id] = std::unique_ptr<T>(param);
+		{
+			QMutexLocker ml(&m_lock);
+			m_params[id] = std::shared_ptr<T>(param);
+			if (id > m_lastId) {
+				m_lastId = id;
+			}
+		}
 		if (m_callbackFunction != nullptr) {
 			m_callbackFunction(id);
 		}
-		if (id > m_lastId) {
-			m_lastId = id;
-		}
 	}
 	
 	void remove(quint32 id) {
-		m_params.erase(id);
+		{
+			QMutexLocker ml(&m_lock);
+			m_params.erase(id);
+		}
+		if (m_callbackFunction != nullptr) {
+			m_callbackFunction(id);
+		}
+	}
+
+	// Notify about changes of the parameter stored in hash
+	void update(quint32 id) {
 		if (m_callbackFunction != nullptr) {
 			m_callbackFunction(id);
 		}
 	}
 	
-	T* get(quint32 id) {
-		return (m_params[id]).get();
+	T* get(quint32 id) const {
+		QMutexLocker ml(&m_lock);
+		auto it = m_params.find(id);
+		return (it != m_params.end()) ? it->second.get() : nullptr;
+	}
+
+	// Shared parameter, lives after removal until released by the holder
+	std::shared_ptr<T> share(quint32 id) const {
+		QMutexLocker ml(&m_lock);
+		auto it = m_params.find(id);
+		return (it != m_params.end()) ? it->second : std::shared_ptr<T>();
 	}
 
-	bool contains(quint32 id) {
+	bool contains(quint32 id) const {
+		QMutexLocker ml(&m_lock);
 		return m_params.find(id) != m_params.end();
 	}
-	
-	typename std::map<quint32, std::unique_ptr<T> >::iterator begin() {
-		return m_params.begin();
+
+	bool isEmpty() const {
+		QMutexLocker ml(&m_lock);
+		return m_params.empty();
 	}
-	
-	typename std::map<quint32, std::unique_ptr<T> >::iterator end() {
-		return m_params.end();
+
+	// Parameters ordered by id
+	Snapshot snapshot() const {
+		QMutexLocker ml(&m_lock);
+		return Snapshot(m_params.begin(), m_params.end());
 	}
 
 	quint32 lastId() const {
+		QMutexLocker ml(&m_lock);
 		return m_lastId;
 	}
 
 private:
-	std::map<quint32, std::unique_ptr<T> > m_params;
+	std::map<quint32, std::shared_ptr<T> > m_params;
 	std::function<void(quint32)> m_callbackFunction;
 	quint32 m_lastId;
+	mutable QMutex m_lock;
 };
 
 #endif // WSPARAMETERSHASH_H
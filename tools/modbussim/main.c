@@ -0,0 +1,508 @@
+/****************************************************************************
+
+  This file is part of the Webstella Modbus "C" utility library.
+
+  Copyright (C) 2011 - 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+/*
+ * Modbus TCP slave simulator (Linux, epoll) for load testing of masters.
+ * Every listening port serves units 1..N, each unit has its own register map
+ * processed by modbus_tcp_server(). Registers change over time:
+ *   adr % 4 == 0 - update counter
+ *   adr % 4 == 1 - sawtooth 0..999
+ *   adr % 4 == 2 - triangle 0..1000
+ *   adr % 4 == 3 - static, keeps values written by master
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include "modbus.h"
+
+#define SIM_MAX_EVENTS 256
+#define SIM_MAX_FDS 65536
+#define SIM_MAX_UNITS 247
+#define SIM_MAX_READ_REGISTERS 125
+#define SIM_PACKAGE_SIZE (MB_SIZE_MPAB_HEADER + MB_SIZE_MAX_PDU)
+#define SIM_STATS_PERIOD 5000
+
+struct sim_config {
+	uint16_t port;								/* First listening port */
+	uint16_t ports;								/* Number of listening ports */
+	uint16_t units;								/* Unit ids per port (1..units) */
+	uint16_t registers;							/* Registers per unit */
+	uint32_t latency;							/* Response latency in ms */
+	uint32_t jitter;							/* Random latency addition in ms */
+	uint32_t exceptions;						/* Exception responses in 1/1000 */
+	uint32_t drops;								/* Dropped requests in 1/1000 */
+	uint32_t update;							/* Registers update period in ms (0 - static) */
+};
+
+struct sim_unit {
+	uint16_t *registers;
+	struct modbus_server_handle *serv;
+};
+
+struct sim_conn {
+	int fd;
+	uint16_t port_index;
+	uint32_t gen;								/* Generation, invalidates delayed responses of closed connection */
+	uint8_t in[SIM_PACKAGE_SIZE * 2];
+	uint16_t in_len;
+	uint8_t *out;								/* Unsent data */
+	uint32_t out_len;
+	uint32_t out_cap;
+};
+
+struct sim_delayed {
+	uint64_t due;
+	int fd;
+	uint32_t gen;
+	uint16_t len;
+	uint8_t data[SIM_PACKAGE_SIZE];
+};
+
+struct sim_stats {
+	uint64_t requests;
+	uint64_t responses;
+	uint64_t exceptions;
+	uint64_t drops;
+	uint64_t errors;
+	uint32_t clients;
+};
+
+static struct sim_config cfg = {1502, 1, SIM_MAX_UNITS, 1000, 0, 0, 0, 0, 1000};
+static struct sim_unit *units;
+static struct modbus_access_map *access_map;	/* Shared by all units */
+static struct sim_conn *conns[SIM_MAX_FDS];
+static uint32_t conn_gen;
+static int *listeners;
+static int epfd;
+static struct sim_stats stats;
+static volatile sig_atomic_t stop_flag;
+
+/* Delayed responses, binary heap by due time */
+static struct sim_delayed **delayed;
+static uint32_t delayed_size;
+static uint32_t delayed_cap;
+
+static uint64_t now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+static void on_signal(int sig) {
+	(void) sig;
+	stop_flag = 1;
+}
+
+static void usage(const char *name) {
+	printf("Usage: %s [options]\n", name);
+	printf("  -p PORT     first listening port (default %u)\n", cfg.port);
+	printf("  -n PORTS    number of listening ports, units = ports * unit ids (default %u)\n", cfg.ports);
+	printf("  -u UNITS    unit ids 1..UNITS served on every port, max %u (default %u)\n", SIM_MAX_UNITS, cfg.units);
+	printf("  -r REGS     holding/input registers per unit (default %u)\n", cfg.registers);
+	printf("  -l MS       response latency (default %u)\n", cfg.latency);
+	printf("  -j MS       random latency jitter (default %u)\n", cfg.jitter);
+	printf("  -e PERMILLE exception responses (slave device failure) per 1000 requests (default %u)\n", cfg.exceptions);
+	printf("  -d PERMILLE dropped requests per 1000 requests (default %u)\n", cfg.drops);
+	printf("  -t MS       registers update period, 0 - static map (default %u)\n", cfg.update);
+}
+
+static int parse_args(int argc, char **argv) {
+	int opt;
+	while ((opt = getopt(argc, argv, "p:n:u:r:l:j:e:d:t:h")) != -1) {
+		switch (opt) {
+			case 'p': cfg.port = (uint16_t) atoi(optarg); break;
+			case 'n': cfg.ports = (uint16_t) atoi(optarg); break;
+			case 'u': cfg.units = (uint16_t) atoi(optarg); break;
+			case 'r': cfg.registers = (uint16_t) atoi(optarg); break;
+			case 'l': cfg.latency = (uint32_t) atoi(optarg); break;
+			case 'j': cfg.jitter = (uint32_t) atoi(optarg); break;
+			case 'e': cfg.exceptions = (uint32_t) atoi(optarg); break;
+			case 'd': cfg.drops = (uint32_t) atoi(optarg); break;
+			case 't': cfg.update = (uint32_t) atoi(optarg); break;
+			default: return 0;
+		}
+	}
+	if (cfg.ports == 0 || cfg.units == 0 || cfg.units > SIM_MAX_UNITS || cfg.registers == 0) {
+		return 0;
+	}
+	return 1;
+}
+
+static int units_create(void) {
+	uint32_t i, count = (uint32_t) cfg.ports * cfg.units;
+	int32_t bytes = (int32_t) cfg.registers * MB_SIZE_REGISTER;
+	if ((units = (struct sim_unit*) calloc(count, sizeof(struct sim_unit))) == NULL) {
+		return 0;
+	}
+	if ((access_map = modbus_access_map_create()) == NULL || !modbus_access_map_set(access_map, 0, cfg.registers, MB_ACCESS_READ_WRITE)) {
+		return 0;
+	}
+	for (i = 0; i < count; i++) {
+		units[i].registers = (uint16_t*) calloc(cfg.registers, sizeof(uint16_t));
+		if (units[i].registers == NULL) {
+			return 0;
+		}
+		units[i].serv = modbus_server_create(units[i].registers, NULL, bytes, SIM_MAX_READ_REGISTERS, (uint16_t) (i % cfg.units + 1));
+		if (units[i].serv == NULL) {
+			return 0;
+		}
+		modbus_server_set_access_map(units[i].serv, access_map);
+	}
+	return 1;
+}
+
+static void units_update(uint32_t tick) {
+	uint32_t i, r, count = (uint32_t) cfg.ports * cfg.units;
+	uint16_t *regs;
+	for (i = 0; i < count; i++) {
+		regs = units[i].registers;
+		for (r = 0; r + 2 < cfg.registers; r += 4) {
+			regs[r] = (uint16_t) tick;
+			regs[r + 1] = (uint16_t) ((tick + r) % 1000);
+			regs[r + 2] = (uint16_t) (((tick + i) % 2000 < 1000) ? (tick + i) % 1000 : 1000 - (tick + i) % 1000);
+		}
+	}
+}
+
+static int set_nonblock(int fd) {
+	int flags = fcntl(fd, F_GETFL, 0);
+	return (flags < 0) ? -1 : fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static int listeners_create(void) {
+	uint16_t i;
+	int fd, on = 1;
+	struct sockaddr_in addr;
+	struct epoll_event ev;
+	if ((listeners = (int*) malloc(cfg.ports * sizeof(int))) == NULL) {
+		return 0;
+	}
+	for (i = 0; i < cfg.ports; i++) {
+		if ((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+			return 0;
+		}
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		addr.sin_port = htons((uint16_t) (cfg.port + i));
+		if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0 || set_nonblock(fd) < 0) {
+			fprintf(stderr, "Can't listen port %u: %s\n", cfg.port + i, strerror(errno));
+			return 0;
+		}
+		ev.events = EPOLLIN;
+		ev.data.u64 = ((uint64_t) 1 << 32) | i;
+		if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+			return 0;
+		}
+		listeners[i] = fd;
+	}
+	return 1;
+}
+
+static void conn_close(struct sim_conn *c) {
+	epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+	close(c->fd);
+	conns[c->fd] = NULL;
+	free(c->out);
+	free(c);
+	stats.clients--;
+}
+
+static void conn_accept(uint16_t port_index) {
+	int fd, on = 1;
+	struct sim_conn *c;
+	struct epoll_event ev;
+	while ((fd = accept(listeners[port_index], NULL, NULL)) >= 0) {
+		if (fd >= SIM_MAX_FDS || set_nonblock(fd) < 0 || (c = (struct sim_conn*) calloc(1, sizeof(struct sim_conn))) == NULL) {
+			close(fd);
+			continue;
+		}
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+		c->fd = fd;
+		c->port_index = port_index;
+		c->gen = ++conn_gen;
+		ev.events = EPOLLIN;
+		ev.data.u64 = (uint64_t) fd;
+		if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+			close(fd);
+			free(c);
+			continue;
+		}
+		conns[fd] = c;
+		stats.clients++;
+	}
+}
+
+/* Flush unsent data, returns 0 if connection is closed */
+static int conn_flush(struct sim_conn *c) {
+	ssize_t n;
+	uint32_t sent = 0;
+	struct epoll_event ev;
+	while (sent < c->out_len) {
+		n = send(c->fd, c->out + sent, c->out_len - sent, MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;
+			}
+			conn_close(c);
+			return 0;
+		}
+		sent += (uint32_t) n;
+	}
+	memmove(c->out, c->out + sent, c->out_len - sent);
+	c->out_len -= sent;
+	ev.events = (c->out_len > 0) ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+	ev.data.u64 = (uint64_t) c->fd;
+	epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+	return 1;
+}
+
+static int conn_send(struct sim_conn *c, const uint8_t *data, uint16_t len) {
+	uint8_t *out;
+	if (c->out_len + len > c->out_cap) {
+		if ((out = (uint8_t*) realloc(c->out, c->out_len + len + SIM_PACKAGE_SIZE)) == NULL) {
+			conn_close(c);
+			return 0;
+		}
+		c->out = out;
+		c->out_cap = c->out_len + len + SIM_PACKAGE_SIZE;
+	}
+	memcpy(c->out + c->out_len, data, len);
+	c->out_len += len;
+	stats.responses++;
+	return conn_flush(c);
+}
+
+static int delayed_push(struct sim_conn *c, const uint8_t *data, uint16_t len, uint64_t due) {
+	struct sim_delayed *d, **heap, *tmp;
+	uint32_t pos, parent;
+	if (delayed_size == delayed_cap) {
+		if ((heap = (struct sim_delayed**) realloc(delayed, (delayed_cap * 2 + 64) * sizeof(*delayed))) == NULL) {
+			return 0;
+		}
+		delayed = heap;
+		delayed_cap = delayed_cap * 2 + 64;
+	}
+	if ((d = (struct sim_delayed*) malloc(sizeof(struct sim_delayed))) == NULL) {
+		return 0;
+	}
+	d->due = due;
+	d->fd = c->fd;
+	d->gen = c->gen;
+	d->len = len;
+	memcpy(d->data, data, len);
+	pos = delayed_size++;
+	delayed[pos] = d;
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (delayed[parent]->due <= delayed[pos]->due) {
+			break;
+		}
+		tmp = delayed[parent];
+		delayed[parent] = delayed[pos];
+		delayed[pos] = tmp;
+		pos = parent;
+	}
+	return 1;
+}
+
+static struct sim_delayed *delayed_pop(void) {
+	struct sim_delayed *top = delayed[0], *tmp;
+	uint32_t pos = 0, child;
+	delayed[0] = delayed[--delayed_size];
+	while ((child = pos * 2 + 1) < delayed_size) {
+		if (child + 1 < delayed_size && delayed[child + 1]->due < delayed[child]->due) {
+			child++;
+		}
+		if (delayed[pos]->due <= delayed[child]->due) {
+			break;
+		}
+		tmp = delayed[pos];
+		delayed[pos] = delayed[child];
+		delayed[child] = tmp;
+		pos = child;
+	}
+	return top;
+}
+
+static void delayed_flush(uint64_t now) {
+	struct sim_delayed *d;
+	struct sim_conn *c;
+	while (delayed_size > 0 && delayed[0]->due <= now) {
+		d = delayed_pop();
+		c = conns[d->fd];
+		if (c != NULL && c->gen == d->gen) {
+			conn_send(c, d->data, d->len);
+		}
+		free(d);
+	}
+}
+
+/* Process one complete request package, returns 0 if connection is closed */
+static int conn_request(struct sim_conn *c, uint8_t *package, uint16_t len) {
+	uint8_t out[SIM_PACKAGE_SIZE];
+	uint16_t out_len = 0;
+	uint8_t unit = package[MB_OFFSET_MPAB_UNIT_ID];
+	uint32_t r = (uint32_t) rand() % 1000;
+
+	stats.requests++;
+	/* Unknown unit or injected drop - no response (gateway timeout) */
+	if (unit == 0 || unit > cfg.units || r < cfg.drops) {
+		stats.drops++;
+		return 1;
+	}
+	if (r < cfg.drops + cfg.exceptions) {
+		memcpy(out, package, MB_SIZE_MPAB_HEADER);
+		out[MB_SIZE_MPAB_HEADER + MB_OFFSET_FCODE] = (uint8_t) (package[MB_SIZE_MPAB_HEADER + MB_OFFSET_FCODE] | 0x80);
+		out[MB_SIZE_MPAB_HEADER + MB_OFFSET_OUT_ERR_CODE] = MB_EC_SLAVE_DEVICE_FAILURE;
+		out[MB_OFFSET_LENGTH_HIGH] = 0;
+		out[MB_OFFSET_LENGTH_LOW] = MB_SIZE_ERR_PACKAGE + 1;
+		out_len = MB_SIZE_MPAB_HEADER + MB_SIZE_ERR_PACKAGE;
+		stats.exceptions++;
+	} else if (modbus_tcp_server(units[(uint32_t) c->port_index * cfg.units + unit - 1].serv, package, len, out, &out_len) != DEF_PKG_OK) {
+		stats.errors++;
+		return 1;
+	}
+	if (cfg.latency == 0 && cfg.jitter == 0) {
+		return conn_send(c, out, out_len);
+	}
+	delayed_push(c, out, out_len, now_ms() + cfg.latency + ((cfg.jitter > 0) ? (uint32_t) rand() % (cfg.jitter + 1) : 0));
+	return 1;
+}
+
+static void conn_read(struct sim_conn *c) {
+	ssize_t n;
+	int32_t len;
+	uint16_t transaction_id, offset;
+	while (1) {
+		n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len, 0);
+		if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+			conn_close(c);
+			return;
+		}
+		if (n < 0) {
+			return;
+		}
+		c->in_len += (uint16_t) n;
+		/* Split stream to packages */
+		offset = 0;
+		while ((len = modbus_tcp_package_length(c->in + offset, c->in_len - offset, &transaction_id)) > 0) {
+			if (!conn_request(c, c->in + offset, (uint16_t) len)) {
+				return;
+			}
+			offset += (uint16_t) len;
+		}
+		if (len < 0) {
+			stats.errors++;
+			conn_close(c);
+			return;
+		}
+		memmove(c->in, c->in + offset, c->in_len - offset);
+		c->in_len -= offset;
+	}
+}
+
+int main(int argc, char **argv) {
+	struct epoll_event events[SIM_MAX_EVENTS];
+	uint64_t now, next_update, next_stats, start;
+	uint32_t tick = 0;
+	int n, i, timeout;
+	struct sim_conn *c;
+
+	if (!parse_args(argc, argv)) {
+		usage(argv[0]);
+		return 1;
+	}
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	signal(SIGPIPE, SIG_IGN);
+	srand((unsigned) time(NULL));
+	if ((epfd = epoll_create1(0)) < 0 || !units_create() || !listeners_create()) {
+		fprintf(stderr, "Simulator initialization failed\n");
+		return 1;
+	}
+	printf("Serving %u unit(s) on port(s) %u..%u, %u registers each\n", cfg.ports * cfg.units, cfg.port, cfg.port + cfg.ports - 1, cfg.registers);
+
+	start = now_ms();
+	next_update = start;
+	next_stats = start + SIM_STATS_PERIOD;
+	while (!stop_flag) {
+		now = now_ms();
+		if (cfg.update > 0 && now >= next_update) {
+			units_update(tick++);
+			next_update = now + cfg.update;
+		}
+		if (now >= next_stats) {
+			printf("clients %u, requests %llu, responses %llu, exceptions %llu, drops %llu, errors %llu (%.0f req/s)\n",
+				stats.clients, (unsigned long long) stats.requests, (unsigned long long) stats.responses,
+				(unsigned long long) stats.exceptions, (unsigned long long) stats.drops, (unsigned long long) stats.errors,
+				stats.requests * 1000.0 / (double) (now - start));
+			fflush(stdout);
+			next_stats = now + SIM_STATS_PERIOD;
+		}
+		delayed_flush(now);
+		/* Sleep until nearest event */
+		timeout = (int) (next_stats - now);
+		if (cfg.update > 0 && next_update - now < (uint64_t) timeout) {
+			timeout = (int) (next_update - now);
+		}
+		if (delayed_size > 0) {
+			timeout = (delayed[0]->due <= now) ? 0 : ((delayed[0]->due - now < (uint64_t) timeout) ? (int) (delayed[0]->due - now) : timeout);
+		}
+		n = epoll_wait(epfd, events, SIM_MAX_EVENTS, timeout);
+		for (i = 0; i < n; i++) {
+			if (events[i].data.u64 >> 32) {
+				conn_accept((uint16_t) (events[i].data.u64 & 0xFFFF));
+				continue;
+			}
+			c = conns[(int) events[i].data.u64];
+			if (c == NULL) {
+				continue;
+			}
+			if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+				conn_close(c);
+				continue;
+			}
+			if ((events[i].events & EPOLLOUT) && !conn_flush(c)) {
+				continue;
+			}
+			if (events[i].events & EPOLLIN) {
+				conn_read(c);
+			}
+		}
+	}
+	printf("\nStopped\n");
+	return 0;
+}
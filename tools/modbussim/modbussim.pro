@@ -0,0 +1,19 @@
+TEMPLATE = app
+CONFIG += console c99
+CONFIG -= qt app_bundle
+
+TARGET = modbussim
+
+# epoll based, Linux only
+!linux: error("modbussim requires Linux (epoll)")
+
+INCLUDEPATH += ../../protocols
+
+SOURCES += \
+	main.c \
+	../../protocols/modbus.c \
+	../../protocols/libdefs.c
+
+HEADERS += \
+	../../protocols/modbus.h \
+	../../protocols/libdefs.h
@@ -0,0 +1,323 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+/*
+ * Serial hot path benchmark (Linux): WSSerialInterface + WSModbusRTUProtocol poll
+ * a Modbus RTU slave emulator attached to the other end of a pseudo-terminal pair.
+ * A pty has no line speed, the emulator delays every response by the wire time of
+ * request and response at the simulated baud rate (plus turnaround latency).
+ * Reports frames/s against the wire limit, latency percentiles and CPU use per baud rate.
+ * Exit code is 1 if a run got no valid responses or any invalid one.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "interfaces/wsserialinterface.h"
+#include "protocols/wsmodbusrtuprotocol.h"
+#include "modbus.h"
+
+// Start, 8 data and stop bits (8N1)
+static const int BENCH_CHAR_BITS = 10;
+static const int BENCH_MAX_UNITS = 247;
+static const int BENCH_MAX_REGISTERS = 125;
+static const int BENCH_REGISTERS_MAP = 1000;
+
+struct BenchConfig {
+	QVector<qint32> bauds;
+	quint32 seconds;
+	quint32 units;
+	quint32 registers;
+	quint32 latency;			// Slave turnaround in us
+};
+
+struct BenchResult {
+	quint64 requests;
+	quint64 valid;
+	quint64 errors;
+	quint64 timeouts;
+	double seconds;
+	double threadCpu;
+	double processCpu;
+	QVector<qint64> latencies;	// us
+};
+
+static qint64 nowUs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<qint64>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static double cpuSeconds(int who) {
+	struct rusage ru;
+	getrusage(who, &ru);
+	return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static qint64 wireUs(qint64 bytes, qint32 baud) {
+	return bytes * BENCH_CHAR_BITS * 1000000 / baud;
+}
+
+// Bus silence kept by the master before a request (t3.5 rounded up to ms, see WSSerialInterface)
+static qint64 silenceUs(qint32 baud) {
+	qint64 t35 = (baud > 19200) ? 1750 : (BENCH_CHAR_BITS * 3500000 + baud - 1) / baud;
+	return (t35 + 999) / 1000 * 1000;
+}
+
+// Modbus RTU slaves 1..units sharing one registers map, answering on the pty master
+class SlaveEmulator {
+
+public:
+	SlaveEmulator(int fd, quint32 units, quint32 latency) :
+		m_fd(fd),
+		m_latency(latency),
+		m_baud(9600),
+		m_stop(false)
+	{
+		for (int i = 0; i < BENCH_REGISTERS_MAP; i++) {
+			m_registers[i] = static_cast<uint16_t>(i);
+		}
+		for (quint32 i = 1; i <= units; i++) {
+			modbus_server_handle *serv = modbus_server_create(m_registers, nullptr, sizeof(m_registers), BENCH_MAX_REGISTERS, static_cast<uint16_t>(i));
+			if (serv == nullptr) {
+				throw std::bad_alloc();
+			}
+			m_servers.push_back(serv);
+		}
+	}
+
+	~SlaveEmulator() {
+		stop();
+		for (modbus_server_handle *serv : m_servers) {
+			modbus_server_destroy(serv);
+		}
+	}
+
+	void start(qint32 baud) {
+		m_baud = baud;
+		m_stop = false;
+		m_thread = std::thread([this]() {run();});
+	}
+
+	void stop() {
+		m_stop = true;
+		if (m_thread.joinable()) {
+			m_thread.join();
+		}
+	}
+
+private:
+	int m_fd;
+	quint32 m_latency;
+	qint32 m_baud;
+	std::atomic<bool> m_stop;
+	std::thread m_thread;
+	uint16_t m_registers[BENCH_REGISTERS_MAP];
+	std::vector<modbus_server_handle*> m_servers;
+
+	void run() {
+		uint8_t in[MB_SIZE_MAX_PDU * 2];
+		uint8_t out[MB_SIZE_MAX_PDU * 2];
+		uint16_t inLen = 0;
+		qint64 lastByte = 0;
+		struct pollfd pfd = {m_fd, POLLIN, 0};
+
+		while (!m_stop) {
+			if (poll(&pfd, 1, 10) <= 0 || !(pfd.revents & POLLIN)) {
+				continue;
+			}
+			ssize_t n = read(m_fd, &in[inLen], sizeof(in) - inLen);
+			if (n <= 0) {
+				continue;
+			}
+			qint64 now = nowUs();
+			// Bus silence ends the previous (broken) frame
+			if (inLen > 0 && now - lastByte > 100000) {
+				memmove(in, &in[inLen], static_cast<size_t>(n));
+				inLen = 0;
+			}
+			inLen = static_cast<uint16_t>(inLen + n);
+			lastByte = now;
+			int16_t adr = modbus_rtu_server_analyze(in, inLen);
+			if (adr == MB_RTU_ERR_INCOMPLETE && inLen < sizeof(in)) {
+				continue;
+			}
+			uint16_t outLen = 0;
+			if (adr > 0 && static_cast<quint32>(adr) <= m_servers.size()) {
+				modbus_rtu_server(m_servers[static_cast<size_t>(adr - 1)], in, inLen, out, &outLen);
+			}
+			// Request and response occupy the line, the slave thinks in between
+			if (outLen > 0) {
+				qint64 due = now + wireUs(inLen, m_baud) + m_latency + wireUs(outLen, m_baud);
+				while (!m_stop && nowUs() < due) {
+					qint64 left = due - nowUs();
+					if (left > 0) {
+						usleep(static_cast<useconds_t>(left));
+					}
+				}
+				if (write(m_fd, out, outLen) != outLen) {
+					fprintf(stderr, "Slave write error\n");
+				}
+			}
+			inLen = 0;
+		}
+	}
+};
+
+static BenchResult runBaud(const BenchConfig &cfg, const QString &portName, qint32 baud) {
+	BenchResult res = {0, 0, 0, 0, 0, 0, 0, QVector<qint64>()};
+	WSModbusRTUProtocol *proto = new WSModbusRTUProtocol();
+	for (quint32 i = 1; i <= cfg.units; i++) {
+		proto->params().append(i, new WSModbusParameter("p" + QString::number(i),
+			static_cast<uint8_t>(i), MB_FC_READ_HOLDING_REGISTERS, 0, static_cast<uint16_t>(cfg.registers),
+			WSPollingType::ALWAYS, WSDataType::INTEGER, WSByteOrder::FORWARD, WSDataRepresent::DEC, 2, false));
+	}
+	WSSerialInterface iface(portName, proto, nullptr);
+	iface.setBaudRate(baud);
+	iface.setPollingPause(0);
+	iface.setReceiveTimeout(1000);
+	// Counted only, received data is not copied
+	iface.setDataTrace(false);
+
+	QEventLoop loop;
+	qint64 sent = 0;
+	QObject::connect(&iface, &WSSerialInterface::trasmitted, [&res, &sent](QByteArray) {
+		res.requests++;
+		sent = nowUs();
+	});
+	QObject::connect(&iface, &WSSerialInterface::validDataReceived, [&res, &sent](QByteArray) {
+		res.valid++;
+		res.latencies.append(nowUs() - sent);
+	});
+	QObject::connect(&iface, &WSSerialInterface::errorDataReceived, [&res](QByteArray) {
+		res.errors++;
+	});
+	QObject::connect(&iface, &WSSerialInterface::receiveTimeoutOccurred, [&res](quint32) {
+		res.timeouts++;
+	});
+	QObject::connect(&iface, &WSSerialInterface::stopped, &loop, &QEventLoop::quit);
+
+	qint64 wallStart = nowUs();
+	double threadStart = cpuSeconds(RUSAGE_THREAD);
+	double processStart = cpuSeconds(RUSAGE_SELF);
+	QTimer::singleShot(0, &iface, [&iface]() {iface.start();});
+	QTimer::singleShot(static_cast<int>(cfg.seconds * 1000), &iface, [&iface]() {iface.stop();});
+	loop.exec();
+	res.seconds = (nowUs() - wallStart) / 1e6;
+	res.threadCpu = (cpuSeconds(RUSAGE_THREAD) - threadStart) / res.seconds * 100;
+	res.processCpu = (cpuSeconds(RUSAGE_SELF) - processStart) / res.seconds * 100;
+	return res;
+}
+
+static qint64 percentile(const QVector<qint64> &sorted, int p) {
+	if (sorted.isEmpty()) {
+		return 0;
+	}
+	return sorted[(sorted.size() - 1) * p / 100];
+}
+
+int main(int argc, char *argv[]) {
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("serialbench");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Modbus RTU serial interface benchmark over a pseudo-terminal pair");
+	parser.addHelpOption();
+	QCommandLineOption baudsOption(QStringList() << "b" << "bauds", "Comma separated simulated baud rates.", "list", "9600,19200,38400,57600,115200");
+	QCommandLineOption secondsOption(QStringList() << "t" << "time", "Seconds per baud rate.", "seconds", "5");
+	QCommandLineOption unitsOption(QStringList() << "n" << "units", "Polled slaves (1 parameter per slave).", "count", "4");
+	QCommandLineOption registersOption(QStringList() << "r" << "registers", "Holding registers per request.", "count", "10");
+	QCommandLineOption latencyOption(QStringList() << "l" << "latency", "Slave turnaround in us.", "us", "0");
+	parser.addOptions({baudsOption, secondsOption, unitsOption, registersOption, latencyOption});
+	parser.process(app);
+
+	BenchConfig cfg;
+	for (const QString &b : parser.value(baudsOption).split(',', QString::SkipEmptyParts)) {
+		qint32 baud = b.toInt();
+		if (baud <= 0) {
+			fprintf(stderr, "Invalid baud rate: %s\n", qPrintable(b));
+			return 2;
+		}
+		cfg.bauds.append(baud);
+	}
+	cfg.seconds = qMax(1u, parser.value(secondsOption).toUInt());
+	cfg.units = qBound(1u, parser.value(unitsOption).toUInt(), static_cast<quint32>(BENCH_MAX_UNITS));
+	cfg.registers = qBound(1u, parser.value(registersOption).toUInt(), static_cast<quint32>(BENCH_MAX_REGISTERS));
+	cfg.latency = parser.value(latencyOption).toUInt();
+
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+		perror("posix_openpt");
+		return 2;
+	}
+	QString portName = QString::fromLocal8Bit(ptsname(master));
+	// Keep the slave end open between runs (the master gets EIO when the last slave fd is closed)
+	int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+	if (slave < 0) {
+		perror("open pty slave");
+		return 2;
+	}
+	struct termios tio;
+	tcgetattr(slave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(slave, TCSANOW, &tio);
+
+	printf("pty %s, %u units, %u registers, turnaround %u us, %u s per run\n", qPrintable(portName), cfg.units, cfg.registers, cfg.latency, cfg.seconds);
+	printf("%8s %10s %10s %6s %8s %8s %8s %8s %8s %7s %7s\n", "baud", "frames/s", "limit/s", "eff%", "p50 us", "p90 us", "p99 us", "errors", "timeouts", "cpu%", "proc%");
+
+	int exitCode = 0;
+	SlaveEmulator emulator(master, cfg.units, cfg.latency);
+	// Request 8 bytes, response address, function, size, data and CRC
+	qint64 frameBytes = 8 + 5 + cfg.registers * 2;
+	for (qint32 baud : cfg.bauds) {
+		emulator.start(baud);
+		BenchResult res = runBaud(cfg, portName, baud);
+		emulator.stop();
+		tcflush(master, TCIOFLUSH);
+
+		std::sort(res.latencies.begin(), res.latencies.end());
+		// Wire time of both frames, turnaround and t3.5 silence before the next request
+		double limit = 1e6 / (wireUs(frameBytes, baud) + cfg.latency + silenceUs(baud));
+		double rate = res.valid / res.seconds;
+		printf("%8d %10.1f %10.1f %6.1f %8lld %8lld %8lld %8llu %8llu %7.1f %7.1f\n", baud, rate, limit, rate / limit * 100,
+			static_cast<long long>(percentile(res.latencies, 50)), static_cast<long long>(percentile(res.latencies, 90)),
+			static_cast<long long>(percentile(res.latencies, 99)), static_cast<unsigned long long>(res.errors),
+			static_cast<unsigned long long>(res.timeouts), res.threadCpu, res.processCpu);
+		if (res.valid == 0 || res.errors > 0) {
+			exitCode = 1;
+		}
+	}
+	close(slave);
+	close(master);
+	return exitCode;
+}
@@ -0,0 +1,51 @@
+QT += core serialport
+QT -= gui
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = serialbench
+
+# Pseudo-terminal pairs, Linux only
+!linux: error("serialbench requires Linux (pty)")
+
+INCLUDEPATH += ../.. ../../protocols
+
+SOURCES += \
+	main.cpp \
+	../../conf.cpp \
+	../../interfaces/wslatencyhistogram.cpp \
+	../../interfaces/wspollinginterface.cpp \
+	../../interfaces/wspollingrrinterface.cpp \
+	../../interfaces/wsreceivebuffer.cpp \
+	../../interfaces/wsrttestimator.cpp \
+	../../interfaces/wsserialinterface.cpp \
+	../../interfaces/wstransactionwindow.cpp \
+	../../protocols/wsabstractrrprotocol.cpp \
+	../../protocols/wsdataconverter.cpp \
+	../../protocols/wsmodbusblockplanner.cpp \
+	../../protocols/wsmodbusclientprotocol.cpp \
+	../../protocols/wsmodbusparameter.cpp \
+	../../protocols/wsmodbusrtuprotocol.cpp \
+	../../protocols/wsmodbuswritequeue.cpp \
+	../../protocols/modbus.c \
+	../../protocols/libdefs.c
+
+HEADERS += \
+	../../conf.h \
+	../../interfaces/wslatencyhistogram.h \
+	../../interfaces/wspollinginterface.h \
+	../../interfaces/wspollingrrinterface.h \
+	../../interfaces/wsreceivebuffer.h \
+	../../interfaces/wsrttestimator.h \
+	../../interfaces/wsserialinterface.h \
+	../../interfaces/wstransactionwindow.h \
+	../../protocols/wsabstractrrprotocol.h \
+	../../protocols/wsdataconverter.h \
+	../../protocols/wsmodbusblockplanner.h \
+	../../protocols/wsmodbusclientprotocol.h \
+	../../protocols/wsmodbusparameter.h \
+	../../protocols/wsmodbusrtuprotocol.h \
+	../../protocols/wsmodbuswritequeue.h \
+	../../protocols/wsparametershash.h \
+	../../protocols/modbus.h \
+	../../protocols/libdefs.h
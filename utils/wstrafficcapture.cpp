@@ -0,0 +1,109 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#include "wstrafficcapture.h"
+
+static const char CAPTURE_SIGNATURE[] = "WSTRAFFIC";
+static const quint8 CAPTURE_VERSION = 1;
+
+WSTrafficCapture::WSTrafficCapture(QObject *parent) :
+	QObject(parent)
+{
+	m_stream.setByteOrder(QDataStream::LittleEndian);
+}
+
+WSTrafficCapture::~WSTrafficCapture() {
+	close();
+}
+
+bool WSTrafficCapture::open(const QString &fileName) {
+	QMutexLocker ml(&m_lock);
+	if (m_file.isOpen()) {
+		return false;
+	}
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::WriteOnly)) {
+		return false;
+	}
+	m_stream.setDevice(&m_file);
+	m_stream.writeRawData(CAPTURE_SIGNATURE, sizeof(CAPTURE_SIGNATURE) - 1);
+	m_stream << CAPTURE_VERSION;
+	m_clock.start();
+	return true;
+}
+
+void WSTrafficCapture::close() {
+	QMutexLocker ml(&m_lock);
+	if (m_file.isOpen()) {
+		m_stream.setDevice(nullptr);
+		m_file.close();
+	}
+}
+
+bool WSTrafficCapture::isOpen() const {
+	QMutexLocker ml(&m_lock);
+	return m_file.isOpen();
+}
+
+void WSTrafficCapture::record(bool received, const QByteArray &data) {
+	QMutexLocker ml(&m_lock);
+	if (!m_file.isOpen()) {
+		return;
+	}
+	m_stream << static_cast<qint64>(m_clock.nsecsElapsed() / 1000) << static_cast<quint8>(received ? 1 : 0) << static_cast<quint32>(data.size());
+	m_stream.writeRawData(data.constData(), data.size());
+}
+
+bool WSTrafficCapture::load(const QString &fileName, QVector<WSTrafficRecord> &records) {
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	QDataStream stream(&file);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	char signature[sizeof(CAPTURE_SIGNATURE) - 1];
+	quint8 version = 0;
+	if (stream.readRawData(signature, sizeof(signature)) != sizeof(signature) || memcmp(signature, CAPTURE_SIGNATURE, sizeof(signature)) != 0) {
+		return false;
+	}
+	stream >> version;
+	if (version != CAPTURE_VERSION) {
+		return false;
+	}
+	records.clear();
+	while (!stream.atEnd()) {
+		WSTrafficRecord r;
+		quint8 direction;
+		quint32 size;
+		stream >> r.time >> direction >> size;
+		if (stream.status() != QDataStream::Ok || size > static_cast<quint32>(file.size())) {
+			return false;
+		}
+		r.received = (direction != 0);
+		r.data.resize(static_cast<qint32>(size));
+		if (stream.readRawData(r.data.data(), static_cast<qint32>(size)) != static_cast<qint32>(size)) {
+			return false;
+		}
+		records.append(r);
+	}
+	return true;
+}
@@ -0,0 +1,58 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSTRAFFICCAPTURE_H
+#define WSTRAFFICCAPTURE_H
+
+#include <QtCore>
+
+// Captured frame, time in us from the capture start
+struct WSTrafficRecord {
+	qint64 time;
+	bool received;
+	QByteArray data;
+};
+
+// Capture file: signature, version, then records (time, direction, size, data) in little endian
+class WSTrafficCapture : public QObject {
+Q_OBJECT
+
+public:
+	explicit WSTrafficCapture(QObject *parent = nullptr);
+	virtual ~WSTrafficCapture();
+
+	bool open(const QString &fileName);
+	void close();
+	bool isOpen() const;
+	// Called directly from the polling thread
+	void record(bool received, const QByteArray &data);
+
+	static bool load(const QString &fileName, QVector<WSTrafficRecord> &records);
+
+private:
+	mutable QMutex m_lock;
+	QFile m_file;
+	QDataStream m_stream;
+	QElapsedTimer m_clock;
+};
+
+#endif // WSTRAFFICCAPTURE_H
@@ -0,0 +1,89 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#include "wsupdatebuffer.h"
+
+WSUpdateBuffer::WSUpdateBuffer()
+{}
+
+WSParameterUpdate &WSUpdateBuffer::entry(quint32 paramId) {
+	auto it = m_index.find(paramId);
+	if (it != m_index.end()) {
+		return m_updates[it.value()];
+	}
+	m_index.insert(paramId, static_cast<quint32>(m_updates.size()));
+	m_updates.push_back(WSParameterUpdate{paramId, false, 0, WSUpdateResult::NONE, 0, 0, 0, QByteArray(),
+		WSDataType::INTEGER, WSByteOrder::FORWARD, WSDataRepresent::DEC, 0, false, -1});
+	return m_updates.back();
+}
+
+void WSUpdateBuffer::requested(quint32 paramId, const WSModbusParameter *param) {
+	QMutexLocker ml(&m_lock);
+	WSParameterUpdate &u = entry(paramId);
+	u.requested = true;
+	u.requestsCount = param->requestsCount();
+}
+
+void WSUpdateBuffer::valueChanged(quint32 paramId, const WSModbusParameter *param) {
+	result(paramId, param, WSUpdateResult::VALUE, param->responsesCount());
+}
+
+void WSUpdateBuffer::errorOccurred(quint32 paramId, const WSModbusParameter *param) {
+	result(paramId, param, WSUpdateResult::FAILURE, param->errorsCount());
+}
+
+void WSUpdateBuffer::timeoutOccurred(quint32 paramId, const WSModbusParameter *param) {
+	result(paramId, param, WSUpdateResult::TIMEOUT, param->timeoutsCount());
+}
+
+void WSUpdateBuffer::written(quint32 paramId, quint32 latency) {
+	QMutexLocker ml(&m_lock);
+	entry(paramId).latency = latency;
+}
+
+void WSUpdateBuffer::result(quint32 paramId, const WSModbusParameter *param, WSUpdateResult result, quint32 count) {
+	qint64 time = QDateTime::currentMSecsSinceEpoch();
+	QMutexLocker ml(&m_lock);
+	WSParameterUpdate &u = entry(paramId);
+	u.result = result;
+	u.resultCount = count;
+	u.error = param->param()->err;
+	u.time = time;
+	if (result == WSUpdateResult::VALUE) {
+		// Storage of the coalesced value is reused
+		u.value.resize(param->param()->size);
+		memcpy(u.value.data(), param->param()->value, param->param()->size);
+		u.dataType = param->dataType();
+		u.dataByteOrder = param->dataByteOrder();
+		u.dataRepresent = param->dataRepresent();
+		u.dataTypeSize = param->dataTypeSize();
+		u.dataSigned = param->dataSigned();
+	}
+}
+
+std::vector<WSParameterUpdate> WSUpdateBuffer::take() {
+	std::vector<WSParameterUpdate> updates;
+	QMutexLocker ml(&m_lock);
+	updates.swap(m_updates);
+	m_index.clear();
+	return updates;
+}
@@ -0,0 +1,84 @@
+/****************************************************************************
+
+  This file is part of the Webstella protocols exchange (Weprex) software.
+
+  Copyright (C) 2018 Oleg Malyavkin.
+  Contact: weprexsoft@gmail.com
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+****************************************************************************/
+
+#ifndef WSUPDATEBUFFER_H
+#define WSUPDATEBUFFER_H
+
+#include <vector>
+#include <QtCore>
+#include "protocols/wsmodbusparameter.h"
+
+enum class WSUpdateResult : quint8 {
+	NONE = 0,
+	VALUE = 1,
+	FAILURE = 2,
+	TIMEOUT = 3
+};
+
+// Latest state of the parameter since the last delivery to the UI
+struct WSParameterUpdate {
+	quint32 paramId;
+	bool requested;
+	quint32 requestsCount;
+	WSUpdateResult result;
+	// Responses, errors or timeouts counter of the result
+	quint32 resultCount;
+	quint8 error;
+	// Result time, ms since epoch
+	qint64 time;
+	// Raw value and its view settings at the result time
+	QByteArray value;
+	WSDataType dataType;
+	WSByteOrder dataByteOrder;
+	WSDataRepresent dataRepresent;
+	quint8 dataTypeSize;
+	bool dataSigned;
+	// Latency of the queued write (us from queueing to the result), -1 if none
+	qint64 latency;
+};
+
+// Per-interface buffer written directly by the polling thread and drained by the UI thread,
+// updates of the parameter between deliveries are coalesced (the latest result wins)
+class WSUpdateBuffer {
+
+public:
+	WSUpdateBuffer();
+
+	void requested(quint32 paramId, const WSModbusParameter *param);
+	void valueChanged(quint32 paramId, const WSModbusParameter *param);
+	void errorOccurred(quint32 paramId, const WSModbusParameter *param);
+	void timeoutOccurred(quint32 paramId, const WSModbusParameter *param);
+	void written(quint32 paramId, quint32 latency);
+
+	// Updates in order of the first change since the last call
+	std::vector<WSParameterUpdate> take();
+
+private:
+	QMutex m_lock;
+	std::vector<WSParameterUpdate> m_updates;
+	QHash<quint32, quint32> m_index;
+
+	WSParameterUpdate &entry(quint32 paramId);
+	void result(quint32 paramId, const WSModbusParameter *param, WSUpdateResult result, quint32 count);
+};
+
+#endif // WSUPDATEBUFFER_H
@@ -35,7 +35,19 @@ SOURCES += \
     protocols/wsmodbusrtuprotocol.cpp \
     utils/wssettings.cpp \
     utils/wsfile.cpp \
-    conf.cpp
+    conf.cpp \
+    protocols/wsmodbusblockplanner.cpp \
+    interfaces/wsreactorpool.cpp \
+    interfaces/wsrttestimator.cpp \
+    interfaces/wsudpinterface.cpp \
+    interfaces/wsreplayinterface.cpp \
+    utils/wstrafficcapture.cpp \
+    utils/wsupdatebuffer.cpp \
+    interfaces/wsreceivebuffer.cpp \
+    protocols/wsmodbuswritequeue.cpp \
+    interfaces/wslatencyhistogram.cpp \
+    interfaces/wstransactionwindow.cpp \
+    protocols/wsmodbusclientprotocol.cpp
 
 RESOURCES += qml.qrc
 
@@ -73,4 +85,16 @@ HEADERS += \
     interfaces/wsserialinterface.h \
     protocols/wsmodbusrtuprotocol.h \
     utils/wssettings.h \
-    utils/wsfile.h
+    utils/wsfile.h \
+    protocols/wsmodbusblockplanner.h \
+    interfaces/wsreactorpool.h \
+    interfaces/wsrttestimator.h \
+    interfaces/wsudpinterface.h \
+    interfaces/wsreplayinterface.h \
+    utils/wstrafficcapture.h \
+    utils/wsupdatebuffer.h \
+    interfaces/wsreceivebuffer.h \
+    protocols/wsmodbuswritequeue.h \
+    interfaces/wslatencyhistogram.h \
+    interfaces/wstransactionwindow.h \
+    protocols/wsmodbusclientprotocol.h
@@ -24,11 +24,15 @@
 
 WSQMLApplication::WSQMLApplication(QObject *parent) :
 	QObject(parent),
+	m_reactors(Conf::DEVICE_REACTOR_THREADS),
 	m_interfacesCounter(0),
 	m_logInterfaceData(false)
 {
 	m_storeSettings = nullptr;
+	m_ratesClock.start();
 	refreshAvailablePorts();
+	connect(&m_updateTimer, &QTimer::timeout, this, &WSQMLApplication::onUpdateTimer);
+	m_updateTimer.start(static_cast<int>(Conf::UI_UPDATE_PERIOD));
 }
 
 WSQMLApplication::~WSQMLApplication() {
@@ -147,6 +151,18 @@ quint8 WSQMLApplication::stringToPollingType(const QString &type) {
 	}
 }
 
+quint8 WSQMLApplication::stringToDeadband(const QString &deadband) {
+	if (deadband == "raw") {
+		return static_cast<quint8>(WSDeadband::RAW);
+	} else if (deadband == "absolute") {
+		return static_cast<quint8>(WSDeadband::ABSOLUTE);
+	} else if (deadband == "percent") {
+		return static_cast<quint8>(WSDeadband::PERCENT);
+	} else {
+		return static_cast<quint8>(WSDeadband::NONE);
+	}
+}
+
 QStringList WSQMLApplication::getAvailablePortNames() {
 	return m_availablePortNames;
 }
@@ -167,61 +183,53 @@ quint32 WSQMLApplication::addInterface(QJSValue data) {
 	// Protocol instance
 	QString protocol = data.property("protocol").toString();
 	WSAbstractRRProtocol *proto = nullptr;
+	// Written directly by the polling thread, delivered to the UI by the update timer
+	std::shared_ptr<WSUpdateBuffer> updates = std::make_shared<WSUpdateBuffer>();
 	if (protocol == "modbus_rtu") {
 		proto = new WSModbusRTUProtocol();
-		connect(static_cast<WSModbusRTUProtocol*>(proto), &WSModbusRTUProtocol::parameterChanged, [=](quint32 paramId, WSModbusParameter *param) {onParameterModbusValueChanged(iid, paramId, param);});
-		connect(static_cast<WSModbusRTUProtocol*>(proto), &WSModbusRTUProtocol::parameterError, [=](quint32 paramId, WSModbusParameter *param) {onParameterModbusError(iid, paramId, param);});
-		connect(static_cast<WSModbusRTUProtocol*>(proto), &WSModbusRTUProtocol::parameterTimeout, [=](quint32 paramId, WSModbusParameter *param) {onParameterTimeout(iid, paramId, param);});
-		connect(static_cast<WSModbusRTUProtocol*>(proto), &WSModbusRTUProtocol::parameterRequest, [=](quint32 paramId, WSModbusParameter *param) {onParameterRequest(iid, paramId, param);});
+		connect(static_cast<WSModbusRTUProtocol*>(proto), &WSModbusRTUProtocol::parameterChanged, [updates](quint32 paramId, WSModbusParameter *param) {updates->valueChanged(paramId, param);});
+		connect(static_cast<WSModbusRTUProtocol*>(proto), &WSModbusRTUProtocol::parameterError, [updates](quint32 paramId, WSModbusParameter *param) {updates->errorOccurred(paramId, param);});
+		connect(static_cast<WSModbusRTUProtocol*>(proto), &WSModbusRTUProtocol::parameterTimeout, [updates](quint32 paramId, WSModbusParameter *param) {updates->timeoutOccurred(paramId, param);});
+		connect(static_cast<WSModbusRTUProtocol*>(proto), &WSModbusRTUProtocol::parameterRequest, [updates](quint32 paramId, WSModbusParameter *param) {updates->requested(paramId, param);});
+		connect(static_cast<WSModbusRTUProtocol*>(proto), &WSModbusRTUProtocol::parameterWritten, [updates](quint32 paramId, WSModbusParameter*, quint32 latency) {updates->written(paramId, latency);});
+		connect(static_cast<WSModbusRTUProtocol*>(proto), &WSModbusRTUProtocol::deviceHealthChanged, [=](quint32 device, bool alive) {onDeviceHealthChanged(iid, device, alive);});
 	} else if (protocol == "modbus_ascii") {
 		return 0;
 	} else if (protocol == "modbus_tcp") {
 		proto = new WSModbusTCPProtocol();
-		connect(static_cast<WSModbusTCPProtocol*>(proto), &WSModbusTCPProtocol::parameterChanged, [=](quint32 paramId, WSModbusParameter *param) {onParameterModbusValueChanged(iid, paramId, param);});
-		connect(static_cast<WSModbusTCPProtocol*>(proto), &WSModbusTCPProtocol::parameterError, [=](quint32 paramId, WSModbusParameter *param) {onParameterModbusError(iid, paramId, param);});
-		connect(static_cast<WSModbusTCPProtocol*>(proto), &WSModbusTCPProtocol::parameterTimeout, [=](quint32 paramId, WSModbusParameter *param) {onParameterTimeout(iid, paramId, param);});
-		connect(static_cast<WSModbusTCPProtocol*>(proto), &WSModbusTCPProtocol::parameterRequest, [=](quint32 paramId, WSModbusParameter *param) {onParameterRequest(iid, paramId, param);});
+		connect(static_cast<WSModbusTCPProtocol*>(proto), &WSModbusTCPProtocol::parameterChanged, [updates](quint32 paramId, WSModbusParameter *param) {updates->valueChanged(paramId, param);});
+		connect(static_cast<WSModbusTCPProtocol*>(proto), &WSModbusTCPProtocol::parameterError, [updates](quint32 paramId, WSModbusParameter *param) {updates->errorOccurred(paramId, param);});
+		connect(static_cast<WSModbusTCPProtocol*>(proto), &WSModbusTCPProtocol::parameterTimeout, [updates](quint32 paramId, WSModbusParameter *param) {updates->timeoutOccurred(paramId, param);});
+		connect(static_cast<WSModbusTCPProtocol*>(proto), &WSModbusTCPProtocol::parameterRequest, [updates](quint32 paramId, WSModbusParameter *param) {updates->requested(paramId, param);});
+		connect(static_cast<WSModbusTCPProtocol*>(proto), &WSModbusTCPProtocol::parameterWritten, [updates](quint32 paramId, WSModbusParameter*, quint32 latency) {updates->written(paramId, latency);});
 	} else if (protocol == "dcon") {
 		return 0;
 	} else {
 		return 0;
 	}
 	// Transport instance
-	WSPollingRRInterface *iface;
-	QString transport = data.property("transportType").toString();
-
-	// Serial transport
-	if (transport == "serial") {
-		iface = new WSSerialInterface(
-			data.property("serial").property("port").toString(),
-			proto,
-			QThread::currentThread()
-		);
-		proto->setParent(iface);
-		(static_cast<WSSerialInterface*>(iface))->setBaudRate(data.property("serial").property("baudrate").toInt());
-		(static_cast<WSSerialInterface*>(iface))->setDataBits(WSSerialInterface::dataBitsFromNumber(data.property("serial").property("dataBits").toInt()));
-		(static_cast<WSSerialInterface*>(iface))->setParity(WSSerialInterface::parityFromString(data.property("serial").property("parity").toString()));
-		(static_cast<WSSerialInterface*>(iface))->setStopBits(WSSerialInterface::stopBitsFromString(data.property("serial").property("stopBits").toString()));
-
-	// TCP transport
-	} else if (transport == "tcp") {
-		iface = new WSSocketInterface(
-			QHostAddress(data.property("tcp").property("ipAddress").toString()),
-			static_cast<quint16>(data.property("tcp").property("port").toUInt()),
-			proto,
-			QThread::currentThread()
-		);
-		proto->setParent(iface);
-
-	// Undefined transport
-	} else {
+	WSPollingRRInterface *iface = createTransport(data.property("transportType").toString(), data, proto);
+	if (iface == nullptr) {
 		delete proto;
 		return 0;
 	}
 	// Common interface parameters
 	iface->setTransmitTimeout(data.property("timeout").toUInt());
 	iface->setReceiveTimeout(data.property("timeout").toUInt());
+	// Fixed timeout of the sessions saved before the adaptive timeout
+	iface->setAdaptiveTimeout(data.hasProperty("adaptiveTimeout") && data.property("adaptiveTimeout").toBool());
+	iface->setAdaptiveTimeoutMin(data.hasProperty("adaptiveTimeoutMin") ? data.property("adaptiveTimeoutMin").toUInt() : Conf::DEVICE_ADAPTIVE_TIMEOUT_MIN);
+	iface->setAdaptiveTimeoutMax(data.hasProperty("adaptiveTimeoutMax") ? data.property("adaptiveTimeoutMax").toUInt() : Conf::DEVICE_ADAPTIVE_TIMEOUT_MAX);
 	iface->setPollingPause(data.property("pollingPause").toUInt());
+	if (iface->type() == WSInterface::TCP) {
+		static_cast<WSSocketInterface*>(iface)->setPipelineWindow(data.hasProperty("pipelineWindow") ? data.property("pipelineWindow").toUInt() : 1);
+		static_cast<WSSocketInterface*>(iface)->setConnections(data.hasProperty("connections") ? data.property("connections").toUInt() : 1);
+	} else if (iface->type() == WSInterface::UDP) {
+		static_cast<WSUdpInterface*>(iface)->setPipelineWindow(data.hasProperty("pipelineWindow") ? data.property("pipelineWindow").toUInt() : 1);
+	} else if (iface->type() == WSInterface::SERIAL) {
+		static_cast<WSSerialInterface*>(iface)->setListenOnly(data.hasProperty("listenOnly") && data.property("listenOnly").toBool());
+	}
+	applyProtocolSettings(proto, data);
 	connect(iface, &WSPollingInterface::started, this, [=]() {onInterfacePollingStarted(iid);});
 	connect(iface, &WSPollingInterface::connected, this, [=]() {onInterfacePollingConnected(iid);});
 	connect(iface, &WSPollingInterface::disconnected, this, [=]() {onInterfacePollingDisconnected(iid);});
@@ -232,11 +240,14 @@ quint32 WSQMLApplication::addInterface(QJSValue data) {
 	connect(iface, &WSPollingRRInterface::received, this, [=](QByteArray receivedData) {onReceivedData(iid, receivedData);});
 	connect(iface, &WSPollingRRInterface::transmitTimeoutOccurred, this, [=](quint32 timeout) {onTransmitTimeoutOccurred(iid, timeout);});
 	connect(iface, &WSPollingRRInterface::receiveTimeoutOccurred, this, [=](quint32 timeout) {onReceiveTimeoutOccurred(iid, timeout);});
+	connect(iface, &WSPollingRRInterface::transactionTimeoutOccurred, this, [=](quint32, quint32 timeout) {onReceiveTimeoutOccurred(iid, timeout);});
 	connect(iface, &WSPollingRRInterface::validDataReceived, this, [=]() {onValidDataReceived(iid);});
 	//connect(iface, &WSPollingRRInterface::incompleteDataReceived, this, [=]() {onIncompleteDataReceived(iid);});
 	connect(iface, &WSPollingRRInterface::errorDataReceived, this, [=]() {onErrorDataReceived(iid);});
+	connect(iface, &WSPollingRRInterface::deviceTimingChanged, this, [=](quint32 device, quint32 srtt, quint32 rttvar, quint32 timeout) {emit interfaceDeviceTiming(iid, device, srtt, rttvar, timeout);});
 
 	m_interfaces[iid] = std::unique_ptr<WSPollingInterface>(iface);
+	m_updates[iid] = updates;
 	m_interfacesCounter++;
 	return iid;
 }
@@ -245,7 +256,7 @@ bool WSQMLApplication::editInterface(quint32 id, QJSValue data) {
 	if (m_interfaces.find(id) != m_interfaces.end()) {
 		WSPollingInterface *iface = m_interfaces[id].get();
 		// PollingRRInterface
-		if (iface->type() == WSInterface::TCP || iface->type() == WSInterface::SERIAL) {
+		if (iface->type() == WSInterface::TCP || iface->type() == WSInterface::SERIAL || iface->type() == WSInterface::UDP || iface->type() == WSInterface::REPLAY) {
 			WSPollingRRInterface *ifaceRR = static_cast<WSPollingRRInterface*>(iface);
 			// Check protocols change
 			WSRRProtocol protocolType = ifaceRR->protocolGet()->type();
@@ -266,32 +277,15 @@ bool WSQMLApplication::editInterface(quint32 id, QJSValue data) {
 			if (data.hasProperty("transportType")) {
 				bool protocolChanged = false;
 				QString transport = data.property("transportType").toString();
-				if (transport == "serial" && transportType == WSInterface::TCP) {
+				bool transportChanged = (transport == "serial" && transportType != WSInterface::SERIAL)
+					|| (transport == "tcp" && transportType != WSInterface::TCP)
+					|| (transport == "udp" && transportType != WSInterface::UDP)
+					|| (transport == "replay" && transportType != WSInterface::REPLAY);
+				if (transportChanged) {
 					WSAbstractRRProtocol *proto = ifaceRR->protocolRelease();
 					proto->setParent(this);
 					m_interfaces[id].reset(nullptr);
-					iface = new WSSerialInterface(
-						data.property("serial").property("port").toString(),
-						proto,
-						QThread::currentThread()
-					);
-					proto->setParent(iface);
-					(static_cast<WSSerialInterface*>(iface))->setBaudRate(data.property("serial").property("baudrate").toInt());
-					(static_cast<WSSerialInterface*>(iface))->setDataBits(WSSerialInterface::dataBitsFromNumber(data.property("serial").property("dataBits").toInt()));
-					(static_cast<WSSerialInterface*>(iface))->setParity(WSSerialInterface::parityFromString(data.property("serial").property("parity").toString()));
-					(static_cast<WSSerialInterface*>(iface))->setStopBits(WSSerialInterface::stopBitsFromString(data.property("serial").property("stopBits").toString()));
-					protocolChanged = true;
-				} else if (transport == "tcp" && transportType == WSInterface::SERIAL) {
-					WSAbstractRRProtocol *proto = ifaceRR->protocolRelease();
-					proto->setParent(this);
-					m_interfaces[id].reset(nullptr);
-					iface = new WSSocketInterface(
-						QHostAddress(data.property("tcp").property("ipAddress").toString()),
-						static_cast<quint16>(data.property("tcp").property("port").toUInt()),
-						proto,
-						QThread::currentThread()
-					);
-					proto->setParent(iface);
+					iface = createTransport(transport, data, proto);
 					protocolChanged = true;
 				} else if (transportType == WSInterface::SERIAL) {
 					(static_cast<WSSerialInterface*>(iface))->setBaudRate(data.property("serial").property("baudrate").toInt());
@@ -301,6 +295,12 @@ bool WSQMLApplication::editInterface(quint32 id, QJSValue data) {
 				} else if (transportType == WSInterface::TCP) {
 					(static_cast<WSSocketInterface*>(iface))->setIpAddress(QHostAddress(data.property("tcp").property("ipAddress").toString()));
 					(static_cast<WSSocketInterface*>(iface))->setPort(static_cast<quint16>(data.property("tcp").property("port").toUInt()));
+				} else if (transportType == WSInterface::UDP) {
+					(static_cast<WSUdpInterface*>(iface))->setIpAddress(QHostAddress(data.property("tcp").property("ipAddress").toString()));
+					(static_cast<WSUdpInterface*>(iface))->setPort(static_cast<quint16>(data.property("tcp").property("port").toUInt()));
+				} else if (transportType == WSInterface::REPLAY) {
+					(static_cast<WSReplayInterface*>(iface))->setFileName(getFilePath(QUrl(data.property("replayFile").toString())));
+					(static_cast<WSReplayInterface*>(iface))->setSpeed(data.property("replaySpeed").toNumber() / 100);
 				}
 				if (protocolChanged) {
 					ifaceRR = static_cast<WSPollingRRInterface*>(iface);
@@ -314,28 +314,113 @@ bool WSQMLApplication::editInterface(quint32 id, QJSValue data) {
 					connect(ifaceRR, &WSPollingRRInterface::received, this, [=](QByteArray receivedData) {onReceivedData(id, receivedData);});
 					connect(ifaceRR, &WSPollingRRInterface::transmitTimeoutOccurred, this, [=](quint32 timeout) {onTransmitTimeoutOccurred(id, timeout);});
 					connect(ifaceRR, &WSPollingRRInterface::receiveTimeoutOccurred, this, [=](quint32 timeout) {onReceiveTimeoutOccurred(id, timeout);});
+					connect(ifaceRR, &WSPollingRRInterface::transactionTimeoutOccurred, this, [=](quint32, quint32 timeout) {onReceiveTimeoutOccurred(id, timeout);});
 					connect(ifaceRR, &WSPollingRRInterface::validDataReceived, this, [=]() {onValidDataReceived(id);});
 					//connect(ifaceRR, &WSPollingRRInterface::incompleteDataReceived, this, [=]() {onIncompleteDataReceived(id);});
 					connect(ifaceRR, &WSPollingRRInterface::errorDataReceived, this, [=]() {onErrorDataReceived(id);});
+					connect(ifaceRR, &WSPollingRRInterface::deviceTimingChanged, this, [=](quint32 device, quint32 srtt, quint32 rttvar, quint32 timeout) {emit interfaceDeviceTiming(id, device, srtt, rttvar, timeout);});
 					m_interfaces[id] = std::unique_ptr<WSPollingInterface>(iface);
 				}
 			}
 			// Common interface parameters
 			ifaceRR->setTransmitTimeout(data.property("timeout").toUInt());
 			ifaceRR->setReceiveTimeout(data.property("timeout").toUInt());
+			// Fixed timeout of the sessions saved before the adaptive timeout
+			ifaceRR->setAdaptiveTimeout(data.hasProperty("adaptiveTimeout") && data.property("adaptiveTimeout").toBool());
+			ifaceRR->setAdaptiveTimeoutMin(data.hasProperty("adaptiveTimeoutMin") ? data.property("adaptiveTimeoutMin").toUInt() : Conf::DEVICE_ADAPTIVE_TIMEOUT_MIN);
+			ifaceRR->setAdaptiveTimeoutMax(data.hasProperty("adaptiveTimeoutMax") ? data.property("adaptiveTimeoutMax").toUInt() : Conf::DEVICE_ADAPTIVE_TIMEOUT_MAX);
 			ifaceRR->setPollingPause(data.property("pollingPause").toUInt());
+			if (ifaceRR->type() == WSInterface::TCP) {
+				static_cast<WSSocketInterface*>(ifaceRR)->setPipelineWindow(data.hasProperty("pipelineWindow") ? data.property("pipelineWindow").toUInt() : 1);
+				static_cast<WSSocketInterface*>(ifaceRR)->setConnections(data.hasProperty("connections") ? data.property("connections").toUInt() : 1);
+			} else if (ifaceRR->type() == WSInterface::UDP) {
+				static_cast<WSUdpInterface*>(ifaceRR)->setPipelineWindow(data.hasProperty("pipelineWindow") ? data.property("pipelineWindow").toUInt() : 1);
+			} else if (ifaceRR->type() == WSInterface::SERIAL) {
+				static_cast<WSSerialInterface*>(ifaceRR)->setListenOnly(data.hasProperty("listenOnly") && data.property("listenOnly").toBool());
+			}
+			applyProtocolSettings(ifaceRR->protocolGet(), data);
 			return true;
 		}
 	}
 	return false;
 }
 
+// Transport instance for protocol, nullptr - undefined transport
+WSPollingRRInterface *WSQMLApplication::createTransport(const QString &transport, QJSValue data, WSAbstractRRProtocol *proto) {
+	WSPollingRRInterface *iface;
+	// Serial transport
+	if (transport == "serial") {
+		iface = new WSSerialInterface(
+			data.property("serial").property("port").toString(),
+			proto,
+			QThread::currentThread()
+		);
+		proto->setParent(iface);
+		(static_cast<WSSerialInterface*>(iface))->setBaudRate(data.property("serial").property("baudrate").toInt());
+		(static_cast<WSSerialInterface*>(iface))->setDataBits(WSSerialInterface::dataBitsFromNumber(data.property("serial").property("dataBits").toInt()));
+		(static_cast<WSSerialInterface*>(iface))->setParity(WSSerialInterface::parityFromString(data.property("serial").property("parity").toString()));
+		(static_cast<WSSerialInterface*>(iface))->setStopBits(WSSerialInterface::stopBitsFromString(data.property("serial").property("stopBits").toString()));
+
+	// TCP transport
+	} else if (transport == "tcp") {
+		iface = new WSSocketInterface(
+			QHostAddress(data.property("tcp").property("ipAddress").toString()),
+			static_cast<quint16>(data.property("tcp").property("port").toUInt()),
+			proto,
+			QThread::currentThread()
+		);
+		proto->setParent(iface);
+
+	// UDP transport (address settings are shared with TCP)
+	} else if (transport == "udp") {
+		iface = new WSUdpInterface(
+			QHostAddress(data.property("tcp").property("ipAddress").toString()),
+			static_cast<quint16>(data.property("tcp").property("port").toUInt()),
+			proto,
+			QThread::currentThread()
+		);
+		proto->setParent(iface);
+
+	// Captured traffic replay
+	} else if (transport == "replay") {
+		iface = new WSReplayInterface(
+			getFilePath(QUrl(data.property("replayFile").toString())),
+			proto,
+			QThread::currentThread()
+		);
+		proto->setParent(iface);
+		(static_cast<WSReplayInterface*>(iface))->setSpeed(data.property("replaySpeed").toNumber() / 100);
+
+	// Undefined transport
+	} else {
+		return nullptr;
+	}
+	// Received data is copied for signals only if it is logged
+	iface->setDataTrace(m_logInterfaceData);
+	return iface;
+}
+
 bool WSQMLApplication::removeInterface(quint32 id) {
 	if (m_interfaces.find(id) != m_interfaces.end()) {
-		if (m_interfacesThreads.find(id) != m_interfacesThreads.end()) {
+		auto reactor = m_interfacesReactors.find(id);
+		if (reactor != m_interfacesReactors.end()) {
+			// Interface lives in the shared reactor thread, it is stopped and destroyed there
+			m_interfaces[id]->stop();
+			m_interfaces[id].release()->deleteLater();
+			m_reactors.release(reactor->second);
+			m_interfacesReactors.erase(reactor);
+		} else if (m_interfacesThreads.find(id) != m_interfacesThreads.end()) {
 			m_interfaces[id]->stop();
 		}
 		m_interfaces.erase(id);
+		// Slots still running in the polling thread keep the capture alive
+		auto capture = m_captures.find(id);
+		if (capture != m_captures.end()) {
+			capture->second->close();
+			m_captures.erase(capture);
+		}
+		m_updates.erase(id);
+		m_rates.erase(id);
 		if (m_interfaces.size() == 0) {
 			m_interfacesCounter = 0;
 		}
@@ -349,7 +434,7 @@ quint32 WSQMLApplication::addParameter(quint32 interfaceId, QJSValue data) {
 	if (m_interfaces.find(interfaceId) != m_interfaces.end()) {
 		WSPollingInterface *iface = m_interfaces[interfaceId].get();
 		// PollingRRInterface
-		if (iface->type() == WSInterface::TCP || iface->type() == WSInterface::SERIAL) {
+		if (iface->type() == WSInterface::TCP || iface->type() == WSInterface::SERIAL || iface->type() == WSInterface::UDP || iface->type() == WSInterface::REPLAY) {
 			WSRRProtocol protocolType = static_cast<WSPollingRRInterface*>(iface)->protocolGet()->type();
 			// ***** Modbus TCP/RTU *****
 			if (protocolType == WSRRProtocol::MODBUS_TCP || protocolType == WSRRProtocol::MODBUS_RTU) {
@@ -368,6 +453,21 @@ quint32 WSQMLApplication::addParameter(quint32 interfaceId, QJSValue data) {
 					data.property("view").property("sign").toBool()
 					);
 				p->setEnabled(data.property("poll").toBool());
+				if (data.hasProperty("period")) {
+					p->setPeriod(data.property("period").toUInt());
+				}
+				if (data.hasProperty("priority")) {
+					p->setPriority(static_cast<quint8>(data.property("priority").toUInt()));
+				}
+				if (data.hasProperty("deadband")) {
+					p->setDeadband(static_cast<WSDeadband>(stringToDeadband(data.property("deadband").toString())));
+				}
+				if (data.hasProperty("deadband_value")) {
+					p->setDeadbandValue(data.property("deadband_value").toNumber());
+				}
+				if (data.hasProperty("heartbeat")) {
+					p->setHeartbeat(data.property("heartbeat").toUInt());
+				}
 				if (data.hasProperty("setted_value")) {
 					memcpy(p->param()->value, data.property("setted_value").toVariant().toByteArray().constData(), p->param()->size);
 				}
@@ -391,7 +491,7 @@ bool WSQMLApplication::editParameter(quint32 interfaceId, quint32 id, QJSValue d
 	if (m_interfaces.find(interfaceId) != m_interfaces.end()) {
 		WSPollingInterface *iface = m_interfaces[interfaceId].get();
 		// PollingRRInterface
-		if (iface->type() == WSInterface::TCP || iface->type() == WSInterface::SERIAL) {
+		if (iface->type() == WSInterface::TCP || iface->type() == WSInterface::SERIAL || iface->type() == WSInterface::UDP || iface->type() == WSInterface::REPLAY) {
 			WSRRProtocol protocolType = static_cast<WSPollingRRInterface*>(iface)->protocolGet()->type();
 			// ***** Modbus TCP / RTU *****
 			if (protocolType == WSRRProtocol::MODBUS_TCP || protocolType == WSRRProtocol::MODBUS_RTU) {
@@ -409,27 +509,51 @@ bool WSQMLApplication::editParameter(quint32 interfaceId, quint32 id, QJSValue d
 				}
 				// Edit parameter
 				if (p != nullptr) {
-					if (data.hasProperty("alias")) {
-						p->setAlias(data.property("alias").toString());
-					}
-					if (data.hasProperty("devadr")) {
-						p->param()->device_adr = static_cast<quint8>(data.property("devadr").toUInt());
-					}
-					if (data.hasProperty("fcode")) {
-						p->param()->function_code = static_cast<quint8>(data.property("fcode").toUInt());
-					}
-					if (data.hasProperty("adr")) {
-						p->param()->register_adr = static_cast<quint16>(data.property("adr").toUInt());
-					}
-					if (data.hasProperty("count")) {
-						p->param()->func_size = static_cast<quint16>(data.property("count").toUInt());
-						// Recalculate and reallocate value size
-						if (modbus_client_calc_param_size(p->param()) == 0) {
-							return false;
+					// Request fields are not changed under the polling thread, the parameter is replaced by an edited copy
+					// (only if they differ, other settings are changed in place)
+					bool replaced = false;
+					quint8 devadr = data.hasProperty("devadr") ? static_cast<quint8>(data.property("devadr").toUInt()) : p->param()->device_adr;
+					quint8 fcode = data.hasProperty("fcode") ? static_cast<quint8>(data.property("fcode").toUInt()) : p->param()->function_code;
+					quint16 adr = data.hasProperty("adr") ? static_cast<quint16>(data.property("adr").toUInt()) : p->param()->register_adr;
+					quint16 count = data.hasProperty("count") ? static_cast<quint16>(data.property("count").toUInt()) : p->param()->func_size;
+					WSPollingType type = data.hasProperty("type") ? static_cast<WSPollingType>(stringToPollingType(data.property("type").toString())) : p->pollingType();
+					if (devadr != p->param()->device_adr || fcode != p->param()->function_code || adr != p->param()->register_adr || count != p->param()->func_size || type != p->pollingType()) {
+						WSModbusParameter *np = new WSModbusParameter(
+							p->alias(),
+							devadr,
+							fcode,
+							adr,
+							count,
+							type,
+							p->dataType(),
+							p->dataByteOrder(),
+							p->dataRepresent(),
+							p->dataTypeSize(),
+							p->dataSigned()
+							);
+						np->setEnabled(p->enabled());
+						np->setPeriod(p->period());
+						np->setPriority(p->priority());
+						np->setDeadband(p->deadband());
+						np->setDeadbandValue(p->deadbandValue());
+						np->setHeartbeat(p->heartbeat());
+						np->setRequestsCount(p->requestsCount());
+						np->setResponsesCount(p->responsesCount());
+						np->setErrorsCount(p->errorsCount());
+						np->setTimeoutsCount(p->timeoutsCount());
+						if (np->param()->size == p->param()->size) {
+							memcpy(np->param()->value, p->param()->value, p->param()->size);
 						}
+						p = np;
+						replaced = true;
 					}
-					if (data.hasProperty("type")) {
-						p->param()->type = stringToPollingType(data.property("type").toString());
+					// Alias, view, deadband and heartbeat do not change the requests plan
+					bool enabled = p->enabled();
+					quint32 period = p->period();
+					quint8 priority = p->priority();
+					bool replan = replaced;
+					if (data.hasProperty("alias")) {
+						p->setAlias(data.property("alias").toString());
 					}
 					if (data.hasProperty("view")) {
 						if (data.property("view").hasProperty("type")) {
@@ -448,12 +572,62 @@ bool WSQMLApplication::editParameter(quint32 interfaceId, quint32 id, QJSValue d
 							p->setDataSigned(data.property("view").property("sign").toBool());
 						}
 					}
+					// Setpoint is written ahead of the polling cycle instead of waiting for the scheduler
+					bool write = false;
 					if (data.hasProperty("poll")) {
-						p->setEnabled(data.property("poll").toBool());
+						write = !replaced && data.property("poll").toBool() && p->pollingType() == WSPollingType::ONCE_SET;
+						if (!write) {
+							p->setEnabled(data.property("poll").toBool());
+						}
+					}
+					if (data.hasProperty("period")) {
+						p->setPeriod(data.property("period").toUInt());
+					}
+					if (data.hasProperty("priority")) {
+						p->setPriority(static_cast<quint8>(data.property("priority").toUInt()));
+					}
+					if (data.hasProperty("deadband")) {
+						p->setDeadband(static_cast<WSDeadband>(stringToDeadband(data.property("deadband").toString())));
+					}
+					if (data.hasProperty("deadband_value")) {
+						p->setDeadbandValue(data.property("deadband_value").toNumber());
+					}
+					if (data.hasProperty("heartbeat")) {
+						p->setHeartbeat(data.property("heartbeat").toUInt());
 					}
 					if (data.hasProperty("setted_value")) {
 						memcpy(p->param()->value, data.property("setted_value").toVariant().toByteArray().constData(), p->param()->size);
-						QByteArray arrr = data.property("setted_value").toVariant().toByteArray();
+					}
+					if (write) {
+						bool queued = false;
+						if (protocolType == WSRRProtocol::MODBUS_TCP) {
+							queued = static_cast<WSModbusTCPProtocol*>(static_cast<WSPollingRRInterface*>(iface)->protocolGet())->queueWrite(id);
+						} else if (protocolType == WSRRProtocol::MODBUS_RTU) {
+							queued = static_cast<WSModbusRTUProtocol*>(static_cast<WSPollingRRInterface*>(iface)->protocolGet())->queueWrite(id);
+						}
+						if (!queued) {
+							p->setEnabled(true);
+						}
+					}
+					replan = replan || p->enabled() != enabled || p->period() != period || p->priority() != priority;
+					// Requests planning depends on parameter settings
+					if (!replan) {
+						return true;
+					}
+					if (protocolType == WSRRProtocol::MODBUS_TCP) {
+						WSParametersHash<WSModbusParameter> &params = static_cast<WSModbusTCPProtocol*>(static_cast<WSPollingRRInterface*>(iface)->protocolGet())->params();
+						if (replaced) {
+							params.append(id, p);
+						} else {
+							params.update(id);
+						}
+					} else if (protocolType == WSRRProtocol::MODBUS_RTU) {
+						WSParametersHash<WSModbusParameter> &params = static_cast<WSModbusRTUProtocol*>(static_cast<WSPollingRRInterface*>(iface)->protocolGet())->params();
+						if (replaced) {
+							params.append(id, p);
+						} else {
+							params.update(id);
+						}
 					}
 					return true;
 				}
@@ -468,7 +642,7 @@ bool WSQMLApplication::removeParameter(quint32 interfaceId, quint32 id) {
 	if (m_interfaces.find(interfaceId) != m_interfaces.end()) {
 		WSPollingInterface *iface = m_interfaces[interfaceId].get();
 		// PollingRRInterface
-		if (iface->type() == WSInterface::TCP || iface->type() == WSInterface::SERIAL) {
+		if (iface->type() == WSInterface::TCP || iface->type() == WSInterface::SERIAL || iface->type() == WSInterface::UDP || iface->type() == WSInterface::REPLAY) {
 			WSRRProtocol protocolType = static_cast<WSPollingRRInterface*>(iface)->protocolGet()->type();
 			// ***** Modbus TCP/RTU *****
 			WSAbstractRRProtocol *prot = static_cast<WSAbstractRRProtocol*>(static_cast<WSPollingRRInterface*>(iface)->protocolGet());
@@ -494,7 +668,17 @@ bool WSQMLApplication::startInterfacePolling(quint32 id) {
 	// Find interface
 	if (m_interfaces.find(id) != m_interfaces.end()) {
 		// Make sure the thread is destroyed
-		if (m_interfacesThreads.find(id) == m_interfacesThreads.end()) {
+		if (!isInterfacePolling(id)) {
+			WSPollingInterface *iface = m_interfaces[id].get();
+			if (iface->eventDriven()) {
+				// Share the reactor thread with other event-driven interfaces
+				QThread *reactor = m_reactors.acquire();
+				m_interfacesReactors[id] = reactor;
+				iface->moveToThread(reactor);
+				QMetaObject::invokeMethod(iface, [iface]() {iface->start();}, Qt::QueuedConnection);
+				emit info(whoIAm, QString("Interface#") + QString::number(id) + " started in reactor thread.");
+				return true;
+			}
 			// Create thread
 			m_interfacesThreads[id] = std::unique_ptr<QThread>(new QThread());
 			// Move interface to thread and start
@@ -512,7 +696,7 @@ bool WSQMLApplication::startInterfacePolling(quint32 id) {
 bool WSQMLApplication::stopInterfacePolling(quint32 id) {
 	emit info(whoIAm, QString("Stop interface#") + QString::number(id) + " polling.");
 	// Find interface and his thread
-	if (m_interfaces.find(id) != m_interfaces.end() && m_interfacesThreads.find(id) != m_interfacesThreads.end()) {
+	if (m_interfaces.find(id) != m_interfaces.end() && isInterfacePolling(id)) {
 		m_interfaces[id]->stop();
 		return true;
 	}
@@ -526,45 +710,115 @@ bool WSQMLApplication::isInterfaceStarted(quint32 id) {
 	return false;
 }
 
-void WSQMLApplication::onParameterModbusValueChanged(quint32 interfaceId, quint32 paramId, WSModbusParameter *p) {
-	auto dc = make_data_converter(
-		reinterpret_cast<char*>(p->param()->value),
-		p->param()->size,
-		p->dataByteOrder(),
-		p->dataType(),
-		p->dataTypeSize(),
-		p->dataSigned()
-		);
-	QStringList strListValue;
-	if (dc.get() != nullptr) {
-		strListValue = dc->toStringList(p->dataRepresent(), Conf::FLOAT_DATA_PRECISION, Conf::MULTI_DATA_DIVIDER);
+QVariantMap WSQMLApplication::interfaceStatistics(quint32 id) {
+	QVariantMap m;
+	if (m_interfaces.find(id) == m_interfaces.end()) {
+		return m;
+	}
+	WSPollingInterface *iface = m_interfaces[id].get();
+	if (iface->type() != WSInterface::TCP && iface->type() != WSInterface::SERIAL && iface->type() != WSInterface::UDP && iface->type() != WSInterface::REPLAY) {
+		return m;
+	}
+	WSPollingRRInterface *ifaceRR = static_cast<WSPollingRRInterface*>(iface);
+	m["rtt"] = histogramToMap(ifaceRR->rttHistogram());
+	m["cycle"] = histogramToMap(ifaceRR->cycleHistogram());
+	m["jitter"] = histogramToMap(ifaceRR->jitterHistogram());
+	quint64 frames = ifaceRR->framesCount();
+	quint64 bytes = ifaceRR->bytesCount();
+	qint64 now = m_ratesClock.elapsed();
+	auto it = m_rates.find(id);
+	double framesRate = 0;
+	double bytesRate = 0;
+	if (it != m_rates.end() && now > it->second.time) {
+		// Counters are reset on start
+		quint64 prevFrames = (frames >= it->second.frames) ? it->second.frames : 0;
+		quint64 prevBytes = (bytes >= it->second.bytes) ? it->second.bytes : 0;
+		double seconds = (now - it->second.time) / 1000.0;
+		framesRate = (frames - prevFrames) / seconds;
+		bytesRate = (bytes - prevBytes) / seconds;
+	}
+	m_rates[id] = WSInterfaceRate{frames, bytes, now};
+	m["frames"] = frames;
+	m["bytes"] = bytes;
+	m["framesRate"] = framesRate;
+	m["bytesRate"] = bytesRate;
+	return m;
+}
+
+QVariantMap WSQMLApplication::histogramToMap(const WSLatencyHistogram &histogram) {
+	QVariantMap m;
+	m["count"] = histogram.count();
+	m["p50"] = histogram.percentile(50) / 1000.0;
+	m["p95"] = histogram.percentile(95) / 1000.0;
+	m["p99"] = histogram.percentile(99) / 1000.0;
+	m["max"] = histogram.max() / 1000.0;
+	return m;
+}
+
+void WSQMLApplication::setValuesUpdatePeriod(quint32 period) {
+	m_updateTimer.setInterval(static_cast<int>(qMax(period, 1u)));
+}
+
+quint32 WSQMLApplication::valuesUpdatePeriod() const {
+	return static_cast<quint32>(m_updateTimer.interval());
+}
+
+// Single batched delivery of the coalesced updates, values are converted to strings only here
+void WSQMLApplication::onUpdateTimer() {
+	QVariantList list;
+	for (auto const& it: m_updates) {
+		std::vector<WSParameterUpdate> updates = it.second->take();
+		for (auto &u: updates) {
+			QVariantMap m;
+			m["interfaceId"] = it.first;
+			m["paramId"] = u.paramId;
+			m["requested"] = u.requested;
+			m["requestCounter"] = u.requestsCount;
+			m["result"] = static_cast<quint32>(u.result);
+			m["counter"] = u.resultCount;
+			m["time"] = u.time;
+			if (u.latency >= 0) {
+				m["latency"] = u.latency / 1000.0;
+			}
+			if (u.result == WSUpdateResult::VALUE) {
+				auto dc = make_data_converter(
+					u.value.data(),
+					u.value.size(),
+					u.dataByteOrder,
+					u.dataType,
+					u.dataTypeSize,
+					u.dataSigned
+					);
+				QStringList strListValue;
+				if (dc.get() != nullptr) {
+					strListValue = dc->toStringList(u.dataRepresent, Conf::FLOAT_DATA_PRECISION, Conf::MULTI_DATA_DIVIDER);
+				}
+				m["value"] = strListValue.value(0);
+				m["valueRaw"] = strListValue.value(1);
+			} else if (u.result == WSUpdateResult::FAILURE) {
+				m["errCode"] = modbusErrorToString(u.error);
+			}
+			list.append(m);
+		}
+	}
+	if (!list.isEmpty()) {
+		emit valuesUpdated(list);
 	}
-	emit valueChanged(interfaceId, paramId, strListValue[0], strListValue[1], p->responsesCount());
 }
 
-void WSQMLApplication::onParameterModbusError(quint32 interfaceId, quint32 paramId, WSModbusParameter *p) {
-	uint8_t err = p->param()->err;
-	QString errStr = "";
+QString WSQMLApplication::modbusErrorToString(quint8 err) {
 	if (err == MB_EC_RESPONSE_ERR) {
-		errStr = "0xFF - Corrupt package";
+		return "0xFF - Corrupt package";
 	} else if (err == MB_EC_ILLEGAL_FUNCTION) {
-		errStr = "0x01 - Illegal function";
+		return "0x01 - Illegal function";
 	} else if (err == MB_EC_ILLEGAL_DATA_ADDRESS) {
-		errStr = "0x02 - Illegal data address";
+		return "0x02 - Illegal data address";
 	} else if (err == MB_EC_ILLEGAL_DATA_VALUE) {
-		errStr = "0x03 - Illegal data value";
+		return "0x03 - Illegal data value";
 	} else if (err == MB_EC_SLAVE_DEVICE_FAILURE) {
-		errStr = "0x04 - Slave device failure";
+		return "0x04 - Slave device failure";
 	}
-	emit valueError(interfaceId, paramId, errStr, p->errorsCount());
-}
-
-void WSQMLApplication::onParameterTimeout(quint32 interfaceId, quint32 paramId, WSModbusParameter* p) {
-	emit valueTimeout(interfaceId, paramId, p->timeoutsCount());
-}
-
-void WSQMLApplication::onParameterRequest(quint32 interfaceId, quint32 paramId, WSModbusParameter* p) {
-	emit valueRequest(interfaceId, paramId, p->requestsCount());
+	return "";
 }
 
 void WSQMLApplication::onInterfacePollingStarted(quint32 interfaceId) {
@@ -581,7 +835,25 @@ void WSQMLApplication::onInterfacePollingDisconnected(quint32 interfaceId) {
 	emit info(whoIAm, QString("Interface#") + QString::number(interfaceId) + " disconnected from host.");
 }
 
+bool WSQMLApplication::isInterfacePolling(quint32 id) const {
+	return m_interfacesThreads.find(id) != m_interfacesThreads.end() || m_interfacesReactors.find(id) != m_interfacesReactors.end();
+}
+
 void WSQMLApplication::onInterfacePollingStopped(quint32 interfaceId) {
+	// Interface shares the reactor thread, it keeps running
+	auto reactor = m_interfacesReactors.find(interfaceId);
+	if (reactor != m_interfacesReactors.end()) {
+		m_reactors.release(reactor->second);
+		m_interfacesReactors.erase(reactor);
+		emit interfacePollingStopped(interfaceId);
+		emit info(whoIAm, QString("Interface#") + QString::number(interfaceId) + " released reactor thread.");
+		return;
+	}
+	// Interface has been removed while stopping
+	if (m_interfacesThreads.find(interfaceId) == m_interfacesThreads.end()) {
+		emit interfacePollingStopped(interfaceId);
+		return;
+	}
 	m_interfacesThreads[interfaceId]->quit();
 	m_interfacesThreads[interfaceId]->wait(5000);
 	// If something strange
@@ -595,6 +867,14 @@ void WSQMLApplication::onInterfacePollingStopped(quint32 interfaceId) {
 	emit info(whoIAm, QString("Interface#") + QString::number(interfaceId) + " thread stopped and destroyed.");
 }
 
+void WSQMLApplication::onDeviceHealthChanged(quint32 interfaceId, quint32 device, bool alive) {
+	if (alive) {
+		emit info(whoIAm, QString("Interface#") + QString::number(interfaceId) + " device#" + QString::number(device) + " responds again, polling is restored.");
+	} else {
+		emit info(whoIAm, QString("Interface#") + QString::number(interfaceId) + " device#" + QString::number(device) + " does not respond, it is polled by rare probes only.");
+	}
+}
+
 void WSQMLApplication::onInterfaceConnectionError(quint32 interfaceId) {
 	emit info(whoIAm, QString("Interface#") + QString::number(interfaceId) + " connection error.");
 	emit interfaceConnectionError(interfaceId);
@@ -617,6 +897,17 @@ QString WSQMLApplication::getFilePath(const QUrl &url) {
 	return path;
 }
 
+void WSQMLApplication::applyProtocolSettings(WSAbstractRRProtocol *proto, QJSValue data) {
+	// Block read settings
+	bool blockRead = data.hasProperty("blockRead") && data.property("blockRead").toBool();
+	quint16 blockGap = data.hasProperty("blockGap") ? static_cast<quint16>(data.property("blockGap").toUInt()) : 0;
+	if (proto->type() == WSRRProtocol::MODBUS_TCP) {
+		static_cast<WSModbusTCPProtocol*>(proto)->setBlockRead(blockRead, blockGap);
+	} else if (proto->type() == WSRRProtocol::MODBUS_RTU) {
+		static_cast<WSModbusRTUProtocol*>(proto)->setBlockRead(blockRead, blockGap);
+	}
+}
+
 WSSettings* WSQMLApplication::createSettingsInstance(const QUrl &url) {
 	if (m_storeSettings != nullptr) {
 		delete m_storeSettings;
@@ -683,12 +974,61 @@ void WSQMLApplication::onErrorDataReceived(quint32 interfaceId) {
 
 void WSQMLApplication::setLogInterfaceData(bool enabled) {
 	m_logInterfaceData = enabled;
+	for (auto const& i: m_interfaces) {
+		auto c = m_captures.find(i.first);
+		bool captured = (c != m_captures.end() && c->second->isOpen());
+		static_cast<WSPollingRRInterface*>(i.second.get())->setDataTrace(enabled || captured);
+	}
 }
 
 bool WSQMLApplication::logInterfaceData() {
 	return m_logInterfaceData;
 }
 
+bool WSQMLApplication::startTrafficCapture(const QUrl &folder) {
+	stopTrafficCapture();
+	m_captures.clear();
+	QDir dir(getFilePath(folder));
+	QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
+	for (auto const& i: m_interfaces) {
+		if (i.second->type() != WSInterface::TCP && i.second->type() != WSInterface::SERIAL && i.second->type() != WSInterface::UDP) {
+			continue;
+		}
+		std::shared_ptr<WSTrafficCapture> capture = std::make_shared<WSTrafficCapture>();
+		m_captures[i.first] = capture;
+		if (!capture->open(dir.filePath(QString("interface") + QString::number(i.first) + "_" + stamp + ".wstraffic"))) {
+			stopTrafficCapture();
+			return false;
+		}
+		// Frames are timestamped in the polling thread, the slots share the capture (alive until the last record() returns)
+		WSPollingRRInterface *iface = static_cast<WSPollingRRInterface*>(i.second.get());
+		connect(iface, &WSPollingRRInterface::trasmitted, capture.get(), [capture](QByteArray data) {capture->record(false, data);}, Qt::DirectConnection);
+		connect(iface, &WSPollingRRInterface::received, capture.get(), [capture](QByteArray data) {capture->record(true, data);}, Qt::DirectConnection);
+		iface->setDataTrace(true);
+	}
+	return !m_captures.empty();
+}
+
+// Frames may be recorded in the polling thread at the moment, disconnected slots keep the closed capture until they return
+void WSQMLApplication::stopTrafficCapture() {
+	for (auto const& c: m_captures) {
+		if (m_interfaces.find(c.first) != m_interfaces.end()) {
+			disconnect(m_interfaces[c.first].get(), nullptr, c.second.get(), nullptr);
+			static_cast<WSPollingRRInterface*>(m_interfaces[c.first].get())->setDataTrace(m_logInterfaceData);
+		}
+		c.second->close();
+	}
+}
+
+bool WSQMLApplication::trafficCaptureActive() const {
+	for (auto const& c: m_captures) {
+		if (c.second->isOpen()) {
+			return true;
+		}
+	}
+	return false;
+}
+
 quint16 WSQMLApplication::paramBytesSize(QJSValue data) {
 	quint16 bytesSize = 0;
 	quint8 fcode = static_cast<quint8>(data.property("fcode").toUInt());
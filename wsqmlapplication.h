@@ -33,6 +33,9 @@
 #include <QDesktopServices>
 #include "interfaces/wssocketinterface.h"
 #include "interfaces/wsserialinterface.h"
+#include "interfaces/wsudpinterface.h"
+#include "interfaces/wsreplayinterface.h"
+#include "interfaces/wsreactorpool.h"
 #include "protocols/wsabstractrrprotocol.h"
 #include "protocols/wsmodbustcpprotocol.h"
 #include "protocols/wsmodbusrtuprotocol.h"
@@ -41,8 +44,17 @@
 #include "protocols/wsdataconverter.h"
 #include "utils/wssettings.h"
 #include "utils/wsfile.h"
+#include "utils/wstrafficcapture.h"
+#include "utils/wsupdatebuffer.h"
 #include "conf.h"
 
+// Counters of the previous statistics read (throughput is measured between reads)
+struct WSInterfaceRate {
+	quint64 frames;
+	quint64 bytes;
+	qint64 time;
+};
+
 class WSQMLApplication : public QObject {
 Q_OBJECT
 
@@ -58,6 +70,8 @@ public:
 	Q_INVOKABLE bool startInterfacePolling(quint32 id);
 	Q_INVOKABLE bool stopInterfacePolling(quint32 id);
 	Q_INVOKABLE bool isInterfaceStarted(quint32 id);
+	// Response time, cycle time and jitter percentiles (ms), frames/s and bytes/s since the previous call
+	Q_INVOKABLE QVariantMap interfaceStatistics(quint32 id);
 	
 	Q_INVOKABLE quint32 addInterface(QJSValue data);
 	Q_INVOKABLE bool editInterface(quint32 id, QJSValue data);
@@ -78,10 +92,18 @@ public:
 
 	Q_INVOKABLE static QString pollingTypeToString(quint8 type);
 	Q_INVOKABLE static quint8 stringToPollingType(const QString &type);
+	Q_INVOKABLE static quint8 stringToDeadband(const QString &deadband);
 
 	Q_INVOKABLE WSSettings* createSettingsInstance(const QUrl &url);
 	Q_INVOKABLE void setLogInterfaceData(bool enabled);
 	Q_INVOKABLE bool logInterfaceData();
+	// Traffic of all interfaces is captured to files in the folder (replay transport input)
+	Q_INVOKABLE bool startTrafficCapture(const QUrl &folder);
+	Q_INVOKABLE void stopTrafficCapture();
+	Q_INVOKABLE bool trafficCaptureActive() const;
+	// Parameter updates are delivered to the UI in batches with the period (ms)
+	Q_INVOKABLE void setValuesUpdatePeriod(quint32 period);
+	Q_INVOKABLE quint32 valuesUpdatePeriod() const;
 	Q_INVOKABLE quint16 paramBytesSize(QJSValue data);
 	Q_INVOKABLE QVariant parseStringValue(QJSValue data);
 	Q_INVOKABLE QString arrayToString(QJSValue data);
@@ -103,22 +125,33 @@ public:
 
 private:
 	QStringList m_availablePortNames;
+	WSReactorPool m_reactors;
 	std::map<quint32, std::unique_ptr<WSPollingInterface> > m_interfaces;
 	std::map<quint32, std::unique_ptr<QThread> > m_interfacesThreads;
+	std::map<quint32, QThread*> m_interfacesReactors;
+	std::map<quint32, std::shared_ptr<WSTrafficCapture> > m_captures;
+	// Shared with the protocol signal handlers running in the polling threads
+	std::map<quint32, std::shared_ptr<WSUpdateBuffer> > m_updates;
+	std::map<quint32, WSInterfaceRate> m_rates;
+	QElapsedTimer m_ratesClock;
+	QTimer m_updateTimer;
 	quint32 m_interfacesCounter;
 	WSSettings *m_storeSettings;
 	bool m_logInterfaceData;
 
 	QString getFilePath(const QUrl &url);
+	bool isInterfacePolling(quint32 id) const;
+	WSPollingRRInterface *createTransport(const QString &transport, QJSValue data, WSAbstractRRProtocol *proto);
+	void applyProtocolSettings(WSAbstractRRProtocol *proto, QJSValue data);
 
-	void onParameterModbusValueChanged(quint32 interfaceId, quint32 paramId, WSModbusParameter *param);
-	void onParameterModbusError(quint32 interfaceId, quint32 paramId, WSModbusParameter *param);
-	void onParameterTimeout(quint32 interfaceId, quint32 paramId, WSModbusParameter*p);
-	void onParameterRequest(quint32 interfaceId, quint32 paramId, WSModbusParameter*p);
+	void onUpdateTimer();
+	static QString modbusErrorToString(quint8 err);
+	static QVariantMap histogramToMap(const WSLatencyHistogram &histogram);
 	void onInterfacePollingStarted(quint32 interfaceId);
 	void onInterfacePollingConnected(quint32 interfaceId);
 	void onInterfacePollingDisconnected(quint32 interfaceId);
 	void onInterfacePollingStopped(quint32 interfaceId);
+	void onDeviceHealthChanged(quint32 interfaceId, quint32 device, bool alive);
 	void onInterfaceConnectionError(quint32 interfaceId);
 	void onInterfaceReconnecting(quint32 interfaceId);
 	void onTransmittedData(quint32 interfaceId, QByteArray transmittedData);
@@ -131,16 +164,15 @@ private:
 	
 signals:
 	void availablePortNamesChanged();
-	void valueChanged(quint32 interfaceId, quint32 paramId, QString value, QString valueRaw, quint32 responseCounter);
-	void valueError(quint32 interfaceId, quint32 paramId, QString errCode, quint32 errorCounter);
-	void valueTimeout(quint32 interfaceId, quint32 paramId, quint32 timeoutCounter);
-	void valueRequest(quint32 interfaceId, quint32 paramId, quint32 requestCounter);
+	// Coalesced parameter updates of all interfaces (list of maps)
+	void valuesUpdated(QVariantList updates);
 	//void interfaceStatusChanged(quint32 interfaceId);
 	void interfacePollingStarted(quint32 interfaceId);
 	void interfaceConnected(quint32 interfaceId);
 	void interfacePollingStopped(quint32 interfaceId);
 	void interfaceConnectionError(quint32 interfaceId);
 	void interfaceReconnecting(quint32 interfaceId);
+	void interfaceDeviceTiming(quint32 interfaceId, quint32 device, quint32 srtt, quint32 rttvar, quint32 timeout);
 	void info(const QString &who, const QString &message);
 
 public slots: